@@ -31,7 +31,7 @@ const vec3 SUNLIGHT = vec3(1.0, 1.0, 0.95);
 
 void main() {
     vec2 uv = tileOrigin + fract(localUV) * TILE_SIZE;
-    vec4 textureColor = texture(texSampler, uv);
+    vec4 textureColor = textureGrad(texSampler, uv, dFdx(localUV) * TILE_SIZE, dFdy(localUV) * TILE_SIZE);
           
     if (textureColor.a < 0.1) {
         discard;
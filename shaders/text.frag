@@ -0,0 +1,12 @@
+#version 450
+
+layout(location = 0) in vec2 fragTexCoord;
+
+layout(set = 0, binding = 0) uniform sampler2D fontAtlas;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    float coverage = texture(fontAtlas, fragTexCoord).r;
+    outColor = vec4(1.0, 1.0, 1.0, coverage);
+}
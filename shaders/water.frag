@@ -35,7 +35,7 @@ void main() {
     }
 
     vec2 uv = tileOrigin + fract(localUV) * TILE_SIZE;
-    vec4 textureColor = texture(texSampler, uv);
+    vec4 textureColor = textureGrad(texSampler, uv, dFdx(localUV) * TILE_SIZE, dFdy(localUV) * TILE_SIZE);
     
     
     float sunUpFactor = smoothstep(-0.15, 0.1, uboLight.lightDirection.y);
@@ -13,17 +13,16 @@ layout(std140, set = 0, binding = 0) uniform CameraUbo {
 } cameraUbo;
 
 
-layout(std140, set = 0, binding = 6) readonly buffer ModelMatrixSSBO {
-    mat4 models[];
-} modelData;
+layout(std430, set = 0, binding = 6) readonly buffer ChunkOriginSSBO {
+    ivec4 origins[];
+} chunkData;
 
 layout(location = 2) out vec3 fragWorldPos;
 layout(location = 0) flat out vec2 tileOrigin;       
 layout(location = 1)      out vec2 localUV;
 
 void main() {
-    mat4 modelMatrix = modelData.models[gl_InstanceIndex];
-    vec3 worldPos = (modelMatrix * vec4(inPosition, 1.0)).xyz;
+    vec3 worldPos = inPosition + vec3(chunkData.origins[gl_InstanceIndex].xyz);
     
     float y_offset = -0.2;
     float freq1 = 0.4;
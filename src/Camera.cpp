@@ -3,8 +3,8 @@
 
 void Camera::updateFrustum()
 {
-    const glm::mat4 viewProj = m_ProjectionMatrix * m_ViewMatrix;
-    m_Frustum.update(viewProj);
+    m_ViewProjMatrix = m_ProjectionMatrix * m_ViewMatrix;
+    m_Frustum.update(m_ViewProjMatrix);
 }
 
 void Camera::setViewDirection(glm::vec3 position, glm::vec3 direction, glm::vec3 up)
@@ -13,6 +13,7 @@ public:
 
     const glm::mat4 &getProjectionMatrix() const { return m_ProjectionMatrix; }
     const glm::mat4 &getViewMatrix() const { return m_ViewMatrix; }
+    const glm::mat4 &getViewProjectionMatrix() const { return m_ViewProjMatrix; }
     const Frustum &getFrustum() const { return m_Frustum; }
 
 private:
@@ -20,5 +21,6 @@ private:
 
     glm::mat4 m_ProjectionMatrix{1.f};
     glm::mat4 m_ViewMatrix{1.f};
+    glm::mat4 m_ViewProjMatrix{1.f};
     Frustum m_Frustum;
 };
\ No newline at end of file
@@ -1,18 +1,231 @@
 #include "Chunk.h"
-#include "VulkanRenderer.h"
 #include <FastNoiseLite.h>
 #include "BlockAtlas.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <stdexcept>
 #include "Block.h"
 #include <array>
-#include "renderer/resources/UploadHelpers.h"
+#include <algorithm>
+#include <bit>
 #include <chrono>
+#include <cmath>
 #include <iostream>
-#include "renderer/resources/RingStagingArena.h"
+#include <limits>
+#include "generation/TerrainGenerator.h"
+#include "world/RegionStore.h"
+#include "world/ChunkSaver.h"
+#include "world/EditLog.h"
+#include "world/MeshCache.h"
+#include "Profiler.h"
+
+namespace
+{
+    constexpr uint64_t MESHER_VERSION = 2;
+
+    // Quads are four consecutive vertices.
+    void addQuadBounds(MeshBounds &bounds, const std::vector<Vertex> &vertices)
+    {
+        for (size_t q = 0; q + 4 <= vertices.size(); q += 4)
+        {
+            glm::vec3 min = vertices[q].pos, max = vertices[q].pos;
+            for (size_t k = 1; k < 4; ++k)
+            {
+                min = glm::min(min, vertices[q + k].pos);
+                max = glm::max(max, vertices[q + k].pos);
+            }
+            bounds.addBox(min, max);
+        }
+    }
+
+    std::array<uint8_t, static_cast<size_t>(BlockId::LAST)> opaqueBlocks()
+    {
+        auto &db = BlockDatabase::get();
+        std::array<uint8_t, static_cast<size_t>(BlockId::LAST)> opaque{};
+        for (size_t id = 0; id < opaque.size(); ++id)
+            opaque[id] = db.get_block_data(static_cast<BlockId>(id)).is_solid;
+        return opaque;
+    }
+
+    SectionGraph buildSectionGraph(const ChunkMeshInput &meshInput)
+    {
+        constexpr int S = MeshBounds::SECTION_HEIGHT;
+        static_assert(ChunkLayout::WIDTH == S && ChunkLayout::DEPTH == S, "sections are cubes");
+        constexpr int CELLS = S * S * S;
+        constexpr int CW = ChunkMeshInput::CACHED_WIDTH, CD = ChunkMeshInput::CACHED_DEPTH;
+
+        const auto opaque = opaqueBlocks();
+
+        SectionGraph graph;
+        static thread_local std::array<uint8_t, CELLS> open;
+        static thread_local std::vector<uint16_t> stack;
+
+        for (int s = 0; s < MeshBounds::SECTION_COUNT; ++s)
+        {
+            int openCount = 0;
+            for (int y = 0; y < S; ++y)
+                for (int z = 0; z < S; ++z)
+                    for (int x = 0; x < S; ++x)
+                    {
+                        Block b = meshInput.cachedBlocks[(s * S + y) * CD * CW + (z + 1) * CW + (x + 1)];
+                        uint8_t isOpen = !opaque[static_cast<size_t>(b.id)];
+                        open[y * S * S + z * S + x] = isOpen;
+                        openCount += isOpen;
+                    }
+            if (openCount == CELLS)
+                continue;
+            graph.reach[s].fill(0);
 
-using hrc = std::chrono::high_resolution_clock;
-using milli = std::chrono::duration<double, std::milli>;
+            for (int start = 0; start < CELLS && openCount > 0; ++start)
+            {
+                if (!open[start])
+                    continue;
+                uint8_t faces = 0;
+                open[start] = 0;
+                stack.push_back(static_cast<uint16_t>(start));
+                while (!stack.empty())
+                {
+                    const int c = stack.back();
+                    stack.pop_back();
+                    --openCount;
+                    const int x = c % S, z = (c / S) % S, y = c / (S * S);
+                    faces |= (x == 0) << SectionGraph::NEG_X | (x == S - 1) << SectionGraph::POS_X |
+                             (y == 0) << SectionGraph::NEG_Y | (y == S - 1) << SectionGraph::POS_Y |
+                             (z == 0) << SectionGraph::NEG_Z | (z == S - 1) << SectionGraph::POS_Z;
+
+                    auto visit = [&](bool inside, int n)
+                    {
+                        if (inside && open[n])
+                        {
+                            open[n] = 0;
+                            stack.push_back(static_cast<uint16_t>(n));
+                        }
+                    };
+                    visit(x > 0, c - 1);
+                    visit(x < S - 1, c + 1);
+                    visit(z > 0, c - S);
+                    visit(z < S - 1, c + S);
+                    visit(y > 0, c - S * S);
+                    visit(y < S - 1, c + S * S);
+                }
+                for (uint8_t m = faces; m; m &= m - 1)
+                    graph.reach[s][std::countr_zero(m)] |= faces;
+            }
+        }
+        return graph;
+    }
+
+    ChunkOccluders buildOccluders(const ChunkMeshInput &meshInput)
+    {
+        constexpr int H = ChunkLayout::HEIGHT;
+        constexpr int WORDS = H / 64;
+        constexpr int CW = ChunkMeshInput::CACHED_WIDTH, CD = ChunkMeshInput::CACHED_DEPTH;
+        constexpr int CELL = ChunkOccluders::CELL_SIZE;
+
+        const auto opaque = opaqueBlocks();
+
+        ChunkOccluders occluders;
+        for (int cz = 0; cz < ChunkOccluders::CELLS; ++cz)
+        {
+            for (int cx = 0; cx < ChunkOccluders::CELLS; ++cx)
+            {
+                // Bit y is set while every column of the cell is solid at height y.
+                std::array<uint64_t, WORDS> solid;
+                solid.fill(~0ull);
+                for (int y = 0; y < H; ++y)
+                    for (int z = cz * CELL; z < (cz + 1) * CELL; ++z)
+                        for (int x = cx * CELL; x < (cx + 1) * CELL; ++x)
+                            if (!opaque[static_cast<size_t>(meshInput.cachedBlocks[y * CD * CW + (z + 1) * CW + (x + 1)].id)])
+                                solid[y / 64] &= ~(1ull << (y % 64));
+
+                ChunkOccluders::Cell &cell = occluders.cells[cz * ChunkOccluders::CELLS + cx];
+                int runStart = 0;
+                for (int y = 0; y <= H; ++y)
+                {
+                    bool isSolid = y < H && ((solid[y / 64] >> (y % 64)) & 1);
+                    if (isSolid)
+                        continue;
+                    if (y - runStart >= cell.top - cell.bottom)
+                        cell = {static_cast<uint16_t>(runStart), static_cast<uint16_t>(y)};
+                    runStart = y + 1;
+                }
+            }
+        }
+        return occluders;
+    }
+}
+
+void MeshBounds::addBox(const glm::vec3 &min, const glm::vec3 &max)
+{
+    const int first = std::clamp(static_cast<int>(std::floor(min.y)) / SECTION_HEIGHT, 0, SECTION_COUNT - 1);
+    const int last = std::clamp(static_cast<int>(std::ceil(max.y)) / SECTION_HEIGHT - 1, first, SECTION_COUNT - 1);
+    const glm::u8vec3 lo(glm::clamp(min, 0.f, 255.f));
+    const glm::u8vec3 hi(glm::clamp(max, 0.f, 255.f));
+
+    for (int s = first; s <= last; ++s)
+    {
+        const int base = s * SECTION_HEIGHT;
+        Section box{lo, hi};
+        box.min.y = static_cast<uint8_t>(std::clamp(static_cast<int>(min.y) - base, 0, SECTION_HEIGHT));
+        box.max.y = static_cast<uint8_t>(std::clamp(static_cast<int>(std::ceil(max.y)) - base, 0, SECTION_HEIGHT));
+
+        Section &dst = sections[s];
+        if (sectionMask & (1u << s))
+        {
+            dst.min = glm::min(dst.min, box.min);
+            dst.max = glm::max(dst.max, box.max);
+        }
+        else
+            dst = box;
+        sectionMask |= 1u << s;
+    }
+}
+
+void MeshBounds::merge(const MeshBounds &other)
+{
+    for (int s = 0; s < SECTION_COUNT; ++s)
+    {
+        if (!(other.sectionMask & (1u << s)))
+            continue;
+        Section &dst = sections[s];
+        if (sectionMask & (1u << s))
+        {
+            dst.min = glm::min(dst.min, other.sections[s].min);
+            dst.max = glm::max(dst.max, other.sections[s].max);
+        }
+        else
+            dst = other.sections[s];
+    }
+    sectionMask |= other.sectionMask;
+}
+
+AABB MeshBounds::sectionAABB(int section, const glm::vec3 &origin) const
+{
+    const glm::vec3 base = origin + glm::vec3(0.f, section * SECTION_HEIGHT, 0.f);
+    return {base + glm::vec3(sections[section].min), base + glm::vec3(sections[section].max)};
+}
+
+AABB MeshBounds::toAABB(const glm::vec3 &origin) const
+{
+    if (empty())
+        return {origin, origin};
+    AABB box = sectionAABB(std::countr_zero(sectionMask), origin);
+    for (uint32_t m = sectionMask & (sectionMask - 1); m; m &= m - 1)
+    {
+        AABB s = sectionAABB(std::countr_zero(m), origin);
+        box.min = glm::min(box.min, s.min);
+        box.max = glm::max(box.max, s.max);
+    }
+    return box;
+}
+
+MeshBounds MeshBounds::full()
+{
+    MeshBounds b;
+    b.sectionMask = (1u << SECTION_COUNT) - 1;
+    for (Section &s : b.sections)
+        s = {glm::u8vec3(0), glm::u8vec3(ChunkLayout::WIDTH, SECTION_HEIGHT, ChunkLayout::DEPTH)};
+    return b;
+}
 
 Chunk::Chunk(glm::ivec3 pos) : m_Pos(pos)
 {
@@ -38,6 +251,7 @@ void Chunk::setBlock(int x, int y, int z, Block block)
 
     m_is_dirty.store(true, std::memory_order_release);
     m_blas_dirty.store(true, std::memory_order_release);
+    m_save_dirty.store(true, std::memory_order_release);
 }
 
 Block Chunk::getBlock(int x, int y, int z) const
@@ -110,270 +324,177 @@ void Chunk::generateTerrain(FastNoiseLite &noise)
     m_State.store(State::TERRAIN_READY, std::memory_order_release);
 }
 
-#include <cstdio>
+void Chunk::populate(const TerrainGenerator &generator, const EditLog *edits)
+{
+    VC_PROFILE_ZONE("Terrain generation");
+    generator.generateBlocks(m_Pos, m_Blocks);
+    if (edits)
+        edits->apply(m_Pos, m_Blocks);
+    m_is_dirty.store(true, std::memory_order_release);
+    m_blas_dirty.store(true, std::memory_order_release);
+    m_save_dirty.store(true, std::memory_order_release);
+    m_TerrainReadyAt = std::chrono::steady_clock::now();
+    m_State.store(State::TERRAIN_READY, std::memory_order_release);
+}
 
-void Chunk::markReady(VulkanRenderer &renderer)
+bool Chunk::load(RegionStore &store, const ChunkSaver *saver)
 {
-    std::scoped_lock lock(m_PendingMutex);
-    for (auto it = m_PendingUploads.begin(); it != m_PendingUploads.end();)
-    {
-        auto &job = it->second;
-        if (job.fence != VK_NULL_HANDLE &&
-            vkGetFenceStatus(renderer.getDevice(), job.fence) == VK_SUCCESS)
-        {
-            if (job.cmdBuffer != VK_NULL_HANDLE)
-                vkFreeCommandBuffers(renderer.getDevice(),
-                                     renderer.getCommandManager()->getCommandPool(),
-                                     1, &job.cmdBuffer);
+    VC_PROFILE_ZONE("Chunk::load");
+    if (!(saver && saver->tryGetPending(m_Pos, m_Blocks)) && !store.loadChunk(m_Pos, m_Blocks))
+        return false;
+    m_is_dirty.store(true, std::memory_order_release);
+    m_blas_dirty.store(true, std::memory_order_release);
+    m_TerrainReadyAt = std::chrono::steady_clock::now();
+    m_State.store(State::TERRAIN_READY, std::memory_order_release);
+    return true;
+}
 
-            if (job.fence != VK_NULL_HANDLE)
-            {
-                vkDestroyFence(renderer.getDevice(), job.fence, nullptr);
-                job.fence = VK_NULL_HANDLE;
-            }
+bool Chunk::markReady(RenderBackend &backend)
+{
+    if (m_UploadsInFlight.load(std::memory_order_acquire) == 0)
+        return false;
 
-            m_State.store(State::GPU_READY, std::memory_order_release);
-            m_blas_dirty.store(true, std::memory_order_release);
-            it = m_PendingUploads.erase(it);
-        }
-        else
-            ++it;
-    }
-    for (auto it = m_PendingTransparentUploads.begin(); it != m_PendingTransparentUploads.end();)
+    std::scoped_lock lock(m_MeshesMutex);
+    auto poll = [&](std::map<int, ChunkMesh> &meshes, bool opaque)
     {
-        auto &job = it->second;
-        if (job.fence != VK_NULL_HANDLE &&
-            vkGetFenceStatus(renderer.getDevice(), job.fence) == VK_SUCCESS)
+        for (auto &[lod, mesh] : meshes)
         {
-            if (job.cmdBuffer != VK_NULL_HANDLE)
-                vkFreeCommandBuffers(renderer.getDevice(),
-                                     renderer.getCommandManager()->getCommandPool(),
-                                     1, &job.cmdBuffer);
-
-            if (job.fence != VK_NULL_HANDLE)
-            {
-                vkDestroyFence(renderer.getDevice(), job.fence, nullptr);
-                job.fence = VK_NULL_HANDLE;
-            }
+            if (!mesh.uploadPending || !backend.isUploadComplete(*mesh.gpu))
+                continue;
 
-            m_State.store(State::GPU_READY, std::memory_order_release);
-            it = m_PendingTransparentUploads.erase(it);
+            mesh.uploadPending = false;
+            m_UploadsInFlight.fetch_sub(1, std::memory_order_acq_rel);
+            if (opaque)
+                m_blas_dirty.store(true, std::memory_order_release);
         }
-        else
-            ++it;
+    };
+    poll(m_Meshes, true);
+    poll(m_TransparentMeshes, false);
+
+    if (m_UploadsInFlight.load(std::memory_order_acquire) == 0)
+    {
+        State expected = State::UPLOADING;
+        return m_State.compare_exchange_strong(expected, State::GPU_READY, std::memory_order_acq_rel);
     }
+    return false;
 }
 
-bool Chunk::uploadMesh(VulkanRenderer &renderer, int lodLevel)
+bool Chunk::uploadSection(RenderBackend &backend, int lodLevel, std::map<int, StagedMesh> &pending,
+                          std::map<int, ChunkMesh> &meshes, std::map<int, MeshFaceRanges> *pendingFaces)
 {
-    UploadJob job;
+    VC_PROFILE_ZONE("Chunk::uploadSection");
+    StagedMesh staged;
+    MeshFaceRanges faces;
     {
         std::scoped_lock lock(m_PendingMutex);
-        if (!m_PendingUploads.count(lodLevel))
-        {
+        auto it = pending.find(lodLevel);
+        if (it == pending.end())
             return false;
-        }
-        job = std::move(m_PendingUploads.at(lodLevel));
-        m_PendingUploads.erase(lodLevel);
-    }
+        staged = it->second;
+        pending.erase(it);
 
-    if (job.stagingVB == VK_NULL_HANDLE)
-    {
-        ChunkMesh oldMesh;
+        if (pendingFaces)
         {
-            std::scoped_lock lock(m_MeshesMutex);
-            if (m_Meshes.count(lodLevel))
+            auto faceIt = pendingFaces->find(lodLevel);
+            if (faceIt != pendingFaces->end())
             {
-                oldMesh = std::move(m_Meshes.at(lodLevel));
-                m_Meshes.erase(lodLevel);
+                faces = faceIt->second;
+                pendingFaces->erase(faceIt);
             }
         }
-
-        if (oldMesh.vertexBuffer.get() != VK_NULL_HANDLE)
-        {
-            renderer.enqueueDestroy(std::move(oldMesh.vertexBuffer));
-        }
-        if (oldMesh.indexBuffer.get() != VK_NULL_HANDLE)
-        {
-            renderer.enqueueDestroy(std::move(oldMesh.indexBuffer));
-        }
-
-        m_State.store(State::GPU_READY);
-        return true;
     }
 
-    m_State.store(State::UPLOADING);
-
     ChunkMesh newMesh;
-    VkCommandPool pool = renderer.getCommandManager()->getCommandPool();
-
-    UploadHelpers::submitChunkMeshUpload(*renderer.getDeviceContext(), pool, job,
-                                         newMesh.vertexBuffer,
-                                         newMesh.indexBuffer);
-
-    if (job.cmdBuffer != VK_NULL_HANDLE)
+    if (!staged.empty())
     {
-        VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-        si.commandBufferCount = 1;
-        si.pCommandBuffers = &job.cmdBuffer;
-
-        VkQueue q = renderer.getDeviceContext()->getGraphicsQueue();
-
-        std::scoped_lock lk(gGraphicsQueueMutex);
-
-        VkResult result = vkQueueSubmit(q, 1, &si, job.fence);
-
-        if (result != VK_SUCCESS)
-        {
-            if (job.fence != VK_NULL_HANDLE)
-            {
-                vkDestroyFence(renderer.getDevice(), job.fence, nullptr);
-                job.fence = VK_NULL_HANDLE;
-            }
-
-            if (result == VK_ERROR_DEVICE_LOST)
-            {
-                throw std::runtime_error("Vulkan device lost during chunk mesh upload queue submit. This is often caused by an error in a previous frame's rendering commands.");
-            }
-
-            std::string error_message = "vkQueueSubmit failed in chunk mesh upload! Vulkan Error Code: " + std::to_string(result);
-            throw std::runtime_error(error_message);
-        }
+        m_State.store(State::UPLOADING);
+        newMesh.gpu = backend.uploadMesh(staged);
+        newMesh.vertexCount = static_cast<uint32_t>(staged.vertexBytes / sizeof(Vertex));
+        newMesh.indexCount = static_cast<uint32_t>(staged.indexBytes / sizeof(uint32_t));
+        newMesh.uploadPending = true;
+        newMesh.faces = faces;
+        m_UploadsInFlight.fetch_add(1, std::memory_order_acq_rel);
     }
 
-    newMesh.indexCount = static_cast<uint32_t>(job.stagingIbSize / sizeof(uint32_t));
-    newMesh.vertexCount = static_cast<uint32_t>(job.stagingVbSize / sizeof(Vertex));
-
     ChunkMesh oldMesh;
     {
         std::scoped_lock lock(m_MeshesMutex);
-        if (m_Meshes.count(lodLevel))
+        auto it = meshes.find(lodLevel);
+        if (it != meshes.end())
         {
-            oldMesh = std::move(m_Meshes.at(lodLevel));
+            oldMesh = std::move(it->second);
+            meshes.erase(it);
         }
-        m_Meshes[lodLevel] = std::move(newMesh);
+        if (newMesh.gpu)
+            meshes[lodLevel] = std::move(newMesh);
     }
+    m_CullDataRevision.fetch_add(1, std::memory_order_acq_rel);
 
-    if (oldMesh.vertexBuffer.get() != VK_NULL_HANDLE)
-    {
-        renderer.enqueueDestroy(std::move(oldMesh.vertexBuffer));
-    }
-    if (oldMesh.indexBuffer.get() != VK_NULL_HANDLE)
-    {
-        renderer.enqueueDestroy(std::move(oldMesh.indexBuffer));
-    }
+    if (oldMesh.uploadPending)
+        m_UploadsInFlight.fetch_sub(1, std::memory_order_acq_rel);
+    if (oldMesh.gpu)
+        backend.retireMesh(std::move(oldMesh.gpu));
 
-    {
-        std::scoped_lock lock(m_PendingMutex);
-        m_PendingUploads[lodLevel] = std::move(job);
-    }
+    if (staged.empty())
+        m_State.store(m_UploadsInFlight.load(std::memory_order_acquire) > 0 ? State::UPLOADING : State::GPU_READY);
 
     return true;
 }
 
-bool Chunk::uploadTransparentMesh(VulkanRenderer &renderer, int lodLevel)
+bool Chunk::uploadMesh(RenderBackend &backend, int lodLevel)
 {
-    UploadJob job;
-    {
-        std::scoped_lock lock(m_PendingMutex);
-        if (!m_PendingTransparentUploads.count(lodLevel))
-            return false;
-        job = std::move(m_PendingTransparentUploads.at(lodLevel));
-        m_PendingTransparentUploads.erase(lodLevel);
-    }
-
-    if (job.stagingVB == VK_NULL_HANDLE)
-    {
-        ChunkMesh oldMesh;
-        {
-            std::scoped_lock lock(m_MeshesMutex);
-            if (m_TransparentMeshes.count(lodLevel))
-            {
-                oldMesh = std::move(m_TransparentMeshes.at(lodLevel));
-                m_TransparentMeshes.erase(lodLevel);
-            }
-        }
-        if (oldMesh.vertexBuffer.get() != VK_NULL_HANDLE)
-            renderer.enqueueDestroy(std::move(oldMesh.vertexBuffer));
-        if (oldMesh.indexBuffer.get() != VK_NULL_HANDLE)
-            renderer.enqueueDestroy(std::move(oldMesh.indexBuffer));
-
-        m_State.store(State::GPU_READY);
-        return true;
-    }
+    if (!uploadSection(backend, lodLevel, m_PendingUploads, m_Meshes, &m_PendingFaces))
+        return false;
 
-    m_State.store(State::UPLOADING);
-
-    ChunkMesh newMesh;
-    VkCommandPool pool = renderer.getCommandManager()->getCommandPool();
-
-    UploadHelpers::submitChunkMeshUpload(*renderer.getDeviceContext(), pool, job,
-                                         newMesh.vertexBuffer,
-                                         newMesh.indexBuffer);
-
-    if (job.cmdBuffer != VK_NULL_HANDLE)
+    PendingCullData cullData;
     {
-        VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-        si.commandBufferCount = 1;
-        si.pCommandBuffers = &job.cmdBuffer;
-
-        VkQueue q = renderer.getDeviceContext()->getGraphicsQueue();
-
-        std::scoped_lock lk(gGraphicsQueueMutex);
-
-        VkResult result = vkQueueSubmit(q, 1, &si, job.fence);
-
-        if (result != VK_SUCCESS)
-        {
-            if (job.fence != VK_NULL_HANDLE)
-            {
-                vkDestroyFence(renderer.getDevice(), job.fence, nullptr);
-                job.fence = VK_NULL_HANDLE;
-            }
-
-            if (result == VK_ERROR_DEVICE_LOST)
-            {
-                throw std::runtime_error("Vulkan device lost during transparent chunk mesh upload. This is likely caused by an error in a previous frame's rendering commands (e.g., ray tracing).");
-            }
-
-            std::string error_message = "vkQueueSubmit failed in chunk transparent mesh upload! Vulkan Error Code: " + std::to_string(result);
-            throw std::runtime_error(error_message);
-        }
-    }
-
-    newMesh.indexCount = static_cast<uint32_t>(job.stagingIbSize / sizeof(uint32_t));
-
-    ChunkMesh oldMesh;
-    {
-        std::scoped_lock lock(m_MeshesMutex);
-        if (m_TransparentMeshes.count(lodLevel))
-        {
-            oldMesh = std::move(m_TransparentMeshes.at(lodLevel));
-        }
-        m_TransparentMeshes[lodLevel] = std::move(newMesh);
+        std::scoped_lock lock(m_PendingMutex);
+        auto it = m_PendingCullData.find(lodLevel);
+        if (it == m_PendingCullData.end())
+            return true;
+        cullData = it->second;
+        m_PendingCullData.erase(it);
     }
+    setMeshBounds(lodLevel, cullData.bounds);
+    setSectionGraph(cullData.graph);
+    setOccluders(cullData.occluders);
+    return true;
+}
 
-    if (oldMesh.vertexBuffer.get() != VK_NULL_HANDLE)
-    {
-        renderer.enqueueDestroy(std::move(oldMesh.vertexBuffer));
-    }
-    if (oldMesh.indexBuffer.get() != VK_NULL_HANDLE)
-    {
-        renderer.enqueueDestroy(std::move(oldMesh.indexBuffer));
-    }
+bool Chunk::uploadTransparentMesh(RenderBackend &backend, int lodLevel)
+{
+    return uploadSection(backend, lodLevel, m_PendingTransparentUploads, m_TransparentMeshes, nullptr);
+}
 
+void Chunk::gatherMeshInput(ChunkMeshInput &meshInput) const
+{
+    auto getBlockFromSource = [&](int rx, int ry, int rz) -> Block
     {
-        std::scoped_lock lock(m_PendingMutex);
-        m_PendingTransparentUploads[lodLevel] = std::move(job);
-    }
+        if (ry < 0 || ry >= HEIGHT)
+            return {BlockId::AIR};
+        int cx = (rx < 0) ? -1 : (rx >= WIDTH ? 1 : 0);
+        int cz = (rz < 0) ? -1 : (rz >= DEPTH ? 1 : 0);
+        int lx = rx - cx * WIDTH;
+        int lz = rz - cz * DEPTH;
+        if (cx == 0 && cz == 0)
+            return getBlock(lx, ry, lz);
+        static const int map[3][3] = {{4, 2, 5}, {0, -1, 1}, {6, 3, 7}};
+        int idx = map[cz + 1][cx + 1];
+        if (idx != -1 && meshInput.neighborChunks[idx])
+            return meshInput.neighborChunks[idx]->getBlock(lx, ry, lz);
+        return {BlockId::AIR};
+    };
 
-    return true;
+    for (int y = 0; y < HEIGHT; ++y)
+        for (int z = 0; z < DEPTH + 2; ++z)
+            for (int x = 0; x < WIDTH + 2; ++x)
+                meshInput.cachedBlocks[y * (DEPTH + 2) * (WIDTH + 2) + z * (WIDTH + 2) + x] = getBlockFromSource(x - 1, y, z - 1);
 }
 
 void Chunk::buildMeshGreedy(int lodLevel,
                             std::vector<Vertex> &outOpaqueVertices, std::vector<uint32_t> &outOpaqueIndices,
                             std::vector<Vertex> &outTransparentVertices, std::vector<uint32_t> &outTransparentIndices,
-                            ChunkMeshInput &meshInput)
+                            MeshFaceRanges &outOpaqueFaces, ChunkMeshInput &meshInput)
 {
     constexpr size_t kMaxFaces = WIDTH * HEIGHT * DEPTH;
     constexpr size_t kMaxVerts = kMaxFaces * 4;
@@ -393,34 +514,22 @@ void Chunk::buildMeshGreedy(int lodLevel,
     if (outTransparentIndices.capacity() < kMaxIdx)
         outTransparentIndices.reserve(kMaxIdx >> 4);
 
+    // Opaque indices are collected per face direction and concatenated at the end, so each
+    // direction is one contiguous range the renderer can skip when it faces away.
+    static thread_local std::array<std::vector<uint32_t>, SectionGraph::FACE_COUNT> faceIndices;
+    std::array<int, SectionGraph::FACE_COUNT> facePlanes;
+    for (int f = 0; f < SectionGraph::FACE_COUNT; ++f)
+    {
+        faceIndices[f].clear();
+        facePlanes[f] = (f & 1) ? std::numeric_limits<int>::max() : std::numeric_limits<int>::min();
+    }
+
     struct MaskCell
     {
         int8_t block_id = 0;
         bool operator==(const MaskCell &r) const { return block_id == r.block_id; }
     };
 
-    auto getBlockFromSource = [&](int rx, int ry, int rz) -> Block
-    {
-        if (ry < 0 || ry >= HEIGHT)
-            return {BlockId::AIR};
-        int cx = (rx < 0) ? -1 : (rx >= WIDTH ? 1 : 0);
-        int cz = (rz < 0) ? -1 : (rz >= DEPTH ? 1 : 0);
-        int lx = rx - cx * WIDTH;
-        int lz = rz - cz * DEPTH;
-        if (cx == 0 && cz == 0)
-            return meshInput.selfChunk->getBlock(lx, ry, lz);
-        static const int map[3][3] = {{4, 2, 5}, {0, -1, 1}, {6, 3, 7}};
-        int idx = map[cz + 1][cx + 1];
-        if (idx != -1 && meshInput.neighborChunks[idx])
-            return meshInput.neighborChunks[idx]->getBlock(lx, ry, lz);
-        return {BlockId::AIR};
-    };
-
-    for (int y = 0; y < HEIGHT; ++y)
-        for (int z = 0; z < DEPTH + 2; ++z)
-            for (int x = 0; x < WIDTH + 2; ++x)
-                meshInput.cachedBlocks[y * (DEPTH + 2) * (WIDTH + 2) + z * (WIDTH + 2) + x] = getBlockFromSource(x - 1, y, z - 1);
-
     const int W = WIDTH, H = HEIGHT, D = DEPTH;
     const int PAD_W = W + 2, PAD_D = D + 2;
 
@@ -593,8 +702,12 @@ void Chunk::buildMeshGreedy(int lodLevel,
                     const auto &blockData = db.get_block_data(id);
 
                     bool is_transparent = !blockData.is_solid;
+                    // back faces belong to the block below the slice and point up the axis.
+                    const int face = dim * 2 + (back ? 1 : 0);
                     auto &vertices = is_transparent ? outTransparentVertices : outOpaqueVertices;
-                    auto &indices = is_transparent ? outTransparentIndices : outOpaqueIndices;
+                    auto &indices = is_transparent ? outTransparentIndices : faceIndices[face];
+                    if (!is_transparent)
+                        facePlanes[face] = back ? std::min(facePlanes[face], slice) : std::max(facePlanes[face], slice);
 
                     if (is_transparent && id == BlockId::WATER)
                     {
@@ -684,33 +797,159 @@ void Chunk::buildMeshGreedy(int lodLevel,
             }
         }
     }
+
+    outOpaqueFaces = MeshFaceRanges{};
+    for (int f = 0; f < SectionGraph::FACE_COUNT; ++f)
+    {
+        MeshFaceRanges::Range &range = outOpaqueFaces.ranges[f];
+        range.firstIndex = static_cast<uint32_t>(outOpaqueIndices.size());
+        range.indexCount = static_cast<uint32_t>(faceIndices[f].size());
+        range.plane = faceIndices[f].empty() ? 0 : facePlanes[f];
+        outOpaqueIndices.insert(outOpaqueIndices.end(), faceIndices[f].begin(), faceIndices[f].end());
+    }
 }
 
-void Chunk::buildAndStageMesh(VmaAllocator allocator, RingStagingArena &arena,
-                              int lodLevel, ChunkMeshInput &meshInput)
+bool Chunk::buildAndStageMesh(RenderBackend &backend, int lodLevel, ChunkMeshInput &meshInput,
+                              MeshCache *meshCache, MeshStageTimes *times)
 {
-    const auto t0 = hrc::now();
+    VC_PROFILE_ZONE("Chunk::buildAndStageMesh");
     if (m_State.load() == State::INITIAL)
-        return;
+        return false;
     m_State.store(State::MESHING);
 
+    gatherMeshInput(meshInput);
+
+    StagedMesh opaqueStaged;
+    StagedMesh transparentStaged;
+    MeshFaceRanges opaqueFaces;
+    MeshBounds bounds;
+    // Cached next to the mesh, so a cache hit skips the flood fill and the occluder scan.
+    SectionGraph graph;
+    ChunkOccluders occluders;
+    bool hasGraph = false;
+    bool hasOccluders = false;
+    auto buildCullData = [&]
+    {
+        if (!hasGraph)
+        {
+            VC_PROFILE_ZONE("Chunk::buildSectionGraph");
+            graph = buildSectionGraph(meshInput);
+        }
+        if (!hasOccluders)
+        {
+            VC_PROFILE_ZONE("Chunk::buildOccluders");
+            occluders = buildOccluders(meshInput);
+        }
+    };
+
+    auto publishStaged = [&](std::chrono::steady_clock::time_point meshedAt)
+    {
+        {
+            std::scoped_lock lock(m_PendingMutex);
+            m_PendingUploads[lodLevel] = opaqueStaged;
+            m_PendingFaces[lodLevel] = opaqueFaces;
+            m_PendingTransparentUploads[lodLevel] = transparentStaged;
+            m_PendingCullData[lodLevel] = {bounds, graph, occluders};
+        }
+        auto stagedAt = std::chrono::steady_clock::now();
+        m_StagedAt.store(stagedAt.time_since_epoch().count(), std::memory_order_release);
+        m_State.store(State::STAGING_READY);
+
+        if (times)
+        {
+            times->meshed = meshedAt;
+            times->staged = stagedAt;
+            times->firstMesh = !m_FirstMeshTimed.exchange(true, std::memory_order_acq_rel);
+        }
+    };
+
+    uint64_t cacheKey = 0;
+    if (meshCache)
+    {
+        uint64_t neighborMask = 0;
+        for (size_t i = 0; i < meshInput.neighborChunks.size(); ++i)
+            if (meshInput.neighborChunks[i])
+                neighborMask |= 1ull << i;
+
+        cacheKey = MeshCache::hashContent(meshInput.cachedBlocks.data(), meshInput.cachedBlocks.size() * sizeof(Block),
+                                          MESHER_VERSION ^ (neighborMask << 56));
+
+        VC_PROFILE_ZONE("Mesh cache lookup");
+        bool hit = meshCache->load(m_Pos, lodLevel, cacheKey,
+                                   [&](const MeshCache::Sizes &sizes, std::array<void *, MeshCache::SECTION_COUNT> &dst)
+                                   {
+                                       if (uint8_t *base = backend.reserveStaging(sizes[0], sizes[1], opaqueStaged))
+                                       {
+                                           dst[0] = base + opaqueStaged.vertexOffset;
+                                           dst[1] = base + opaqueStaged.indexOffset;
+                                       }
+                                       if (uint8_t *base = backend.reserveStaging(sizes[2], sizes[3], transparentStaged))
+                                       {
+                                           dst[2] = base + transparentStaged.vertexOffset;
+                                           dst[3] = base + transparentStaged.indexOffset;
+                                       }
+                                       if (sizes[4] == sizeof(MeshBounds))
+                                           dst[4] = &bounds;
+                                       if (sizes[5] == sizeof(MeshFaceRanges))
+                                           dst[5] = &opaqueFaces;
+                                       if ((hasGraph = sizes[6] == sizeof(SectionGraph)))
+                                           dst[6] = &graph;
+                                       if ((hasOccluders = sizes[7] == sizeof(ChunkOccluders)))
+                                           dst[7] = &occluders;
+                                   });
+        if (hit)
+        {
+            if (bounds.empty() && (opaqueStaged.vertexBytes || transparentStaged.vertexBytes))
+                bounds = MeshBounds::full();
+            buildCullData();
+            publishStaged(std::chrono::steady_clock::now());
+            return true;
+        }
+
+        opaqueStaged = StagedMesh{};
+        transparentStaged = StagedMesh{};
+        opaqueFaces = MeshFaceRanges{};
+        bounds = MeshBounds{};
+        hasGraph = hasOccluders = false;
+    }
+
+    buildCullData();
+
     static thread_local std::vector<Vertex> opaqueVertices, transparentVertices;
     static thread_local std::vector<uint32_t> opaqueIndices, transparentIndices;
 
-    buildMeshGreedy(lodLevel, opaqueVertices, opaqueIndices, transparentVertices, transparentIndices, meshInput);
+    {
+        VC_PROFILE_ZONE("Chunk::buildMeshGreedy");
+        buildMeshGreedy(lodLevel, opaqueVertices, opaqueIndices, transparentVertices, transparentIndices, opaqueFaces, meshInput);
+    }
+    addQuadBounds(bounds, opaqueVertices);
+    addQuadBounds(bounds, transparentVertices);
+    const auto meshedAt = std::chrono::steady_clock::now();
 
-    UploadJob opaqueJob;
-    UploadHelpers::stageChunkMesh(arena, opaqueVertices, opaqueIndices, opaqueJob);
+    {
+        VC_PROFILE_ZONE("Stage mesh");
+        backend.stageMesh(opaqueVertices.data(), opaqueVertices.size() * sizeof(Vertex),
+                          opaqueIndices.data(), opaqueIndices.size() * sizeof(uint32_t), opaqueStaged);
+        backend.stageMesh(transparentVertices.data(), transparentVertices.size() * sizeof(Vertex),
+                          transparentIndices.data(), transparentIndices.size() * sizeof(uint32_t), transparentStaged);
+    }
 
-    UploadJob transparentJob;
-    UploadHelpers::stageChunkMesh(arena, transparentVertices, transparentIndices, transparentJob);
+    publishStaged(meshedAt);
 
+    if (meshCache)
     {
-        std::scoped_lock lock(m_PendingMutex);
-        m_PendingUploads[lodLevel] = std::move(opaqueJob);
-        m_PendingTransparentUploads[lodLevel] = std::move(transparentJob);
+        VC_PROFILE_ZONE("Mesh cache store");
+        meshCache->store(m_Pos, lodLevel, cacheKey,
+                         {{{opaqueVertices.data(), opaqueVertices.size() * sizeof(Vertex)},
+                           {opaqueIndices.data(), opaqueIndices.size() * sizeof(uint32_t)},
+                           {transparentVertices.data(), transparentVertices.size() * sizeof(Vertex)},
+                           {transparentIndices.data(), transparentIndices.size() * sizeof(uint32_t)},
+                           {&bounds, sizeof(bounds)},
+                           {&opaqueFaces, sizeof(opaqueFaces)},
+                           {&graph, sizeof(graph)},
+                           {&occluders, sizeof(occluders)}}});
     }
-    m_State.store(State::STAGING_READY);
+    return true;
 }
 
 bool Chunk::hasLOD(int lodLevel) const
@@ -740,6 +979,54 @@ const ChunkMesh *Chunk::getTransparentMesh(int lodLevel) const
     return it == m_TransparentMeshes.end() ? nullptr : &it->second;
 }
 
+MeshBounds Chunk::getMeshBounds() const
+{
+    std::scoped_lock lock(m_MeshesMutex);
+    MeshBounds bounds;
+    for (const auto &[lod, b] : m_LodBounds)
+        bounds.merge(b);
+    return bounds;
+}
+
+void Chunk::setMeshBounds(int lodLevel, const MeshBounds &bounds)
+{
+    {
+        std::scoped_lock lock(m_MeshesMutex);
+        m_LodBounds[lodLevel] = bounds;
+    }
+    m_CullDataRevision.fetch_add(1, std::memory_order_acq_rel);
+}
+
+SectionGraph Chunk::getSectionGraph() const
+{
+    std::scoped_lock lock(m_MeshesMutex);
+    return m_SectionGraph;
+}
+
+void Chunk::setSectionGraph(const SectionGraph &graph)
+{
+    {
+        std::scoped_lock lock(m_MeshesMutex);
+        m_SectionGraph = graph;
+    }
+    m_CullDataRevision.fetch_add(1, std::memory_order_acq_rel);
+}
+
+ChunkOccluders Chunk::getOccluders() const
+{
+    std::scoped_lock lock(m_MeshesMutex);
+    return m_Occluders;
+}
+
+void Chunk::setOccluders(const ChunkOccluders &occluders)
+{
+    {
+        std::scoped_lock lock(m_MeshesMutex);
+        m_Occluders = occluders;
+    }
+    m_CullDataRevision.fetch_add(1, std::memory_order_acq_rel);
+}
+
 int Chunk::getBestAvailableLOD(int requiredLod) const
 {
     std::scoped_lock lock(m_MeshesMutex);
@@ -748,37 +1035,3 @@ int Chunk::getBestAvailableLOD(int requiredLod) const
             return lod;
     return m_Meshes.empty() && m_TransparentMeshes.empty() ? -1 : m_Meshes.rbegin()->first;
 }
-
-void Chunk::buildAndStageDebugMesh(VmaAllocator allocator, RingStagingArena &arena)
-{
-    static thread_local std::vector<glm::vec3> vertices;
-    static thread_local std::vector<uint32_t> indices;
-    vertices.clear();
-    indices.clear();
-    for (int y = 0; y < HEIGHT; ++y)
-    {
-        for (int x = 0; x < WIDTH; ++x)
-        {
-            for (int z = 0; z < DEPTH; ++z)
-            {
-                if (getBlock(x, y, z).id != BlockId::AIR)
-                {
-                    uint32_t base_vertex = static_cast<uint32_t>(vertices.size());
-                    vertices.push_back(glm::vec3(x, y, z));
-                    vertices.push_back(glm::vec3(x + 1, y, z));
-                    vertices.push_back(glm::vec3(x + 1, y + 1, z));
-                    vertices.push_back(glm::vec3(x, y + 1, z));
-                    vertices.push_back(glm::vec3(x, y, z + 1));
-                    vertices.push_back(glm::vec3(x + 1, y, z + 1));
-                    vertices.push_back(glm::vec3(x + 1, y + 1, z + 1));
-                    vertices.push_back(glm::vec3(x, y + 1, z + 1));
-                    std::vector<uint32_t> cube_indices = {0, 1, 1, 2, 2, 3, 3, 0, 4, 5, 5, 6, 6, 7, 7, 4, 0, 4, 1, 5, 2, 6, 3, 7};
-                    for (uint32_t index : cube_indices)
-                    {
-                        indices.push_back(base_vertex + index);
-                    }
-                }
-            }
-        }
-    }
-}
\ No newline at end of file
@@ -2,18 +2,26 @@
 
 #include "Block.h"
 #include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
 #include <vector>
 #include <atomic>
+#include <cstdint>
 #include <map>
-#include "UploadJob.h"
+#include <memory>
 #include "math/AABB.h"
 #include <mutex>
 #include <array>
-#include <renderer/resources/RingStagingArena.h>
-#include "renderer/RayTracing.h"
+#include <chrono>
+#include "RenderBackend.h"
+
+#include "ChunkLayout.h"
 
-class VulkanRenderer;
 class FastNoiseLite;
+class TerrainGenerator;
+class RegionStore;
+class ChunkSaver;
+class EditLog;
+class MeshCache;
 
 #include "renderer/Vertex.h"
 
@@ -50,21 +58,163 @@ public:
     }
 };
 
+// When a mesh job finished meshing and staging, for the pipeline latency metrics.
+struct MeshStageTimes
+{
+    std::chrono::steady_clock::time_point meshed;
+    std::chrono::steady_clock::time_point staged;
+    bool firstMesh = false;
+};
+
+// Tight bounds of a chunk mesh per 16-block-high section, in chunk-local block units.
+// Section coordinates are relative to the section base, so they fit in a byte.
+struct MeshBounds
+{
+    static constexpr int SECTION_HEIGHT = 16;
+    static constexpr int SECTION_COUNT = ChunkLayout::HEIGHT / SECTION_HEIGHT;
+
+    struct Section
+    {
+        glm::u8vec3 min{0};
+        glm::u8vec3 max{0};
+    };
+
+    uint32_t sectionMask = 0;
+    std::array<Section, SECTION_COUNT> sections{};
+
+    bool empty() const { return sectionMask == 0; }
+    void addBox(const glm::vec3 &min, const glm::vec3 &max);
+    void merge(const MeshBounds &other);
+
+    AABB sectionAABB(int section, const glm::vec3 &origin) const;
+    AABB toAABB(const glm::vec3 &origin) const;
+
+    static MeshBounds full();
+};
+
+// Which faces of each 16-block section can see each other through non-opaque cells, found by
+// flood fill at mesh time. reach[s][a] has bit b set if face b is reachable from face a.
+struct SectionGraph
+{
+    enum Face
+    {
+        NEG_X,
+        POS_X,
+        NEG_Y,
+        POS_Y,
+        NEG_Z,
+        POS_Z,
+        FACE_COUNT
+    };
+    static constexpr uint8_t ALL_FACES = (1u << FACE_COUNT) - 1;
+
+    static constexpr int opposite(int face) { return face ^ 1; }
+
+    // Starts fully open, so sections nothing is known about never hide anything.
+    SectionGraph()
+    {
+        for (auto &section : reach)
+            section.fill(ALL_FACES);
+    }
+
+    std::array<std::array<uint8_t, FACE_COUNT>, MeshBounds::SECTION_COUNT> reach;
+
+    bool connected(int section, int from, int to) const { return (reach[section][from] >> to) & 1; }
+};
+
+// Where an opaque chunk mesh's faces sit in its index buffer, grouped by the direction they point
+// and indexed like SectionGraph::Face. plane is the chunk-local coordinate, along the direction's
+// axis, of the face a camera would pass first: the lowest for POS_ faces, the highest for NEG_
+// ones. A camera that has not crossed it sees all of the range's faces from behind. Meshes
+// without ranges, such as transparent ones, are drawn whole.
+struct MeshFaceRanges
+{
+    struct Range
+    {
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        int32_t plane = 0;
+    };
+
+    std::array<Range, SectionGraph::FACE_COUNT> ranges{};
+
+    bool empty() const
+    {
+        for (const Range &r : ranges)
+            if (r.indexCount > 0)
+                return false;
+        return true;
+    }
+
+    // Bit per direction whose faces can point at a camera at the chunk-local position.
+    uint8_t facingCamera(const glm::vec3 &localCamera) const
+    {
+        uint8_t faces = 0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (localCamera[axis] < static_cast<float>(ranges[axis * 2].plane))
+                faces |= 1u << (axis * 2);
+            if (localCamera[axis] > static_cast<float>(ranges[axis * 2 + 1].plane))
+                faces |= 1u << (axis * 2 + 1);
+        }
+        return faces;
+    }
+
+    // Calls fn(firstIndex, indexCount) for the runs of contiguous ranges in faces, merging
+    // across empty ranges.
+    template <typename Fn>
+    void forEachRun(uint8_t faces, Fn &&fn) const
+    {
+        for (int f = 0; f < SectionGraph::FACE_COUNT;)
+        {
+            if (!((faces >> f) & 1) || ranges[f].indexCount == 0)
+            {
+                ++f;
+                continue;
+            }
+            const uint32_t first = ranges[f].firstIndex;
+            uint32_t count = 0;
+            for (; f < SectionGraph::FACE_COUNT && (((faces >> f) & 1) || ranges[f].indexCount == 0); ++f)
+                count += ranges[f].indexCount;
+            fn(first, count);
+        }
+    }
+};
+
+// Solid boxes inside the chunk for occlusion culling: per cell of 4x4 columns, the tallest run of
+// heights that is solid in every column of the cell. Chunk-local; empty cells have bottom == top.
+struct ChunkOccluders
+{
+    static constexpr int CELL_SIZE = 4;
+    static constexpr int CELLS = ChunkLayout::WIDTH / CELL_SIZE;
+
+    struct Cell
+    {
+        uint16_t bottom = 0;
+        uint16_t top = 0;
+    };
+
+    // Indexed z * CELLS + x.
+    std::array<Cell, CELLS * CELLS> cells{};
+};
+
 struct ChunkMesh
 {
-    VmaBuffer vertexBuffer;
-    VmaBuffer indexBuffer;
+    std::unique_ptr<GpuMesh> gpu;
 
     uint32_t vertexCount = 0;
     uint32_t indexCount = 0;
-    AccelerationStructure blas;
+    bool uploadPending = false;
+    MeshFaceRanges faces;
 };
 
 class Chunk
 {
 public:
+    // The whole column; getMeshBounds() has what the uploaded meshes actually cover.
     AABB getAABB() const;
-    static constexpr int WIDTH = 16, HEIGHT = 256, DEPTH = 16;
+    static constexpr int WIDTH = ChunkLayout::WIDTH, HEIGHT = ChunkLayout::HEIGHT, DEPTH = ChunkLayout::DEPTH;
+    static constexpr uint32_t NO_ORIGIN_SLOT = ~0u;
     enum class State
     {
         INITIAL,
@@ -79,15 +229,16 @@ public:
     ~Chunk();
 
     void generateTerrain(FastNoiseLite &noise);
-    void markReady(VulkanRenderer &renderer);
+    void populate(const TerrainGenerator &generator, const EditLog *edits = nullptr);
+    // Prefers a snapshot still queued in saver over the region file.
+    bool load(RegionStore &store, const ChunkSaver *saver = nullptr);
+    bool markReady(RenderBackend &backend);
 
-    void buildAndStageMesh(VmaAllocator allocator, RingStagingArena &arena,
-                           int lodLevel, ChunkMeshInput &meshInput);
+    bool buildAndStageMesh(RenderBackend &backend, int lodLevel, ChunkMeshInput &meshInput,
+                           MeshCache *meshCache = nullptr, MeshStageTimes *times = nullptr);
 
-    void buildAndStageDebugMesh(VmaAllocator allocator, RingStagingArena &arena);
-
-    bool uploadMesh(VulkanRenderer &renderer, int lodLevel);
-    bool uploadTransparentMesh(VulkanRenderer &renderer, int lodLevel);
+    bool uploadMesh(RenderBackend &backend, int lodLevel);
+    bool uploadTransparentMesh(RenderBackend &backend, int lodLevel);
 
     const std::vector<Block> &getBlocks() const { return m_Blocks; }
 
@@ -98,17 +249,34 @@ public:
     const ChunkMesh *getMesh(int lodLevel) const;
     ChunkMesh *getMesh(int lodLevel);
     const ChunkMesh *getTransparentMesh(int lodLevel) const;
-    const ChunkMesh *getDebugMesh() const { return &m_DebugMesh; }
+
+    // Union over the uploaded LODs.
+    MeshBounds getMeshBounds() const;
+    void setMeshBounds(int lodLevel, const MeshBounds &bounds);
+    // From the most recently uploaded mesh.
+    SectionGraph getSectionGraph() const;
+    void setSectionGraph(const SectionGraph &graph);
+    ChunkOccluders getOccluders() const;
+    void setOccluders(const ChunkOccluders &occluders);
+    // Changes whenever an uploaded mesh, the mesh bounds, section graph or occluders do.
+    uint32_t getCullDataRevision() const { return m_CullDataRevision.load(std::memory_order_acquire); }
 
     const glm::mat4 &getModelMatrix() const { return m_ModelMatrix; }
     Block getBlock(int x, int y, int z) const;
     void setBlock(int x, int y, int z, Block block);
     glm::ivec3 getPos() const { return m_Pos; }
 
+    std::chrono::steady_clock::time_point getTerrainReadyTime() const { return m_TerrainReadyAt; }
+    std::chrono::steady_clock::time_point getStagedTime() const
+    {
+        return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(m_StagedAt.load(std::memory_order_acquire)));
+    }
+
     std::atomic<State> m_State;
     std::atomic<int> m_Flags{0};
     std::atomic<bool> m_is_dirty{false};
     std::atomic<bool> m_blas_dirty{false};
+    std::atomic<bool> m_save_dirty{false};
 
     mutable std::mutex m_PendingMutex;
     mutable std::mutex m_MeshesMutex;
@@ -116,17 +284,40 @@ public:
     std::map<int, ChunkMesh> m_Meshes;
     std::map<int, ChunkMesh> m_TransparentMeshes;
 
+    // The chunk's entry in the renderer's chunk origin table, which draws pass as their
+    // firstInstance. Only touched on the main thread.
+    uint32_t m_OriginSlot = NO_ORIGIN_SLOT;
+
 private:
+    void gatherMeshInput(ChunkMeshInput &meshInput) const;
+    bool uploadSection(RenderBackend &backend, int lodLevel, std::map<int, StagedMesh> &pending,
+                       std::map<int, ChunkMesh> &meshes, std::map<int, MeshFaceRanges> *pendingFaces);
     void buildMeshGreedy(int lodLevel,
                          std::vector<Vertex> &outOpaqueVertices, std::vector<uint32_t> &outOpaqueIndices,
                          std::vector<Vertex> &outTransparentVertices, std::vector<uint32_t> &outTransparentIndices,
-                         ChunkMeshInput &meshInput);
+                         MeshFaceRanges &outOpaqueFaces, ChunkMeshInput &meshInput);
 
     glm::ivec3 m_Pos;
     glm::mat4 m_ModelMatrix;
     std::vector<Block> m_Blocks;
 
-    ChunkMesh m_DebugMesh;
-    std::map<int, UploadJob> m_PendingUploads;
-    std::map<int, UploadJob> m_PendingTransparentUploads;
+    std::map<int, StagedMesh> m_PendingUploads;
+    std::map<int, MeshFaceRanges> m_PendingFaces;
+    std::map<int, StagedMesh> m_PendingTransparentUploads;
+    struct PendingCullData
+    {
+        MeshBounds bounds;
+        SectionGraph graph;
+        ChunkOccluders occluders;
+    };
+    std::map<int, PendingCullData> m_PendingCullData;
+    std::map<int, MeshBounds> m_LodBounds;
+    SectionGraph m_SectionGraph;
+    ChunkOccluders m_Occluders;
+    std::atomic<uint32_t> m_CullDataRevision{0};
+    std::atomic<int> m_UploadsInFlight{0};
+
+    std::chrono::steady_clock::time_point m_TerrainReadyAt;
+    std::atomic<std::chrono::steady_clock::rep> m_StagedAt{0};
+    std::atomic<bool> m_FirstMeshTimed{false};
 };
\ No newline at end of file
@@ -0,0 +1,466 @@
+#include "ChunkCuller.h"
+#include "DrawKey.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace
+{
+    constexpr size_t MIN_GROUPS_PER_BATCH = 8;
+    constexpr size_t BATCHES_PER_SLOT = 4;
+
+    // Rejects a chunk the frustum cuts if none of the given mesh sections is visible.
+    bool anySectionVisible(const Frustum &frustum, uint32_t sections, const MeshBounds &bounds, const glm::vec3 &origin)
+    {
+        if (sections == bounds.sectionMask && std::has_single_bit(sections))
+            return true;
+        for (uint32_t m = sections; m; m &= m - 1)
+            if (frustum.intersects(bounds.sectionAABB(std::countr_zero(m), origin)))
+                return true;
+        return false;
+    }
+}
+
+ChunkCuller::ChunkCuller(const Settings &settings, size_t threadCount)
+    : m_Settings(settings), m_Parallel(threadCount)
+{
+    m_Slots.resize(m_Parallel.concurrency());
+}
+
+void ChunkCuller::rebuildRecords(const ChunkMap &chunks)
+{
+    m_Records.clear();
+    m_Records.reserve(chunks.size());
+    for (const auto &[pos, ch] : chunks)
+        m_Records.push_back({ch.get(), {}, glm::vec2(pos.x, pos.z), ch->getAABB().min, 0, ~0u});
+
+    auto groupOf = [](const Record &r)
+    {
+        return glm::ivec2(glm::floor(r.column / static_cast<float>(GROUP_SIZE)));
+    };
+    std::stable_sort(m_Records.begin(), m_Records.end(), [&](const Record &a, const Record &b)
+                     {
+        glm::ivec2 ga = groupOf(a), gb = groupOf(b);
+        return ga.x != gb.x ? ga.x < gb.x : ga.y < gb.y; });
+
+    // Each group's boxes start on a batch boundary so a group is tested in whole batches.
+    const AABB none{glm::vec3(0.f), glm::vec3(0.f)};
+    m_Groups.clear();
+    m_Bounds.clear();
+    m_Bounds.reserve(m_Records.size() * 2);
+    for (size_t i = 0; i < m_Records.size(); ++i)
+    {
+        if (i == 0 || groupOf(m_Records[i]) != groupOf(m_Records[i - 1]) ||
+            m_Groups.back().count == GROUP_SIZE * GROUP_SIZE)
+        {
+            while (m_Bounds.size() % Frustum::BATCH_WIDTH)
+                m_Bounds.push_back(none);
+            m_Groups.push_back({static_cast<uint32_t>(i), 0, static_cast<uint32_t>(m_Bounds.size()), 0});
+        }
+        m_Records[i].group = static_cast<uint32_t>(m_Groups.size() - 1);
+        ++m_Groups.back().count;
+        m_Bounds.push_back(none);
+    }
+
+    m_GroupBounds.clear();
+    m_GroupBounds.reserve(m_Groups.size());
+    for (size_t g = 0; g < m_Groups.size(); ++g)
+        m_GroupBounds.push_back(none);
+
+    m_Sections.assign(m_Records.size(), MeshBounds{});
+    m_Graphs.assign(m_Records.size(), SectionGraph{});
+    m_Occluders.assign(m_Records.size(), ChunkOccluders{});
+    m_VisibleSections.assign(m_Records.size(), 0);
+    m_OutsideSections.assign(m_Records.size(), 0);
+
+    glm::ivec2 lo(0), hi(-1);
+    for (size_t i = 0; i < m_Records.size(); ++i)
+    {
+        glm::ivec2 c(m_Records[i].column);
+        lo = i == 0 ? c : glm::min(lo, c);
+        hi = i == 0 ? c : glm::max(hi, c);
+    }
+    m_GridMin = lo;
+    m_GridSize = hi - lo + 1;
+    m_Grid.assign(static_cast<size_t>(m_GridSize.x) * m_GridSize.y, NO_RECORD);
+    for (size_t i = 0; i < m_Records.size(); ++i)
+    {
+        glm::ivec2 c = glm::ivec2(m_Records[i].column) - m_GridMin;
+        m_Grid[static_cast<size_t>(c.y) * m_GridSize.x + c.x] = static_cast<uint32_t>(i);
+    }
+}
+
+uint32_t ChunkCuller::recordAt(int x, int z) const
+{
+    x -= m_GridMin.x;
+    z -= m_GridMin.y;
+    if (x < 0 || z < 0 || x >= m_GridSize.x || z >= m_GridSize.y)
+        return NO_RECORD;
+    return m_Grid[static_cast<size_t>(z) * m_GridSize.x + x];
+}
+
+// Breadth-first walk over sections from the camera's, after Checchi's "Advanced Cave Culling":
+// a section is entered only if the face it was reached through connects to the face it leaves
+// by, the walk never turns back against a direction it already took, and sections outside the
+// frustum are not entered. Since a path never turns back, its height is monotonic, so it
+// only needs sections between the camera's and the highest or lowest one with geometry.
+void ChunkCuller::findVisibleSections(const Frustum &frustum, const glm::vec3 &cameraPos)
+{
+    VC_PROFILE_ZONE("ChunkCuller::findVisibleSections");
+    constexpr int S = MeshBounds::SECTION_HEIGHT;
+    const uint32_t start = recordAt(static_cast<int>(std::floor(cameraPos.x / Chunk::WIDTH)),
+                                    static_cast<int>(std::floor(cameraPos.z / Chunk::DEPTH)));
+    const int startSection = static_cast<int>(std::floor(cameraPos.y / S));
+
+    m_Queue.clear();
+    if (!m_Settings.caveCulling || start == NO_RECORD || startSection < 0 || startSection >= MeshBounds::SECTION_COUNT)
+    {
+        std::fill(m_VisibleSections.begin(), m_VisibleSections.end(), ~0u);
+        return;
+    }
+
+    int lowest = startSection, highest = startSection;
+    if (m_GeometrySections)
+    {
+        lowest = std::min(lowest, std::countr_zero(m_GeometrySections));
+        highest = std::max(highest, 31 - std::countl_zero(m_GeometrySections));
+    }
+
+    std::fill(m_VisibleSections.begin(), m_VisibleSections.end(), 0u);
+    std::fill(m_OutsideSections.begin(), m_OutsideSections.end(), 0u);
+    m_VisibleSections[start] = 1u << startSection;
+    m_Queue.push_back({start, static_cast<int8_t>(startSection), -1, 0});
+
+    for (size_t head = 0; head < m_Queue.size(); ++head)
+    {
+        const Visit v = m_Queue[head];
+        const glm::ivec2 column(m_Records[v.record].column);
+        const SectionGraph &graph = m_Graphs[v.record];
+        for (int face = 0; face < SectionGraph::FACE_COUNT; ++face)
+        {
+            if (v.directions & (1u << SectionGraph::opposite(face)))
+                continue;
+            if (v.entryFace >= 0 && !graph.connected(v.section, v.entryFace, face))
+                continue;
+
+            uint32_t next = v.record;
+            int section = v.section;
+            switch (face)
+            {
+            case SectionGraph::NEG_X:
+                next = recordAt(column.x - 1, column.y);
+                break;
+            case SectionGraph::POS_X:
+                next = recordAt(column.x + 1, column.y);
+                break;
+            case SectionGraph::NEG_Y:
+                --section;
+                break;
+            case SectionGraph::POS_Y:
+                ++section;
+                break;
+            case SectionGraph::NEG_Z:
+                next = recordAt(column.x, column.y - 1);
+                break;
+            case SectionGraph::POS_Z:
+                next = recordAt(column.x, column.y + 1);
+                break;
+            }
+            if (next == NO_RECORD || section < lowest || section > highest ||
+                ((m_VisibleSections[next] | m_OutsideSections[next]) & (1u << section)))
+                continue;
+
+            const glm::vec3 min = m_Records[next].origin + glm::vec3(0.f, section * S, 0.f);
+            if (!frustum.intersects({min, min + glm::vec3(S)}))
+            {
+                m_OutsideSections[next] |= 1u << section;
+                continue;
+            }
+
+            m_VisibleSections[next] |= 1u << section;
+            m_Queue.push_back({next, static_cast<int8_t>(section), static_cast<int8_t>(SectionGraph::opposite(face)),
+                               static_cast<uint8_t>(v.directions | (1u << face))});
+        }
+    }
+}
+
+void ChunkCuller::buildOcclusionBuffer(const Frustum &frustum, const glm::mat4 &viewProj, const glm::vec3 &cameraPos)
+{
+    VC_PROFILE_ZONE("ChunkCuller::buildOcclusionBuffer");
+    m_Stats.occluders = 0;
+    m_OcclusionActive = m_Settings.occlusionCulling && m_Settings.occlusionRange > 0;
+    if (!m_OcclusionActive)
+        return;
+
+    constexpr int CELL = ChunkOccluders::CELL_SIZE;
+    constexpr int CELLS = ChunkOccluders::CELLS;
+    const int range = m_Settings.occlusionRange;
+    const glm::ivec2 center(static_cast<int>(std::floor(cameraPos.x / Chunk::WIDTH)),
+                            static_cast<int>(std::floor(cameraPos.z / Chunk::DEPTH)));
+
+    m_Occlusion.begin(viewProj, cameraPos, OCCLUSION_WIDTH, OCCLUSION_HEIGHT);
+    for (int dz = -range; dz <= range; ++dz)
+    {
+        for (int dx = -range; dx <= range; ++dx)
+        {
+            const uint32_t rec = recordAt(center.x + dx, center.y + dz);
+            if (rec == NO_RECORD)
+                continue;
+            const ChunkOccluders &occ = m_Occluders[rec];
+            const glm::vec3 &origin = m_Records[rec].origin;
+
+            // Neighbouring cells of a row with the same solid run become one box.
+            for (int z = 0; z < CELLS; ++z)
+            {
+                for (int x = 0; x < CELLS;)
+                {
+                    const ChunkOccluders::Cell &cell = occ.cells[z * CELLS + x];
+                    int end = x + 1;
+                    while (end < CELLS && occ.cells[z * CELLS + end].bottom == cell.bottom && occ.cells[z * CELLS + end].top == cell.top)
+                        ++end;
+
+                    if (cell.top > cell.bottom)
+                    {
+                        const AABB box{origin + glm::vec3(x * CELL, cell.bottom, z * CELL),
+                                       origin + glm::vec3(end * CELL, cell.top, (z + 1) * CELL)};
+                        if (frustum.intersects(box))
+                        {
+                            m_Occlusion.addOccluder(box);
+                            ++m_Stats.occluders;
+                        }
+                    }
+                    x = end;
+                }
+            }
+        }
+    }
+
+    const size_t bandRows = static_cast<size_t>(OCCLUSION_HEIGHT) / m_Parallel.concurrency() + 1;
+    m_Parallel.run(OCCLUSION_HEIGHT, bandRows, [&](size_t begin, size_t end, size_t)
+                   {
+        VC_PROFILE_ZONE("Rasterize occluders");
+        m_Occlusion.rasterize(static_cast<int>(begin), static_cast<int>(end)); });
+}
+
+// A chunk whose box is not hidden can still have every section with geometry hidden.
+bool ChunkCuller::isOccluded(size_t record, uint32_t sections) const
+{
+    if (m_Occlusion.isOccluded(m_Records[record].aabb))
+        return true;
+    if (std::has_single_bit(sections))
+        return false;
+    for (uint32_t m = sections; m; m &= m - 1)
+        if (!m_Occlusion.isOccluded(m_Sections[record].sectionAABB(std::countr_zero(m), m_Records[record].origin)))
+            return false;
+    return true;
+}
+
+void ChunkCuller::refreshCullData()
+{
+    VC_PROFILE_ZONE("ChunkCuller::refreshCullData");
+    bool changed = false;
+    for (size_t i = 0; i < m_Records.size(); ++i)
+    {
+        Record &r = m_Records[i];
+        const uint32_t revision = r.chunk->getCullDataRevision();
+        if (revision == r.boundsRevision)
+            continue;
+        r.boundsRevision = revision;
+        m_Sections[i] = r.chunk->getMeshBounds();
+        m_Graphs[i] = r.chunk->getSectionGraph();
+        m_Occluders[i] = r.chunk->getOccluders();
+        r.aabb = m_Sections[i].toAABB(r.origin);
+
+        Group &g = m_Groups[r.group];
+        const uint32_t member = static_cast<uint32_t>(i) - g.first;
+        if (m_Sections[i].empty())
+            g.geometryMask &= ~(1u << member);
+        else
+            g.geometryMask |= 1u << member;
+        m_Bounds.set(g.boundsFirst + member, r.aabb);
+        changed = true;
+    }
+    if (!changed)
+        return;
+
+    m_GeometrySections = 0;
+    for (const MeshBounds &b : m_Sections)
+        m_GeometrySections |= b.sectionMask;
+
+    for (size_t gi = 0; gi < m_Groups.size(); ++gi)
+    {
+        const Group &g = m_Groups[gi];
+        AABB box{glm::vec3(0.f), glm::vec3(0.f)};
+        bool first = true;
+        for (uint32_t m = g.geometryMask; m; m &= m - 1)
+        {
+            const AABB &member = m_Records[g.first + std::countr_zero(m)].aabb;
+            box.min = first ? member.min : glm::min(box.min, member.min);
+            box.max = first ? member.max : glm::max(box.max, member.max);
+            first = false;
+        }
+        m_GroupBounds.set(gi, box);
+    }
+}
+
+void ChunkCuller::cull(const ChunkMap &chunks, uint64_t chunkSetVersion, uint64_t cullDataVersion, const Frustum &frustum,
+                       const glm::mat4 &viewProj, const glm::vec3 &cameraPos, const glm::ivec3 &playerChunkPos,
+                       DrawList &opaque, DrawList &transparent)
+{
+    VC_PROFILE_ZONE("ChunkCuller::cull");
+    if (chunkSetVersion != m_RecordsVersion || m_Records.size() != chunks.size())
+    {
+        rebuildRecords(chunks);
+        m_RecordsVersion = chunkSetVersion;
+        m_CullDataVersion = ~0ull;
+    }
+    if (cullDataVersion != m_CullDataVersion)
+    {
+        refreshCullData();
+        m_CullDataVersion = cullDataVersion;
+    }
+
+    findVisibleSections(frustum, cameraPos);
+    buildOcclusionBuffer(frustum, viewProj, cameraPos);
+
+    for (SlotOutput &slot : m_Slots)
+    {
+        slot.opaque.clear();
+        slot.transparent.clear();
+        slot.groupsInFrustum = 0;
+        slot.inFrustum = 0;
+        slot.sectionRejected = 0;
+        slot.caveRejected = 0;
+        slot.occlusionRejected = 0;
+    }
+
+    const float lod0Distance = m_Settings.lodDistances.empty() ? -1.f : static_cast<float>(m_Settings.lodDistances[0]);
+    const glm::vec2 playerColumn(playerChunkPos.x, playerChunkPos.z);
+
+    auto emit = [&](size_t i, SlotOutput &out)
+    {
+        const Record &r = m_Records[i];
+        int req = glm::distance(r.column, playerColumn) <= lod0Distance ? 0 : 1;
+        int best = r.chunk->getBestAvailableLOD(req);
+        if (best == -1)
+            return;
+
+        glm::vec3 toCamera = (r.aabb.min + r.aabb.max) * 0.5f - cameraPos;
+        const float distanceSq = glm::dot(toCamera, toCamera);
+        const uint32_t mesh = static_cast<uint32_t>(i) << LOD_BITS | static_cast<uint32_t>(best);
+
+        const ChunkMesh *opaqueMesh = r.chunk->getMesh(best);
+        if (opaqueMesh && opaqueMesh->indexCount > 0)
+            out.opaque.push_back(DrawKey::make(DrawKey::MAIN_PIPELINE, distanceSq, DrawKey::Order::FRONT_TO_BACK, mesh));
+
+        const ChunkMesh *transparentMesh = r.chunk->getTransparentMesh(best);
+        if (transparentMesh && transparentMesh->indexCount > 0)
+            out.transparent.push_back(DrawKey::make(DrawKey::WATER_PIPELINE, distanceSq, DrawKey::Order::BACK_TO_FRONT, mesh));
+    };
+
+    // cut: the frustum crosses the chunk's bounds, so its sections need testing.
+    auto accept = [&](size_t i, bool cut, SlotOutput &out)
+    {
+        const uint32_t sections = m_Sections[i].sectionMask & m_VisibleSections[i];
+        if (!sections)
+        {
+            ++out.caveRejected;
+            return;
+        }
+        if (cut && !anySectionVisible(frustum, sections, m_Sections[i], m_Records[i].origin))
+        {
+            ++out.sectionRejected;
+            return;
+        }
+        if (m_OcclusionActive && isOccluded(i, sections))
+        {
+            ++out.occlusionRejected;
+            return;
+        }
+        ++out.inFrustum;
+        emit(i, out);
+    };
+
+    // Batches start on a multiple of the frustum test width.
+    size_t grain = std::max(MIN_GROUPS_PER_BATCH, m_Groups.size() / (m_Parallel.concurrency() * BATCHES_PER_SLOT) + 1);
+    grain = (grain + Frustum::BATCH_WIDTH - 1) / Frustum::BATCH_WIDTH * Frustum::BATCH_WIDTH;
+    m_Parallel.run(m_Groups.size(), grain, [&](size_t begin, size_t end, size_t slotIndex)
+                   {
+        VC_PROFILE_ZONE("Cull batch");
+        SlotOutput &out = m_Slots[slotIndex];
+        for (size_t first = begin; first < end; first += Frustum::BATCH_WIDTH)
+        {
+            const Frustum::BatchResult groups = frustum.testBatch(m_GroupBounds, first);
+            uint32_t visible = groups.visible;
+            for (size_t k = 0; k < Frustum::BATCH_WIDTH && first + k < end; ++k)
+                if (!m_Groups[first + k].geometryMask)
+                    visible &= ~(1u << k);
+            out.groupsInFrustum += std::popcount(visible);
+
+            for (; visible; visible &= visible - 1)
+            {
+                const int lane = std::countr_zero(visible);
+                const Group &g = m_Groups[first + lane];
+                if (groups.inside & (1u << lane))
+                {
+                    for (uint32_t m = g.geometryMask; m; m &= m - 1)
+                        accept(g.first + std::countr_zero(m), false, out);
+                    continue;
+                }
+
+                for (uint32_t b = 0; b < g.count; b += Frustum::BATCH_WIDTH)
+                {
+                    const Frustum::BatchResult members = frustum.testBatch(m_Bounds, g.boundsFirst + b);
+                    const uint32_t hit = members.visible & (g.geometryMask >> b);
+                    for (uint32_t m = hit; m; m &= m - 1)
+                    {
+                        const int bit = std::countr_zero(m);
+                        accept(g.first + b + bit, !(members.inside & (1u << bit)), out);
+                    }
+                }
+            }
+        } });
+
+    auto merge = [&](std::vector<uint64_t> SlotOutput::*list, DrawList &dst)
+    {
+        m_Merged.clear();
+        for (const SlotOutput &slot : m_Slots)
+            m_Merged.insert(m_Merged.end(), (slot.*list).begin(), (slot.*list).end());
+
+        {
+            VC_PROFILE_ZONE("Sort draw keys");
+            DrawKey::sort(m_Merged, m_SortScratch);
+        }
+
+        dst.clear();
+        dst.reserve(m_Merged.size());
+        for (uint64_t key : m_Merged)
+        {
+            const uint32_t mesh = DrawKey::mesh(key);
+            dst.emplace_back(m_Records[mesh >> LOD_BITS].chunk, static_cast<int>(mesh & ((1u << LOD_BITS) - 1)));
+        }
+    };
+
+    merge(&SlotOutput::opaque, opaque);
+    merge(&SlotOutput::transparent, transparent);
+
+    m_Stats.records = m_Records.size();
+    m_Stats.groups = m_Groups.size();
+    m_Stats.groupsInFrustum = 0;
+    m_Stats.inFrustum = 0;
+    m_Stats.sectionRejected = 0;
+    m_Stats.caveRejected = 0;
+    m_Stats.occlusionRejected = 0;
+    m_Stats.sectionsReached = m_Queue.size();
+    for (const SlotOutput &slot : m_Slots)
+    {
+        m_Stats.groupsInFrustum += slot.groupsInFrustum;
+        m_Stats.inFrustum += slot.inFrustum;
+        m_Stats.sectionRejected += slot.sectionRejected;
+        m_Stats.caveRejected += slot.caveRejected;
+        m_Stats.occlusionRejected += slot.occlusionRejected;
+    }
+    m_Stats.opaque = opaque.size();
+    m_Stats.transparent = transparent.size();
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include "Chunk.h"
+#include "Settings.h"
+#include "ParallelFor.h"
+#include "OcclusionBuffer.h"
+#include "math/AABB.h"
+#include "math/Frustum.h"
+#include "math/Ivec3Less.h"
+#include <glm/glm.hpp>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// Builds the per-frame draw lists. Chunks are kept in a flat record array that is only
+// rebuilt when the chunk set changes, sorted into 4x4 column groups. Each frame the group
+// bounds are tested first; only groups the frustum cuts have their chunks tested, and only
+// chunks it cuts have their mesh sections tested. All bounds are the tight mesh bounds, so
+// a chunk whose geometry is all below or above the view is rejected. With cave culling a
+// walk over the section graphs from the camera's section first finds the sections that can
+// be seen at all, and chunks with no geometry in those are skipped. With occlusion culling the
+// solid occluder boxes of nearby chunks are rasterized into a small depth buffer, and chunks
+// and sections hidden behind them are skipped too. Opaque chunks come out front to back,
+// transparent ones back to front, by radix-sorted DrawKeys.
+class ChunkCuller
+{
+public:
+    using ChunkMap = std::map<glm::ivec3, std::shared_ptr<Chunk>, ivec3_less>;
+    using DrawList = std::pmr::vector<std::pair<Chunk *, int>>;
+
+    struct Stats
+    {
+        size_t records = 0;
+        size_t groups = 0;
+        size_t groupsInFrustum = 0;
+        size_t inFrustum = 0;
+        size_t sectionRejected = 0;
+        size_t caveRejected = 0;
+        size_t sectionsReached = 0;
+        size_t occluders = 0;
+        size_t occlusionRejected = 0;
+        size_t opaque = 0;
+        size_t transparent = 0;
+    };
+
+    ChunkCuller(const Settings &settings, size_t threadCount);
+
+    static constexpr int GROUP_SIZE = 4;
+    static constexpr int OCCLUSION_WIDTH = 256;
+    static constexpr int OCCLUSION_HEIGHT = 128;
+
+    // chunkSetVersion must change whenever chunks are added to or removed from the map, and
+    // cullDataVersion whenever a chunk's mesh bounds, section graph or occluders may have changed.
+    // frustum must be built from viewProj.
+    void cull(const ChunkMap &chunks, uint64_t chunkSetVersion, uint64_t cullDataVersion, const Frustum &frustum,
+              const glm::mat4 &viewProj, const glm::vec3 &cameraPos, const glm::ivec3 &playerChunkPos,
+              DrawList &opaque, DrawList &transparent);
+
+    const Stats &getStats() const { return m_Stats; }
+    const OcclusionBuffer &getOcclusionBuffer() const { return m_Occlusion; }
+
+private:
+    struct Record
+    {
+        Chunk *chunk;
+        AABB aabb;
+        glm::vec2 column;
+        glm::vec3 origin;
+        uint32_t group;
+        uint32_t boundsRevision;
+    };
+
+    // Members are records [first, first + count) and boxes [boundsFirst, ...) in m_Bounds.
+    struct Group
+    {
+        uint32_t first;
+        uint32_t count;
+        uint32_t boundsFirst;
+        uint32_t geometryMask;
+    };
+
+    struct Visit
+    {
+        uint32_t record;
+        int8_t section;
+        int8_t entryFace;
+        uint8_t directions;
+    };
+
+    struct alignas(64) SlotOutput
+    {
+        // DrawKeys whose mesh is record << LOD_BITS | lod.
+        std::vector<uint64_t> opaque;
+        std::vector<uint64_t> transparent;
+        size_t groupsInFrustum = 0;
+        size_t inFrustum = 0;
+        size_t sectionRejected = 0;
+        size_t caveRejected = 0;
+        size_t occlusionRejected = 0;
+    };
+
+    static constexpr uint32_t NO_RECORD = ~0u;
+    static constexpr uint32_t LOD_BITS = 4;
+
+    void rebuildRecords(const ChunkMap &chunks);
+    void refreshCullData();
+    uint32_t recordAt(int x, int z) const;
+    void findVisibleSections(const Frustum &frustum, const glm::vec3 &cameraPos);
+    void buildOcclusionBuffer(const Frustum &frustum, const glm::mat4 &viewProj, const glm::vec3 &cameraPos);
+    bool isOccluded(size_t record, uint32_t sections) const;
+
+    const Settings &m_Settings;
+    ParallelFor m_Parallel;
+
+    std::vector<Record> m_Records;
+    std::vector<MeshBounds> m_Sections;
+    std::vector<SectionGraph> m_Graphs;
+    std::vector<ChunkOccluders> m_Occluders;
+    std::vector<uint32_t> m_VisibleSections;
+    std::vector<uint32_t> m_OutsideSections;
+    std::vector<Visit> m_Queue;
+    // Record index per loaded column, over the bounding rectangle of the chunk set.
+    std::vector<uint32_t> m_Grid;
+    glm::ivec2 m_GridMin{0};
+    glm::ivec2 m_GridSize{0};
+    // Sections that have geometry in any chunk.
+    uint32_t m_GeometrySections = 0;
+    OcclusionBuffer m_Occlusion;
+    bool m_OcclusionActive = false;
+    std::vector<Group> m_Groups;
+    AABBSoA m_Bounds;
+    AABBSoA m_GroupBounds;
+    uint64_t m_RecordsVersion = ~0ull;
+    uint64_t m_CullDataVersion = ~0ull;
+    std::vector<SlotOutput> m_Slots;
+    std::vector<uint64_t> m_Merged;
+    std::vector<uint64_t> m_SortScratch;
+    Stats m_Stats;
+};
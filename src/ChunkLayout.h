@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+
+namespace ChunkLayout
+{
+    constexpr int WIDTH = 16;
+    constexpr int HEIGHT = 256;
+    constexpr int DEPTH = 16;
+    constexpr size_t VOLUME = static_cast<size_t>(WIDTH) * HEIGHT * DEPTH;
+
+    constexpr size_t index(int x, int y, int z)
+    {
+        return static_cast<size_t>(y) * WIDTH * DEPTH + static_cast<size_t>(z) * WIDTH + x;
+    }
+}
@@ -0,0 +1,39 @@
+#include "DrawKey.h"
+#include <array>
+
+void DrawKey::sort(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch)
+{
+    constexpr int PASSES = sizeof(uint64_t);
+    const size_t n = keys.size();
+    if (n < 2)
+        return;
+
+    std::array<std::array<uint32_t, 256>, PASSES> counts{};
+    for (uint64_t key : keys)
+        for (int pass = 0; pass < PASSES; ++pass)
+            ++counts[pass][(key >> (pass * 8)) & 0xff];
+
+    scratch.resize(n);
+    std::vector<uint64_t> *src = &keys, *dst = &scratch;
+    for (int pass = 0; pass < PASSES; ++pass)
+    {
+        std::array<uint32_t, 256> &count = counts[pass];
+        const uint64_t first = ((*src)[0] >> (pass * 8)) & 0xff;
+        if (count[first] == n)
+            continue;
+
+        uint32_t offset = 0;
+        for (uint32_t &c : count)
+        {
+            const uint32_t bucket = c;
+            c = offset;
+            offset += bucket;
+        }
+        for (uint64_t key : *src)
+            (*dst)[count[(key >> (pass * 8)) & 0xff]++] = key;
+        std::swap(src, dst);
+    }
+
+    if (src != &keys)
+        keys.swap(scratch);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 64-bit draw sort keys: the pipeline in the top bit, then the squared view distance as its
+// float bits (inverted for back to front), then 32 bits identifying the mesh. Ascending key
+// order groups draws by pipeline, orders each group by depth and breaks ties by mesh.
+namespace DrawKey
+{
+    // Chunk pipelines in draw order; opaque chunks use the main one.
+    enum Pipeline : uint64_t
+    {
+        MAIN_PIPELINE = 0,
+        WATER_PIPELINE = 1
+    };
+
+    enum class Order
+    {
+        FRONT_TO_BACK,
+        BACK_TO_FRONT
+    };
+
+    inline uint64_t make(Pipeline pipeline, float distanceSq, Order order, uint32_t mesh)
+    {
+        // Non-negative floats order like their bits, and the sign bit is always clear.
+        uint64_t depth = std::bit_cast<uint32_t>(distanceSq > 0.f ? distanceSq : 0.f);
+        if (order == Order::BACK_TO_FRONT)
+            depth = 0x7fffffffu - depth;
+        return pipeline << 63 | depth << 32 | mesh;
+    }
+
+    inline uint32_t mesh(uint64_t key) { return static_cast<uint32_t>(key); }
+
+    // LSD radix sort, 8 bits per pass, skipping bytes all keys share. Stable; scratch is reused
+    // between calls.
+    void sort(std::vector<uint64_t> &keys, std::vector<uint64_t> &scratch);
+}
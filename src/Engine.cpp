@@ -1,4 +1,5 @@
 #include "Engine.h"
+#include "Profiler.h"
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -10,51 +11,43 @@
 #include <glm/gtx/norm.hpp>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    PlayerInput readPlayerInput(GLFWwindow *window)
+    {
+        PlayerInput in;
+        in.forward = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS;
+        in.back = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS;
+        in.left = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
+        in.right = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
+        in.jump = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+        in.sprint = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS;
+        return in;
+    }
+}
 
 Engine::Engine()
     : m_Window(WIDTH, HEIGHT, "Vibecraft", m_Settings),
-      m_Renderer(m_Window, m_Settings, m_player_ptr, &m_TerrainGen),
-      m_debugController(this)
+      m_Renderer(m_Window, m_Settings, m_player_ptr),
+      m_debugController(this),
+      m_World(m_Settings, m_Renderer)
 {
     glfwSetInputMode(m_Window.getGLFWwindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-    const int ws = 8;
-    for (int x = -ws / 2; x < ws / 2; ++x)
-        for (int z = -ws / 2; z < ws / 2; ++z)
-            m_ChunksToGenerate.insert({x, 0, z});
-
-    auto player = std::make_unique<Player>(this, glm::vec3(0.f, 120.f, 0.f), m_Settings);
+    auto player = std::make_unique<Player>(&m_World, glm::vec3(0.f, 120.f, 0.f), m_Settings);
     m_player_ptr = player.get();
     m_entities.push_back(std::move(player));
 }
 
 Engine::~Engine()
 {
-    m_Pool.shutdown();
     vkDeviceWaitIdle(m_Renderer.getDeviceContext()->getDevice());
 }
 
-Block Engine::get_block(int x, int y, int z)
-{
-    if (y < 0 || y >= Chunk::HEIGHT)
-    {
-        return {BlockId::AIR};
-    }
-
-    int chunk_x = static_cast<int>(floor(static_cast<float>(x) / Chunk::WIDTH));
-    int chunk_z = static_cast<int>(floor(static_cast<float>(z) / Chunk::DEPTH));
-
-    auto it = m_Chunks.find({chunk_x, 0, chunk_z});
-    if (it != m_Chunks.end() && it->second->getState() >= Chunk::State::TERRAIN_READY)
-    {
-        int local_x = x - chunk_x * Chunk::WIDTH;
-        int local_z = z - chunk_z * Chunk::DEPTH;
-        return it->second->getBlock(local_x, y, local_z);
-    }
-
-    return {BlockId::AIR};
-}
-
 void Engine::run()
 {
     bool mouse_enabled = true;
@@ -65,9 +58,11 @@ void Engine::run()
     int frames = 0;
 
     const float FIXED_TIMESTEP = 1.0f / 60.0f;
+    Profiler::setThreadName("Main");
 
     while (!m_Window.shouldClose())
     {
+        VC_PROFILE_ZONE("Frame");
         float now = static_cast<float>(glfwGetTime());
         float dt = now - last_time;
         last_time = now;
@@ -78,6 +73,8 @@ void Engine::run()
         }
 
         m_FrameEMA = 0.9 * m_FrameEMA + 0.1 * dt;
+        const double frameWork = std::max(0.0, dt - m_Renderer.getLastFrameWaitSeconds());
+        m_FrameWorkEMA = 0.9 * m_FrameWorkEMA + 0.1 * frameWork;
 
         glfwPollEvents();
         processInput(dt, mouse_enabled, last_cursor_x, last_cursor_y);
@@ -89,10 +86,11 @@ void Engine::run()
             m_timeAccumulator -= 1.0f / m_ticksPerSecond;
         }
 
+        PlayerInput input = readPlayerInput(m_Window.getGLFWwindow());
         m_physicsAccumulator += dt;
         while (m_physicsAccumulator >= FIXED_TIMESTEP)
         {
-            m_player_ptr->process_keyboard(m_Window.getGLFWwindow(), FIXED_TIMESTEP);
+            m_player_ptr->process_keyboard(input, FIXED_TIMESTEP);
             for (auto &entity : m_entities)
             {
                 entity->update(FIXED_TIMESTEP);
@@ -102,12 +100,19 @@ void Engine::run()
 
         const float alpha = m_physicsAccumulator / FIXED_TIMESTEP;
 
-        m_player_ptr->update_camera_interpolated(this, alpha);
+        auto ext = m_Window.getExtent();
+        float aspect = ext.height > 0 ? static_cast<float>(ext.width) / ext.height : 0.f;
+        m_player_ptr->update_camera_interpolated(alpha, aspect);
+
+        FrameArena &frameArena = m_Renderer.beginFrameArena();
 
         if (m_showDebugOverlay)
         {
             float fps = 1.0f / m_FrameEMA;
-            m_Renderer.getDebugOverlay()->update(*m_player_ptr, m_Settings, fps, m_TerrainGen.getSeed());
+            updateSaveStats();
+            updatePipelineStats();
+            updateFrameArenaStats();
+            m_Renderer.getDebugOverlay()->update(*m_player_ptr, m_Settings, fps, m_World.getTerrainGenerator().getSeed());
         }
 
         glm::vec3 hovered_block_pos_float;
@@ -120,13 +125,13 @@ void Engine::run()
             m_hoveredBlockPos.reset();
         }
 
-        std::vector<glm::vec3> outlineVertices;
+        std::pmr::vector<glm::vec3> outlineVertices(&frameArena);
         if (m_hoveredBlockPos)
         {
             generateBlockOutline(*m_hoveredBlockPos, outlineVertices);
         }
 
-        std::vector<AABB> debug_aabbs;
+        std::pmr::vector<AABB> debug_aabbs(&frameArena);
         if (m_Settings.showCollisionBoxes)
         {
             debug_aabbs.push_back(m_player_ptr->get_world_aabb());
@@ -138,7 +143,7 @@ void Engine::run()
                 {
                     for (int z = static_cast<int>(p_pos.z) - radius; z < static_cast<int>(p_pos.z) + radius; ++z)
                     {
-                        Block block = get_block(x, y, z);
+                        Block block = m_World.get_block(x, y, z);
                         if (BlockDatabase::get().get_block_data(block.id).is_solid)
                         {
                             debug_aabbs.push_back({glm::vec3(x, y, z), glm::vec3(x + 1, y + 1, z + 1)});
@@ -149,13 +154,14 @@ void Engine::run()
         }
 
         glm::vec3 player_pos_logic = m_player_ptr->get_position();
-        updateChunks(player_pos_logic);
+        m_World.updateChunks(player_pos_logic, m_FrameWorkEMA);
 
         glm::ivec3 playerChunkPos{
             static_cast<int>(std::floor(player_pos_logic.x / Chunk::WIDTH)), 0,
             static_cast<int>(std::floor(player_pos_logic.z / Chunk::DEPTH))};
 
-        if (!m_Renderer.drawFrame(m_player_ptr->get_camera(), player_pos_logic, m_Chunks, playerChunkPos,
+        if (!m_Renderer.drawFrame(m_player_ptr->get_camera(), player_pos_logic, m_World.getChunks(),
+                                  m_World.getChunkSetVersion(), m_World.getCullDataVersion(), playerChunkPos,
                                   m_gameTicks, debug_aabbs, m_showDebugOverlay, outlineVertices, m_hoveredBlockPos))
         {
             continue;
@@ -205,6 +211,17 @@ void Engine::processInput(float dt, bool &mouse_enabled, double &lx, double &ly)
         m_Settings.showCollisionBoxes = !m_Settings.showCollisionBoxes;
     cLast = cNow;
 
+    static bool f9Last = false;
+    bool f9Now = glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS;
+    if (f9Now && !f9Last && Profiler::ENABLED)
+    {
+        if (Profiler::writeChromeTrace("vibecraft_trace.json"))
+            std::cout << "Profiler: wrote vibecraft_trace.json" << std::endl;
+        else
+            std::cerr << "Profiler: failed to write vibecraft_trace.json" << std::endl;
+    }
+    f9Last = f9Now;
+
     if (mouse_enabled)
     {
         double mx, my;
@@ -225,7 +242,7 @@ void Engine::processInput(float dt, bool &mouse_enabled, double &lx, double &ly)
         glm::vec3 block_pos;
         if (m_player_ptr->raycast(block_pos))
         {
-            set_block(
+            m_World.set_block(
                 static_cast<int>(block_pos.x),
                 static_cast<int>(block_pos.y),
                 static_cast<int>(block_pos.z),
@@ -270,54 +287,7 @@ void Engine::processInput(float dt, bool &mouse_enabled, double &lx, double &ly)
     lLast = lNow;
 }
 
-void Engine::set_block(int x, int y, int z, BlockId id)
-{
-    if (y < 0 || y >= Chunk::HEIGHT)
-        return;
-
-    auto set_chunk_dirty = [&](int block_x, int block_z)
-    {
-        int chunk_x = static_cast<int>(floor(static_cast<float>(block_x) / Chunk::WIDTH));
-        int chunk_z = static_cast<int>(floor(static_cast<float>(block_z) / Chunk::DEPTH));
-        auto it = m_Chunks.find({chunk_x, 0, chunk_z});
-        if (it != m_Chunks.end())
-        {
-            it->second->setBlock(block_x - chunk_x * Chunk::WIDTH, y, block_z - chunk_z * Chunk::DEPTH, {id});
-        }
-    };
-
-    set_chunk_dirty(x, z);
-
-    int local_x = x % Chunk::WIDTH;
-    if (local_x < 0)
-        local_x += Chunk::WIDTH;
-    int local_z = z % Chunk::DEPTH;
-    if (local_z < 0)
-        local_z += Chunk::DEPTH;
-
-    auto mark_neighbor_dirty = [&](int nx, int nz)
-    {
-        int chunk_x = static_cast<int>(floor(static_cast<float>(nx) / Chunk::WIDTH));
-        int chunk_z = static_cast<int>(floor(static_cast<float>(nz) / Chunk::DEPTH));
-        auto it = m_Chunks.find({chunk_x, 0, chunk_z});
-
-        if (it != m_Chunks.end())
-        {
-            it->second->m_is_dirty.store(true);
-        }
-    };
-
-    if (local_x == 0)
-        mark_neighbor_dirty(x - 1, z);
-    if (local_x == Chunk::WIDTH - 1)
-        mark_neighbor_dirty(x + 1, z);
-    if (local_z == 0)
-        mark_neighbor_dirty(x, z - 1);
-    if (local_z == Chunk::DEPTH - 1)
-        mark_neighbor_dirty(x, z + 1);
-}
-
-void Engine::generateBlockOutline(const glm::ivec3 &pos, std::vector<glm::vec3> &vertices)
+void Engine::generateBlockOutline(const glm::ivec3 &pos, std::pmr::vector<glm::vec3> &vertices)
 {
     vertices.clear();
 
@@ -327,9 +297,9 @@ void Engine::generateBlockOutline(const glm::ivec3 &pos, std::vector<glm::vec3>
         vertices.push_back(v2);
     };
 
-    auto check_face = [&](const glm::ivec3 &neighbor_pos, const std::vector<std::pair<glm::vec3, glm::vec3>> &edges)
+    auto check_face = [&](const glm::ivec3 &neighbor_pos, const std::array<std::pair<glm::vec3, glm::vec3>, 4> &edges)
     {
-        Block block = get_block(neighbor_pos.x, neighbor_pos.y, neighbor_pos.z);
+        Block block = m_World.get_block(neighbor_pos.x, neighbor_pos.y, neighbor_pos.z);
         if (!BlockDatabase::get().get_block_data(block.id).is_solid)
         {
             for (const auto &edge : edges)
@@ -342,12 +312,12 @@ void Engine::generateBlockOutline(const glm::ivec3 &pos, std::vector<glm::vec3>
     const glm::vec3 v000(0, 0, 0), v100(1, 0, 0), v110(1, 1, 0), v010(0, 1, 0);
     const glm::vec3 v001(0, 0, 1), v101(1, 0, 1), v111(1, 1, 1), v011(0, 1, 1);
 
-    const std::vector<std::pair<glm::vec3, glm::vec3>> posX_edges = {{v100, v110}, {v110, v111}, {v111, v101}, {v101, v100}};
-    const std::vector<std::pair<glm::vec3, glm::vec3>> negX_edges = {{v001, v011}, {v011, v010}, {v010, v000}, {v000, v001}};
-    const std::vector<std::pair<glm::vec3, glm::vec3>> posY_edges = {{v010, v110}, {v110, v111}, {v111, v011}, {v011, v010}};
-    const std::vector<std::pair<glm::vec3, glm::vec3>> negY_edges = {{v001, v101}, {v101, v100}, {v100, v000}, {v000, v001}};
-    const std::vector<std::pair<glm::vec3, glm::vec3>> posZ_edges = {{v101, v111}, {v111, v011}, {v011, v001}, {v001, v101}};
-    const std::vector<std::pair<glm::vec3, glm::vec3>> negZ_edges = {{v000, v010}, {v010, v110}, {v110, v100}, {v100, v000}};
+    const std::array<std::pair<glm::vec3, glm::vec3>, 4> posX_edges = {{{v100, v110}, {v110, v111}, {v111, v101}, {v101, v100}}};
+    const std::array<std::pair<glm::vec3, glm::vec3>, 4> negX_edges = {{{v001, v011}, {v011, v010}, {v010, v000}, {v000, v001}}};
+    const std::array<std::pair<glm::vec3, glm::vec3>, 4> posY_edges = {{{v010, v110}, {v110, v111}, {v111, v011}, {v011, v010}}};
+    const std::array<std::pair<glm::vec3, glm::vec3>, 4> negY_edges = {{{v001, v101}, {v101, v100}, {v100, v000}, {v000, v001}}};
+    const std::array<std::pair<glm::vec3, glm::vec3>, 4> posZ_edges = {{{v101, v111}, {v111, v011}, {v011, v001}, {v001, v101}}};
+    const std::array<std::pair<glm::vec3, glm::vec3>, 4> negZ_edges = {{{v000, v010}, {v010, v110}, {v110, v100}, {v100, v000}}};
 
     check_face({pos.x + 1, pos.y, pos.z}, posX_edges);
     check_face({pos.x - 1, pos.y, pos.z}, negX_edges);
@@ -371,270 +341,57 @@ void Engine::updateWindowTitle(float now, float &fpsTime, int &frames, const glm
     }
 }
 
-void Engine::createChunkContainer(const glm::ivec3 &pos)
-{
-    if (m_Chunks.count(pos))
-        return;
-
-    auto ch = std::make_shared<Chunk>(pos);
-    Chunk *raw = ch.get();
-    m_Chunks[pos] = std::move(ch);
-
-    m_Pool.submit([this, raw](std::stop_token st)
-                  {
-        if (st.stop_requested()) return;
-        m_TerrainGen.populateChunk(*raw); });
-}
-
-void Engine::updateChunks(const glm::vec3 &cam_pos)
+void Engine::updateSaveStats()
 {
-    glm::ivec3 playerChunkPos{
-        static_cast<int>(std::floor(cam_pos.x / Chunk::WIDTH)), 0,
-        static_cast<int>(std::floor(cam_pos.z / Chunk::DEPTH))};
-
-    unloadDistantChunks(playerChunkPos);
-    processGarbage();
-    loadVisibleChunks(playerChunkPos);
-    createMeshJobs(playerChunkPos);
-    submitMeshJobs();
-    uploadReadyMeshes();
-}
+    char buf[128];
+    std::vector<std::string> lines;
 
-void Engine::unloadDistantChunks(const glm::ivec3 &playerChunkPos)
-{
-    std::vector<glm::ivec3> chunksToUnload;
-    for (auto &[pos, chunk] : m_Chunks)
+    if (const MeshCache *meshCache = m_World.getMeshCache())
     {
-        if (std::max(std::abs(pos.x - playerChunkPos.x), std::abs(pos.z - playerChunkPos.z)) > m_Settings.renderDistance)
-        {
-            chunksToUnload.push_back(pos);
-        }
+        MeshCache::Stats mc = meshCache->getStats();
+        std::snprintf(buf, sizeof(buf), "Hits: %llu  Misses: %llu  Stored: %llu (%.1f MB)",
+                      (unsigned long long)mc.hits, (unsigned long long)mc.misses, (unsigned long long)mc.stores,
+                      mc.bytesWritten / 1048576.0);
+        m_Renderer.getDebugOverlay()->setSection("Mesh cache", {buf});
     }
 
-    for (auto &pos : chunksToUnload)
+    if (const EditLog *editLog = m_World.getEditLog())
     {
-        m_Garbage.push_back(std::move(m_Chunks.at(pos)));
-        m_Chunks.erase(pos);
-    }
-}
-
-void Engine::processGarbage()
-{
-
-    if (m_Garbage.empty())
+        std::snprintf(buf, sizeof(buf), "Edit log: %zu live edits, %zu records on disk",
+                      editLog->liveEditCount(), editLog->fileRecordCount());
+        lines.emplace_back(buf);
+        m_Renderer.getDebugOverlay()->setSection("Saving", std::move(lines));
         return;
-
-    m_Garbage.erase(
-        std::remove_if(m_Garbage.begin(), m_Garbage.end(),
-                       [this](const std::shared_ptr<Chunk> &chunk)
-                       {
-                           if (chunk.use_count() == 1)
-                           {
-
-                               m_Renderer.scheduleChunkGpuCleanup(chunk);
-                               return true;
-                           }
-                           return false;
-                       }),
-        m_Garbage.end());
-}
-
-void Engine::loadVisibleChunks(const glm::ivec3 &playerChunkPos)
-{
-    std::vector<glm::ivec3> chunk_positions_to_load;
-
-    for (int z = -m_Settings.renderDistance; z <= m_Settings.renderDistance; ++z)
-    {
-        for (int x = -m_Settings.renderDistance; x <= m_Settings.renderDistance; ++x)
-        {
-            glm::ivec3 chunkPos = playerChunkPos + glm::ivec3(x, 0, z);
-            if (!m_Chunks.count(chunkPos))
-            {
-                chunk_positions_to_load.push_back(chunkPos);
-            }
-        }
     }
 
-    glm::vec2 player_pos_2d(playerChunkPos.x, playerChunkPos.z);
-    std::sort(chunk_positions_to_load.begin(), chunk_positions_to_load.end(),
-              [&](const glm::ivec3 &a, const glm::ivec3 &b)
-              {
-                  float dist_a = glm::distance2(glm::vec2(a.x, a.z), player_pos_2d);
-                  float dist_b = glm::distance2(glm::vec2(b.x, b.z), player_pos_2d);
-                  return dist_a < dist_b;
-              });
-
-    int chunks_created_this_frame = 0;
-    for (const auto &pos : chunk_positions_to_load)
-    {
-        if (chunks_created_this_frame >= m_Settings.chunksToCreatePerFrame)
-        {
-            break;
-        }
-        createChunkContainer(pos);
-        chunks_created_this_frame++;
-    }
+    ChunkSaver::Stats st = m_World.getChunkSaver().getStats();
+
+    std::snprintf(buf, sizeof(buf), "Queue: %zu chunks, %.1f / %.0f MB (peak %.1f)", st.pendingChunks,
+                  st.pendingBytes / 1048576.0, st.budgetBytes / 1048576.0, st.peakPendingBytes / 1048576.0);
+    lines.emplace_back(buf);
+    std::snprintf(buf, sizeof(buf), "Submitted: %llu  Coalesced: %llu  Written: %llu",
+                  (unsigned long long)st.submitted, (unsigned long long)st.coalesced, (unsigned long long)st.written);
+    lines.emplace_back(buf);
+    std::snprintf(buf, sizeof(buf), "Backpressure: %llu rejected, %llu blocked",
+                  (unsigned long long)st.rejected, (unsigned long long)st.blockedSubmits);
+    lines.emplace_back(buf);
+    std::snprintf(buf, sizeof(buf), "Batches: %llu  Syncs: %llu  Failures: %llu",
+                  (unsigned long long)st.batches, (unsigned long long)st.syncs, (unsigned long long)st.failures);
+    lines.emplace_back(buf);
+
+    m_Renderer.getDebugOverlay()->setSection("Saving", std::move(lines));
 }
 
-void Engine::createMeshJobs(const glm::ivec3 &playerChunkPos)
+void Engine::updatePipelineStats()
 {
-    std::vector<std::pair<glm::ivec3, int>> pending;
-
-    for (int z = -m_Settings.renderDistance; z <= m_Settings.renderDistance; ++z)
-    {
-        for (int x = -m_Settings.renderDistance; x <= m_Settings.renderDistance; ++x)
-        {
-            glm::ivec3 pos = playerChunkPos + glm::ivec3(x, 0, z);
-            auto it = m_Chunks.find(pos);
-            if (it == m_Chunks.end())
-                continue;
-
-            Chunk *ch = it->second.get();
-            if (ch->getState() == Chunk::State::INITIAL)
-                continue;
-
-            float dist = glm::distance(glm::vec2(x, z), glm::vec2(0.f));
-            int reqLod = (!m_Settings.lodDistances.empty() && dist <= m_Settings.lodDistances[0]) ? 0 : 1;
-
-            bool is_dirty = ch->m_is_dirty.load(std::memory_order_acquire);
-            bool blas_is_dirty = ch->m_blas_dirty.load(std::memory_order_acquire);
-
-            if (!ch->hasLOD(reqLod) || is_dirty)
-            {
-                pending.emplace_back(pos, reqLod);
-
-                if (ch->hasLOD(reqLod))
-                {
-                    ch->m_blas_dirty.store(true, std::memory_order_release);
-                }
-            }
-
-            if (is_dirty && !ch->hasLOD(1 - reqLod))
-            {
-                pending.emplace_back(pos, 1 - reqLod);
-            }
-        }
-    }
-
-    std::lock_guard lock(m_MeshJobsMutex);
-    for (auto &job : pending)
-    {
-        if (!m_MeshJobsInProgress.count(job) && !m_MeshJobsToCreate.count(job))
-        {
-            m_MeshJobsToCreate.insert(job);
-
-            auto it = m_Chunks.find(job.first);
-            if (it != m_Chunks.end())
-            {
-                it->second->m_is_dirty.store(false, std::memory_order_release);
-            }
-        }
-    }
+    m_Renderer.getDebugOverlay()->setSection("Pipeline", m_World.getPipelineStats().toLines());
 }
 
-void Engine::submitMeshJobs()
+void Engine::updateFrameArenaStats()
 {
-    int dynCap;
-    if (m_FrameEMA < 0.0036f)
-        dynCap = m_Settings.maxMeshJobsBurst;
-    else if (m_FrameEMA < 0.0042f)
-        dynCap = m_Settings.maxMeshJobsInFlight + 2;
-    else
-        dynCap = m_Settings.maxMeshJobsInFlight;
-
-    std::scoped_lock lock(m_MeshJobsMutex);
-    if (m_MeshJobsToCreate.empty() || static_cast<int>(m_MeshJobsInProgress.size()) >= dynCap)
-    {
-        return;
-    }
-
-    glm::vec3 player_pos = m_player_ptr->get_position();
-    glm::vec2 player_chunk_pos_2d(
-        floor(player_pos.x / Chunk::WIDTH),
-        floor(player_pos.z / Chunk::DEPTH));
-
-    std::vector<std::pair<glm::ivec3, int>> sorted_jobs;
-    sorted_jobs.assign(m_MeshJobsToCreate.begin(), m_MeshJobsToCreate.end());
-
-    std::sort(sorted_jobs.begin(), sorted_jobs.end(),
-              [&](const auto &a, const auto &b)
-              {
-                  if (a.second != b.second)
-                  {
-                      return a.second < b.second;
-                  }
-
-                  float dist_a = glm::distance2(glm::vec2(a.first.x, a.first.z), player_chunk_pos_2d);
-                  float dist_b = glm::distance2(glm::vec2(b.first.x, b.first.z), player_chunk_pos_2d);
-                  return dist_a < dist_b;
-              });
-
-    int slots_to_fill = dynCap - static_cast<int>(m_MeshJobsInProgress.size());
-    for (int i = 0; i < slots_to_fill && i < sorted_jobs.size(); ++i)
-    {
-        auto &job = sorted_jobs[i];
-
-        m_MeshJobsToCreate.erase(job);
-        m_MeshJobsInProgress.insert(job);
-
-        auto it = m_Chunks.find(job.first);
-        if (it == m_Chunks.end())
-        {
-            m_MeshJobsInProgress.erase(job);
-            continue;
-        }
-
-        ChunkMeshInput in;
-        in.selfChunk = it->second;
-        glm::ivec3 p = it->second->getPos();
-
-        glm::ivec3 off[8] = {{p.x - 1, 0, p.z}, {p.x + 1, 0, p.z}, {p.x, 0, p.z - 1}, {p.x, 0, p.z + 1}, {p.x - 1, 0, p.z - 1}, {p.x + 1, 0, p.z - 1}, {p.x - 1, 0, p.z + 1}, {p.x + 1, 0, p.z + 1}};
-        for (int j = 0; j < 8; ++j)
-        {
-            auto n = m_Chunks.find(off[j]);
-            if (n != m_Chunks.end() && n->second->getState() >= Chunk::State::TERRAIN_READY)
-                in.neighborChunks[j] = n->second;
-        }
-
-        m_Pool.submit(
-            [this, job, in = std::move(in)](std::stop_token st) mutable
-            {
-                if (st.stop_requested())
-                {
-                    std::lock_guard lk(m_MeshJobsMutex);
-                    m_MeshJobsInProgress.erase(job);
-                    return;
-                }
-                in.selfChunk->buildAndStageMesh(m_Renderer.getAllocator(), *m_Renderer.getArena(), job.second, in);
-                std::lock_guard lk(m_MeshJobsMutex);
-                m_MeshJobsInProgress.erase(job);
-            });
-    }
+    const FrameArena::Stats &st = m_Renderer.getFrameArenaStats();
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "%.1f / %.0f KB  Allocations: %u  Heap fallbacks: %u",
+                  st.usedBytes / 1024.0, st.capacityBytes / 1024.0, st.allocations, st.heapAllocations);
+    m_Renderer.getDebugOverlay()->setSection("Frame arena", {buf});
 }
-
-void Engine::uploadReadyMeshes()
-{
-    int uploaded = 0;
-    for (auto &[pos, ch] : m_Chunks)
-    {
-        if (uploaded >= m_Settings.chunksToUploadPerFrame)
-            break;
-        if (ch->getState() != Chunk::State::STAGING_READY)
-            continue;
-
-        bool did_upload = false;
-        if (ch->uploadMesh(m_Renderer, 0))
-            did_upload = true;
-        if (ch->uploadMesh(m_Renderer, 1))
-            did_upload = true;
-        if (ch->uploadTransparentMesh(m_Renderer, 0))
-            did_upload = true;
-        if (ch->uploadTransparentMesh(m_Renderer, 1))
-            did_upload = true;
-
-        if (did_upload)
-        {
-            uploaded++;
-        }
-    }
-}
\ No newline at end of file
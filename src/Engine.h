@@ -2,35 +2,15 @@
 #include "Window.h"
 #include "VulkanRenderer.h"
 #include "Settings.h"
-#include "Chunk.h"
-#include <map>
+#include "World.h"
 #include <memory>
+#include <memory_resource>
 #include <glm/glm.hpp>
-#include "math/Ivec3Less.h"
-#include "generation/TerrainGenerator.h"
-#include "ThreadPool.h"
-#include <set>
-#include <mutex>
-#include <utility>
 #include "Entity.h"
 #include "Player.h"
 #include "DebugController.h"
 #include <optional>
 
-struct ChunkLodRequestLess
-{
-    bool operator()(const std::pair<glm::ivec3, int> &a, const std::pair<glm::ivec3, int> &b) const
-    {
-        if (a.second != b.second)
-            return a.second < b.second;
-        if (a.first.x != b.first.x)
-            return a.first.x < b.first.x;
-        if (a.first.y != b.first.y)
-            return a.first.y < b.first.y;
-        return a.first.z < b.first.z;
-    }
-};
-
 class Engine
 {
 public:
@@ -42,27 +22,18 @@ public:
     Engine &operator=(const Engine &) = delete;
     void run();
 
-    Block get_block(int x, int y, int z);
-    void set_block(int x, int y, int z, BlockId id);
-
     Window &get_window() { return m_Window; }
     Settings &getSettings() { return m_Settings; }
     void advanceTime(int32_t ticks);
 
-    void generateBlockOutline(const glm::ivec3 &pos, std::vector<glm::vec3> &vertices);
+    void generateBlockOutline(const glm::ivec3 &pos, std::pmr::vector<glm::vec3> &vertices);
 
 private:
     void processInput(float dt, bool &mouse_enabled, double &lx, double &ly);
     void updateWindowTitle(float now, float &fpsTime, int &frames, const glm::vec3 &player_pos);
-    void updateChunks(const glm::vec3 &cameraPos);
-
-    void unloadDistantChunks(const glm::ivec3 &playerChunkPos);
-    void processGarbage();
-    void loadVisibleChunks(const glm::ivec3 &playerChunkPos);
-    void createMeshJobs(const glm::ivec3 &playerChunkPos);
-    void submitMeshJobs();
-    void uploadReadyMeshes();
-    void createChunkContainer(const glm::ivec3 &pos);
+    void updateSaveStats();
+    void updatePipelineStats();
+    void updateFrameArenaStats();
 
     Settings m_Settings{};
     Window m_Window;
@@ -79,19 +50,9 @@ private:
     std::vector<std::unique_ptr<Entity>> m_entities;
     Player *m_player_ptr = nullptr;
 
-    TerrainGenerator m_TerrainGen;
+    World m_World;
     std::optional<glm::ivec3> m_hoveredBlockPos;
 
     double m_FrameEMA = 0.004;
-
-    mutable std::mutex m_MeshJobsMutex;
-    std::set<std::pair<glm::ivec3, int>, ChunkLodRequestLess> m_MeshJobsToCreate;
-    std::set<std::pair<glm::ivec3, int>, ChunkLodRequestLess> m_MeshJobsInProgress;
-
-    std::map<glm::ivec3, std::shared_ptr<Chunk>, ivec3_less> m_Chunks;
-    std::vector<std::shared_ptr<Chunk>> m_Garbage;
-    ThreadPool m_Pool;
-
-    std::set<glm::ivec3, ivec3_less> m_ChunksToGenerate;
-    std::mutex m_ChunkGenerationQueueMtx;
+    double m_FrameWorkEMA = 0.004;
 };
\ No newline at end of file
@@ -1,10 +1,10 @@
 #include "Entity.h"
-#include "Engine.h"
+#include "World.h"
 #include "Block.h"
 #include <cmath>
 
-Entity::Entity(Engine *engine, glm::vec3 position)
-    : m_engine(engine),
+Entity::Entity(World *world, glm::vec3 position)
+    : m_world(world),
       m_position(position),
       m_previousPosition(position)
 {
@@ -14,6 +14,14 @@ Entity::Entity(Engine *engine, glm::vec3 position)
     m_hitbox.max = {width / 2.0f, height, width / 2.0f};
 }
 
+void Entity::teleport(const glm::vec3 &position)
+{
+    m_position = position;
+    m_previousPosition = position;
+    m_velocity = glm::vec3(0.f);
+    m_is_on_ground = false;
+}
+
 void Entity::check_for_water()
 {
     m_is_in_water = false;
@@ -32,7 +40,7 @@ void Entity::check_for_water()
         {
             for (int bz = min_bz; bz < max_bz; ++bz)
             {
-                Block block = m_engine->get_block(bx, by, bz);
+                Block block = m_world->get_block(bx, by, bz);
                 if (block.id == BlockId::WATER)
                 {
 
@@ -103,7 +111,7 @@ void Entity::resolve_collisions()
         {
             for (int bz = min_bz; bz < max_bz; ++bz)
             {
-                Block block = m_engine->get_block(bx, by, bz);
+                Block block = m_world->get_block(bx, by, bz);
                 if (!BlockDatabase::get().get_block_data(block.id).is_solid)
                 {
                     continue;
@@ -3,7 +3,7 @@
 #include <glm/glm.hpp>
 #include "math/AABB.h"
 
-class Engine;
+class World;
 struct Block;
 class BlockDatabase;
 
@@ -12,9 +12,10 @@ class Entity
 public:
     virtual ~Entity() = default;
 
-    Entity(Engine *engine, glm::vec3 position);
+    Entity(World *world, glm::vec3 position);
 
     virtual void update(float dt);
+    void teleport(const glm::vec3 &position);
 
     glm::vec3 get_position() const { return m_position; }
 
@@ -28,7 +29,7 @@ protected:
     void resolve_collisions();
     void check_for_water();
 
-    Engine *m_engine;
+    World *m_world;
 
     glm::vec3 m_position;
 
@@ -0,0 +1,58 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <new>
+
+FrameArena::FrameArena(size_t initialBytes)
+    : m_Buffer(new std::byte[initialBytes]), m_Capacity(initialBytes)
+{
+    m_Current.capacityBytes = m_Capacity;
+}
+
+FrameArena::~FrameArena()
+{
+    releaseOverflow();
+}
+
+void FrameArena::reset()
+{
+    m_LastFrame = m_Current;
+    releaseOverflow();
+
+    if (m_LastFrame.heapAllocations > 0)
+    {
+        m_Capacity = std::max(m_Capacity * 2, m_Requested + m_Requested / 2);
+        m_Buffer.reset(new std::byte[m_Capacity]);
+    }
+
+    m_Offset = 0;
+    m_Requested = 0;
+    m_Current = Stats{};
+    m_Current.capacityBytes = m_Capacity;
+}
+
+void *FrameArena::do_allocate(size_t bytes, size_t alignment)
+{
+    ++m_Current.allocations;
+    m_Requested += bytes + alignment;
+
+    void *p = m_Buffer.get() + m_Offset;
+    size_t space = m_Capacity - m_Offset;
+    if (std::align(alignment, bytes, p, space))
+    {
+        m_Offset = m_Capacity - space + bytes;
+        m_Current.usedBytes = m_Offset;
+        return p;
+    }
+
+    ++m_Current.heapAllocations;
+    void *heap = ::operator new(bytes, std::align_val_t(alignment));
+    m_Overflow.push_back({heap, bytes, alignment});
+    return heap;
+}
+
+void FrameArena::releaseOverflow()
+{
+    for (const Overflow &o : m_Overflow)
+        ::operator delete(o.ptr, o.bytes, std::align_val_t(o.alignment));
+    m_Overflow.clear();
+}
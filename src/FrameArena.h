@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Bump allocator for data that lives for a single frame. Deallocation is a no-op; reset()
+// rewinds the whole arena at the start of the next use. Requests that do not fit fall
+// back to the heap and are counted, and the next reset() grows the buffer to the peak so
+// a steady-state frame makes no heap allocations at all.
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    struct Stats
+    {
+        size_t capacityBytes = 0;
+        size_t usedBytes = 0;
+        uint32_t allocations = 0;
+        uint32_t heapAllocations = 0;
+    };
+
+    explicit FrameArena(size_t initialBytes = 64 * 1024);
+    ~FrameArena() override;
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void reset();
+
+    // Totals of the frame before the last reset().
+    const Stats &getLastFrameStats() const { return m_LastFrame; }
+
+private:
+    struct Overflow
+    {
+        void *ptr;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    void releaseOverflow();
+
+    std::unique_ptr<std::byte[]> m_Buffer;
+    size_t m_Capacity;
+    size_t m_Offset = 0;
+    size_t m_Requested = 0;
+    std::vector<Overflow> m_Overflow;
+    Stats m_Current;
+    Stats m_LastFrame;
+};
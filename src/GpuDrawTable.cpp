@@ -0,0 +1,205 @@
+#include "GpuDrawTable.h"
+#include "DrawKey.h"
+#include "Profiler.h"
+#include <algorithm>
+
+GpuDrawTable::GpuDrawTable(const Settings &settings)
+    : m_Settings(settings)
+{
+}
+
+bool GpuDrawTable::update(const ChunkMap &chunks, uint64_t chunkSetVersion, uint64_t cullDataVersion,
+                          const glm::ivec3 &playerChunkPos)
+{
+    if (chunkSetVersion == m_ChunkSetVersion && cullDataVersion == m_CullDataVersion && playerChunkPos == m_PlayerChunkPos)
+        return false;
+
+    VC_PROFILE_ZONE("GpuDrawTable::update");
+    const bool resort = chunkSetVersion != m_ChunkSetVersion || playerChunkPos != m_PlayerChunkPos;
+    m_ChunkSetVersion = chunkSetVersion;
+    m_CullDataVersion = cullDataVersion;
+    m_PlayerChunkPos = playerChunkPos;
+
+    if (resort)
+    {
+        rebuild(chunks, playerChunkPos);
+        ++m_Version;
+        return true;
+    }
+
+    bool changed = false;
+    bool relayout = false;
+    for (size_t i = 0; i < m_Entries.size(); ++i)
+    {
+        Entry &e = m_Entries[i];
+        if (e.chunk->getCullDataRevision() == e.revision)
+            continue;
+
+        const uint8_t opaqueCount = e.opaqueCount;
+        const uint8_t transparentCount = e.transparentCount;
+        refresh(i);
+        changed = true;
+        if (e.opaqueCount != opaqueCount || e.transparentCount != transparentCount)
+            relayout = true;
+        if (relayout)
+            continue;
+
+        const GpuChunkDraw *src = &m_EntryDraws[i * DRAWS_PER_CHUNK];
+        std::copy(src, src + e.opaqueCount, m_Draws.begin() + e.opaqueFirst);
+        std::copy(src + SectionGraph::FACE_COUNT, src + SectionGraph::FACE_COUNT + e.transparentCount,
+                  m_Draws.begin() + e.transparentFirst);
+    }
+    if (!changed)
+        return false;
+
+    if (relayout)
+        layout();
+    buildLists();
+    ++m_Version;
+    return true;
+}
+
+void GpuDrawTable::rebuild(const ChunkMap &chunks, const glm::ivec3 &playerChunkPos)
+{
+    // Same LOD choice as ChunkCuller, so both paths draw the same meshes.
+    const float lod0Distance = m_Settings.lodDistances.empty() ? -1.f : static_cast<float>(m_Settings.lodDistances[0]);
+    const glm::vec2 playerColumn(playerChunkPos.x, playerChunkPos.z);
+
+    // Chunks still waiting for a mesh get an entry too, so their first upload is a patch.
+    std::vector<Entry> entries;
+    entries.reserve(chunks.size());
+    for (const auto &[pos, ch] : chunks)
+    {
+        if (ch->m_OriginSlot == Chunk::NO_ORIGIN_SLOT)
+            continue;
+        const float distance = glm::distance(glm::vec2(pos.x, pos.z), playerColumn);
+        entries.push_back({ch.get(), distance * distance, distance <= lod0Distance ? 0 : 1});
+    }
+
+    // Opaque draws go front to back for early depth rejection where the commands keep their
+    // order; transparent ones walk the same order backwards for blending.
+    {
+        VC_PROFILE_ZONE("Sort draw keys");
+        m_Keys.clear();
+        for (uint32_t i = 0; i < entries.size(); ++i)
+            m_Keys.push_back(DrawKey::make(DrawKey::MAIN_PIPELINE, entries[i].distanceSq, DrawKey::Order::FRONT_TO_BACK, i));
+        DrawKey::sort(m_Keys, m_SortScratch);
+    }
+
+    m_Entries.clear();
+    m_Entries.reserve(entries.size());
+    for (uint64_t key : m_Keys)
+        m_Entries.push_back(entries[DrawKey::mesh(key)]);
+
+    m_EntryDraws.resize(m_Entries.size() * DRAWS_PER_CHUNK);
+    for (size_t i = 0; i < m_Entries.size(); ++i)
+        refresh(i);
+    layout();
+    buildLists();
+}
+
+void GpuDrawTable::refresh(size_t index)
+{
+    Entry &e = m_Entries[index];
+    Chunk &ch = *e.chunk;
+    // Read before the meshes, so a change made while reading shows up on the next update.
+    e.revision = ch.getCullDataRevision();
+    e.lod = ch.getBestAvailableLOD(e.requiredLod);
+    e.opaqueCount = 0;
+    e.transparentCount = 0;
+    e.hasOpaque = false;
+    e.opaqueUnpooled = false;
+    e.transparentUnpooled = false;
+    if (e.lod == -1)
+        return;
+
+    // Chunks whose bounds are not known yet are culled as the whole column.
+    const glm::vec3 origin = ch.getAABB().min;
+    const MeshBounds meshBounds = ch.getMeshBounds();
+    const AABB bounds = meshBounds.empty() ? ch.getAABB() : meshBounds.toAABB(origin);
+    const glm::vec4 boundsMin(bounds.min, 1.f), boundsMax(bounds.max, 1.f);
+    GpuChunkDraw *dst = &m_EntryDraws[index * DRAWS_PER_CHUNK];
+
+    const ChunkMesh *opaqueMesh = ch.getMesh(e.lod);
+    if (opaqueMesh && opaqueMesh->indexCount > 0 && opaqueMesh->gpu)
+    {
+        e.hasOpaque = true;
+        const GpuMesh &gpu = *opaqueMesh->gpu;
+        const MeshFaceRanges &faces = opaqueMesh->faces;
+        if (!gpu.pooled)
+            e.opaqueUnpooled = true;
+        else if (faces.empty())
+            dst[e.opaqueCount++] = {boundsMin, boundsMax, glm::vec4(0.f, 0.f, 0.f, 1.f),
+                                    opaqueMesh->indexCount, gpu.firstIndex, gpu.vertexOffset, ch.m_OriginSlot};
+        else
+        {
+            for (int f = 0; f < SectionGraph::FACE_COUNT; ++f)
+            {
+                const MeshFaceRanges::Range &range = faces.ranges[f];
+                if (range.indexCount == 0)
+                    continue;
+                // Faces of a POS_ direction face a camera beyond their plane, NEG_ ones one before it.
+                const int axis = f / 2;
+                const float sign = (f & 1) ? 1.f : -1.f;
+                glm::vec4 plane(0.f);
+                plane[axis] = sign;
+                plane.w = -sign * (origin[axis] + static_cast<float>(range.plane));
+                dst[e.opaqueCount++] = {boundsMin, boundsMax, plane, range.indexCount,
+                                        gpu.firstIndex + range.firstIndex, gpu.vertexOffset, ch.m_OriginSlot};
+            }
+        }
+    }
+
+    const ChunkMesh *transparentMesh = ch.getTransparentMesh(e.lod);
+    if (transparentMesh && transparentMesh->indexCount > 0 && transparentMesh->gpu)
+    {
+        const GpuMesh &gpu = *transparentMesh->gpu;
+        if (!gpu.pooled)
+            e.transparentUnpooled = true;
+        else
+        {
+            dst[SectionGraph::FACE_COUNT] = {boundsMin, boundsMax, glm::vec4(0.f, 0.f, 0.f, 1.f),
+                                             transparentMesh->indexCount, gpu.firstIndex, gpu.vertexOffset, ch.m_OriginSlot};
+            e.transparentCount = 1;
+        }
+    }
+}
+
+void GpuDrawTable::layout()
+{
+    VC_PROFILE_ZONE("Lay out draw table");
+    m_Draws.clear();
+    for (size_t i = 0; i < m_Entries.size(); ++i)
+    {
+        Entry &e = m_Entries[i];
+        e.opaqueFirst = static_cast<uint32_t>(m_Draws.size());
+        const GpuChunkDraw *src = &m_EntryDraws[i * DRAWS_PER_CHUNK];
+        m_Draws.insert(m_Draws.end(), src, src + e.opaqueCount);
+    }
+    m_OpaqueDrawCount = static_cast<uint32_t>(m_Draws.size());
+
+    for (size_t i = m_Entries.size(); i-- > 0;)
+    {
+        Entry &e = m_Entries[i];
+        e.transparentFirst = static_cast<uint32_t>(m_Draws.size());
+        const GpuChunkDraw *src = &m_EntryDraws[i * DRAWS_PER_CHUNK + SectionGraph::FACE_COUNT];
+        m_Draws.insert(m_Draws.end(), src, src + e.transparentCount);
+    }
+}
+
+void GpuDrawTable::buildLists()
+{
+    m_UnpooledOpaque.clear();
+    m_UnpooledTransparent.clear();
+    m_OpaqueChunks.clear();
+    for (const Entry &e : m_Entries)
+    {
+        if (e.hasOpaque)
+            m_OpaqueChunks.emplace_back(e.chunk, e.lod);
+        if (e.opaqueUnpooled)
+            m_UnpooledOpaque.emplace_back(e.chunk, e.lod);
+    }
+    for (auto it = m_Entries.rbegin(); it != m_Entries.rend(); ++it)
+        if (it->transparentUnpooled)
+            m_UnpooledTransparent.emplace_back(it->chunk, it->lod);
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "Chunk.h"
+#include "Settings.h"
+#include "math/AABB.h"
+#include "math/Ivec3Less.h"
+#include <glm/glm.hpp>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// One entry of the GPU culling pass's input, laid out as std430 for chunk_cull.comp.
+// instance is the chunk's origin slot and becomes the draw's firstInstance. The draw is only
+// made while the camera is on the positive side of facePlane, the plane it must cross to see
+// any of the draw's faces; draws with faces of every direction use (0, 0, 0, 1).
+struct GpuChunkDraw
+{
+    glm::vec4 boundsMin;
+    glm::vec4 boundsMax;
+    glm::vec4 facePlane;
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t instance;
+};
+static_assert(sizeof(GpuChunkDraw) == 64, "GpuChunkDraw must match the std430 layout in chunk_cull.comp");
+
+// Every resident chunk mesh to draw, for culling on the GPU. Draws hold pooled meshes, opaque
+// ones first sorted front to back from the player's chunk and transparent ones after them sorted
+// back to front. An opaque mesh with face ranges gets one draw per face direction. Meshes the
+// backend could not pool are listed separately for direct drawing. Chunks without an origin slot
+// are left out.
+//
+// The table keeps an entry per chunk. Only a change of the chunk set or the player's chunk
+// re-sorts it; otherwise update() rereads just the chunks whose cull data revision moved and
+// rewrites their draws in place, relaying the draws out only if a chunk's draw count changed.
+// A frame that changes nothing costs one revision check per chunk.
+class GpuDrawTable
+{
+public:
+    using ChunkMap = std::map<glm::ivec3, std::shared_ptr<Chunk>, ivec3_less>;
+    using DrawList = std::pmr::vector<std::pair<Chunk *, int>>;
+
+    explicit GpuDrawTable(const Settings &settings);
+
+    // Returns true if the table changed. The version arguments are those ChunkCuller::cull takes.
+    bool update(const ChunkMap &chunks, uint64_t chunkSetVersion, uint64_t cullDataVersion,
+                const glm::ivec3 &playerChunkPos);
+
+    // Changes whenever the draws or draw lists do.
+    uint64_t getVersion() const { return m_Version; }
+
+    const std::vector<GpuChunkDraw> &getDraws() const { return m_Draws; }
+    uint32_t getOpaqueDrawCount() const { return m_OpaqueDrawCount; }
+    uint32_t getTransparentDrawCount() const { return static_cast<uint32_t>(m_Draws.size()) - m_OpaqueDrawCount; }
+
+    const DrawList &getUnpooledOpaque() const { return m_UnpooledOpaque; }
+    const DrawList &getUnpooledTransparent() const { return m_UnpooledTransparent; }
+
+    // Every opaque mesh in the table, pooled or not, for the ray tracing structures.
+    const DrawList &getOpaqueChunks() const { return m_OpaqueChunks; }
+
+private:
+    // Room for an opaque mesh's six face draws and the transparent draw.
+    static constexpr uint32_t DRAWS_PER_CHUNK = SectionGraph::FACE_COUNT + 1;
+
+    struct Entry
+    {
+        Chunk *chunk;
+        float distanceSq;
+        int requiredLod;
+        uint32_t revision = 0;
+        int lod = -1;
+        // Where the chunk's draws sit in m_Draws.
+        uint32_t opaqueFirst = 0;
+        uint32_t transparentFirst = 0;
+        uint8_t opaqueCount = 0;
+        uint8_t transparentCount = 0;
+        bool hasOpaque = false;
+        bool opaqueUnpooled = false;
+        bool transparentUnpooled = false;
+    };
+
+    void rebuild(const ChunkMap &chunks, const glm::ivec3 &playerChunkPos);
+    // Rereads the chunk into its entry and its slots of m_EntryDraws.
+    void refresh(size_t index);
+    void layout();
+    void buildLists();
+
+    const Settings &m_Settings;
+
+    // Sorted front to back; entry i's draws are staged at m_EntryDraws[i * DRAWS_PER_CHUNK].
+    std::vector<Entry> m_Entries;
+    std::vector<GpuChunkDraw> m_EntryDraws;
+
+    std::vector<GpuChunkDraw> m_Draws;
+    uint32_t m_OpaqueDrawCount = 0;
+    DrawList m_UnpooledOpaque;
+    DrawList m_UnpooledTransparent;
+    DrawList m_OpaqueChunks;
+    std::vector<uint64_t> m_Keys;
+    std::vector<uint64_t> m_SortScratch;
+
+    uint64_t m_Version = 0;
+    uint64_t m_ChunkSetVersion = ~0ull;
+    uint64_t m_CullDataVersion = ~0ull;
+    glm::ivec3 m_PlayerChunkPos{0};
+};
@@ -0,0 +1,130 @@
+#include "NullRenderBackend.h"
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+    constexpr uint64_t STAGING_ALIGN = 256;
+
+    struct NullGpuMesh : GpuMesh
+    {
+        std::chrono::steady_clock::time_point readyAt;
+    };
+}
+
+NullRenderBackend::NullRenderBackend(uint64_t stagingBytes, std::chrono::microseconds uploadLatency)
+    : m_Staging(stagingBytes), m_UploadLatency(uploadLatency)
+{
+}
+
+void NullRenderBackend::retireCompletedRegions(Clock::time_point now)
+{
+    while (!m_InFlight.empty() && m_InFlight.front().readyAt <= now)
+    {
+        m_InFlightBytes -= m_InFlight.front().end - m_InFlight.front().begin;
+        m_InFlight.pop_front();
+    }
+}
+
+bool NullRenderBackend::regionBusy(uint64_t begin, uint64_t end) const
+{
+    for (auto &r : m_InFlight)
+        if (!(end <= r.begin || begin >= r.end))
+            return true;
+    return false;
+}
+
+bool NullRenderBackend::alloc(uint64_t size, uint64_t &offset)
+{
+    size = (size + STAGING_ALIGN - 1) & ~(STAGING_ALIGN - 1);
+    if (size > m_Staging.size())
+        return false;
+
+    while (true)
+    {
+        retireCompletedRegions(Clock::now());
+
+        if (m_Head + size > m_Staging.size())
+            m_Head = 0;
+
+        if (!regionBusy(m_Head, m_Head + size))
+        {
+            offset = m_Head;
+            m_Head += size;
+            return true;
+        }
+
+        if (m_InFlight.empty())
+            return false;
+
+        ++m_Stats.stagingWaits;
+        std::this_thread::sleep_until(m_InFlight.front().readyAt);
+    }
+}
+
+uint8_t *NullRenderBackend::reserveStaging(uint64_t vertexBytes, uint64_t indexBytes, StagedMesh &out)
+{
+    if (vertexBytes == 0 || indexBytes == 0)
+        return nullptr;
+
+    std::scoped_lock lock(m_Mtx);
+    uint64_t vertexOffset, indexOffset;
+    if (!alloc(vertexBytes, vertexOffset) || !alloc(indexBytes, indexOffset))
+    {
+        ++m_Stats.stagingFailures;
+        return nullptr;
+    }
+
+    out.vertexOffset = vertexOffset;
+    out.vertexBytes = vertexBytes;
+    out.indexOffset = indexOffset;
+    out.indexBytes = indexBytes;
+    return m_Staging.data();
+}
+
+std::unique_ptr<GpuMesh> NullRenderBackend::uploadMesh(const StagedMesh &staged)
+{
+    auto mesh = std::make_unique<NullGpuMesh>();
+    mesh->readyAt = Clock::now() + m_UploadLatency;
+
+    std::scoped_lock lock(m_Mtx);
+    m_InFlight.push_back({staged.vertexOffset, staged.vertexOffset + staged.vertexBytes, mesh->readyAt});
+    m_InFlight.push_back({staged.indexOffset, staged.indexOffset + staged.indexBytes, mesh->readyAt});
+    m_InFlightBytes += staged.vertexBytes + staged.indexBytes;
+    m_PeakInFlightBytes = std::max(m_PeakInFlightBytes, m_InFlightBytes);
+    ++m_Stats.uploads;
+    m_Stats.uploadedBytes += staged.vertexBytes + staged.indexBytes;
+    return mesh;
+}
+
+bool NullRenderBackend::isUploadComplete(GpuMesh &mesh)
+{
+    return static_cast<NullGpuMesh &>(mesh).readyAt <= Clock::now();
+}
+
+void NullRenderBackend::retireMesh(std::unique_ptr<GpuMesh>)
+{
+}
+
+void NullRenderBackend::scheduleChunkGpuCleanup(std::shared_ptr<Chunk>)
+{
+}
+
+StagingStats NullRenderBackend::getStagingStats()
+{
+    std::scoped_lock lock(m_Mtx);
+    retireCompletedRegions(Clock::now());
+
+    StagingStats s;
+    s.capacityBytes = m_Staging.size();
+    s.inFlightBytes = m_InFlightBytes;
+    s.peakInFlightBytes = m_PeakInFlightBytes;
+    s.rejectedAllocations = m_Stats.stagingFailures;
+    return s;
+}
+
+NullRenderBackend::Stats NullRenderBackend::getStats() const
+{
+    std::scoped_lock lock(m_Mtx);
+    return m_Stats;
+}
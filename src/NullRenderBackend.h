@@ -0,0 +1,56 @@
+#pragma once
+#include "RenderBackend.h"
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Headless stand-in for VulkanRenderer: keeps the staging ring in host memory and
+// reports an upload as finished once the configured latency has passed.
+class NullRenderBackend : public RenderBackend
+{
+public:
+    struct Stats
+    {
+        uint64_t uploads = 0;
+        uint64_t uploadedBytes = 0;
+        uint64_t stagingWaits = 0;
+        uint64_t stagingFailures = 0;
+    };
+
+    explicit NullRenderBackend(uint64_t stagingBytes = 64ull * 1024 * 1024,
+                               std::chrono::microseconds uploadLatency = std::chrono::microseconds(1500));
+
+    uint8_t *reserveStaging(uint64_t vertexBytes, uint64_t indexBytes, StagedMesh &out) override;
+    std::unique_ptr<GpuMesh> uploadMesh(const StagedMesh &staged) override;
+    bool isUploadComplete(GpuMesh &mesh) override;
+    void retireMesh(std::unique_ptr<GpuMesh> mesh) override;
+    void scheduleChunkGpuCleanup(std::shared_ptr<Chunk> chunk) override;
+    StagingStats getStagingStats() override;
+
+    Stats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct InFlightRegion
+    {
+        uint64_t begin;
+        uint64_t end;
+        Clock::time_point readyAt;
+    };
+
+    bool alloc(uint64_t size, uint64_t &offset);
+    void retireCompletedRegions(Clock::time_point now);
+    bool regionBusy(uint64_t begin, uint64_t end) const;
+
+    std::vector<uint8_t> m_Staging;
+    uint64_t m_Head = 0;
+    std::chrono::microseconds m_UploadLatency;
+
+    mutable std::mutex m_Mtx;
+    std::deque<InFlightRegion> m_InFlight;
+    uint64_t m_InFlightBytes = 0;
+    uint64_t m_PeakInFlightBytes = 0;
+    Stats m_Stats;
+};
@@ -0,0 +1,233 @@
+#include "OcclusionBuffer.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define VC_OCCLUSION_SIMD 1
+#endif
+
+namespace
+{
+    constexpr int LANES = 4;
+    // Occluder sides closer than this are clipped away.
+    constexpr float NEAR_W = 0.1f;
+    // Relative 1/w margin so a surface lying on an occluder face does not hide itself.
+    constexpr float DEPTH_BIAS = 1e-3f;
+    // Extra pixels an occluder's outline is shrunk by against rounding.
+    constexpr float COVER_SLACK = 1e-3f;
+}
+
+void OcclusionBuffer::begin(const glm::mat4 &viewProj, const glm::vec3 &cameraPos, int width, int height)
+{
+    m_ViewProj = viewProj;
+    m_CameraPos = cameraPos;
+    m_Width = (std::max(width, 1) + LANES - 1) / LANES * LANES;
+    m_Height = std::max(height, 1);
+    m_Depth.assign(static_cast<size_t>(m_Width) * m_Height, 0.f);
+    m_Occluders.clear();
+}
+
+glm::vec3 OcclusionBuffer::toScreen(const glm::vec4 &clip) const
+{
+    const float invW = 1.f / clip.w;
+    return {(clip.x * invW * 0.5f + 0.5f) * m_Width, (clip.y * invW * 0.5f + 0.5f) * m_Height, invW};
+}
+
+void OcclusionBuffer::addOccluder(const AABB &box)
+{
+    std::array<glm::vec2, MAX_OUTLINE> points;
+    int pointCount = 0;
+    float depth = FLT_MAX;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float plane;
+        if (m_CameraPos[axis] < box.min[axis])
+            plane = box.min[axis];
+        else if (m_CameraPos[axis] > box.max[axis])
+            plane = box.max[axis];
+        else
+            continue;
+
+        const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+        std::array<glm::vec4, 4> face;
+        for (int k = 0; k < 4; ++k)
+        {
+            glm::vec3 p;
+            p[axis] = plane;
+            p[u] = (k == 1 || k == 2) ? box.max[u] : box.min[u];
+            p[v] = (k >= 2) ? box.max[v] : box.min[v];
+            face[k] = m_ViewProj * glm::vec4(p, 1.f);
+        }
+
+        // Clip against the near plane; a quad gains at most one corner, so three sides fit.
+        auto emit = [&](const glm::vec4 &clip)
+        {
+            const glm::vec3 s = toScreen(clip);
+            points[pointCount++] = glm::vec2(s);
+            depth = std::min(depth, s.z);
+        };
+        for (int k = 0; k < 4; ++k)
+        {
+            const glm::vec4 &a = face[k], &b = face[(k + 1) % 4];
+            const float da = a.w - NEAR_W, db = b.w - NEAR_W;
+            if (da >= 0.f)
+                emit(a);
+            if ((da >= 0.f) != (db >= 0.f))
+                emit(a + (b - a) * (da / (da - db)));
+        }
+    }
+    if (pointCount < 3)
+        return;
+
+    // The camera-facing sides project onto a convex outline; Andrew's monotone chain finds it.
+    std::sort(points.begin(), points.begin() + pointCount, [](const glm::vec2 &a, const glm::vec2 &b)
+              { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+    auto turn = [](const glm::vec2 &o, const glm::vec2 &a, const glm::vec2 &b)
+    { return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x); };
+
+    std::array<glm::vec2, 2 * MAX_OUTLINE> hull;
+    int count = 0;
+    for (int i = 0; i < pointCount; ++i)
+    {
+        while (count >= 2 && turn(hull[count - 2], hull[count - 1], points[i]) <= 0.f)
+            --count;
+        hull[count++] = points[i];
+    }
+    for (int i = pointCount - 2, lower = count + 1; i >= 0; --i)
+    {
+        while (count >= lower && turn(hull[count - 2], hull[count - 1], points[i]) <= 0.f)
+            --count;
+        hull[count++] = points[i];
+    }
+    --count;
+    if (count < 3)
+        return;
+
+    Occluder o;
+    o.count = count;
+    o.depth = depth;
+    o.minY = FLT_MAX;
+    o.maxY = -FLT_MAX;
+    float minX = FLT_MAX, maxX = -FLT_MAX;
+    for (int k = 0; k < count; ++k)
+    {
+        o.outline[k] = hull[k];
+        o.minY = std::min(o.minY, hull[k].y);
+        o.maxY = std::max(o.maxY, hull[k].y);
+        minX = std::min(minX, hull[k].x);
+        maxX = std::max(maxX, hull[k].x);
+    }
+    // Anything narrower than a pixel, or off screen, covers no pixel completely.
+    if (maxX - minX < 1.f || o.maxY - o.minY < 1.f || maxX < 1.f || minX > m_Width - 1 || o.maxY < 1.f || o.minY > m_Height - 1)
+        return;
+    m_Occluders.push_back(o);
+}
+
+void OcclusionBuffer::rasterize(int rowBegin, int rowEnd)
+{
+    rowBegin = std::max(rowBegin, 0);
+    rowEnd = std::min(rowEnd, m_Height);
+
+    for (const Occluder &o : m_Occluders)
+    {
+        const int minY = std::max(rowBegin, static_cast<int>(std::ceil(std::max(o.minY, 0.f))));
+        const int maxY = std::min(rowEnd - 1, static_cast<int>(std::floor(std::min(o.maxY, static_cast<float>(m_Height)))) - 1);
+        if (minY > maxY)
+            continue;
+
+        // Edge k is a * (x - x_k) + b * (y - y_k) >= 0 inside, from outline corner k. Over a pixel
+        // it dips at most half of |a| + |b| below its value at the center, so the center must clear
+        // that plus some slack for rounding, which grows with how far off screen the corners are.
+        float extent = 0.f;
+        for (int k = 0; k < o.count; ++k)
+            extent = std::max({extent, std::abs(o.outline[k].x), std::abs(o.outline[k].y)});
+        const float slack = COVER_SLACK + extent * 1e-6f;
+
+        std::array<glm::vec4, MAX_OUTLINE> edges;
+        for (int k = 0; k < o.count; ++k)
+        {
+            const glm::vec2 &p0 = o.outline[k], &p1 = o.outline[(k + 1) % o.count];
+            const float a = p0.y - p1.y, b = p1.x - p0.x;
+            edges[k] = glm::vec4(p0, a, b);
+        }
+
+        const float firstX = 0.5f, lastX = m_Width - 0.5f;
+        for (int y = minY; y <= maxY; ++y)
+        {
+            const float py = y + 0.5f;
+            float lo = -FLT_MAX, hi = FLT_MAX;
+            for (int k = 0; k < o.count && lo <= hi; ++k)
+            {
+                const glm::vec4 &e = edges[k];
+                // The edge is a * (px - x_k) + g at pixel center px of this row.
+                const float g = e.w * (py - e.y) - (0.5f + slack) * (std::abs(e.z) + std::abs(e.w));
+                const float first = e.z * (firstX - e.x) + g, last = e.z * (lastX - e.x) + g;
+                if (first >= 0.f && last >= 0.f)
+                    continue;
+                if (first < 0.f && last < 0.f)
+                    lo = FLT_MAX;
+                else if (e.z > 0.f)
+                    lo = std::max(lo, e.x - g / e.z);
+                else
+                    hi = std::min(hi, e.x - g / e.z);
+            }
+            if (lo > hi)
+                continue;
+
+            const int x0 = static_cast<int>(std::clamp(std::ceil(lo - 0.5f), 0.f, static_cast<float>(m_Width)));
+            const int x1 = static_cast<int>(std::clamp(std::floor(hi - 0.5f), -1.f, static_cast<float>(m_Width - 1)));
+            float *row = &m_Depth[static_cast<size_t>(y) * m_Width];
+            int x = x0;
+#if defined(VC_OCCLUSION_SIMD)
+            const __m128 z = _mm_set1_ps(o.depth);
+            for (; x + LANES <= x1 + 1; x += LANES)
+                _mm_storeu_ps(row + x, _mm_max_ps(_mm_loadu_ps(row + x), z));
+#endif
+            for (; x <= x1; ++x)
+                row[x] = std::max(row[x], o.depth);
+        }
+    }
+}
+
+bool OcclusionBuffer::isOccluded(const AABB &box) const
+{
+    glm::vec2 lo(FLT_MAX), hi(-FLT_MAX);
+    float nearest = 0.f;
+    for (int k = 0; k < 8; ++k)
+    {
+        const glm::vec3 p((k & 1) ? box.max.x : box.min.x, (k & 2) ? box.max.y : box.min.y, (k & 4) ? box.max.z : box.min.z);
+        const glm::vec4 clip = m_ViewProj * glm::vec4(p, 1.f);
+        if (clip.w < NEAR_W)
+            return false;
+        const glm::vec3 s = toScreen(clip);
+        lo = glm::min(lo, glm::vec2(s));
+        hi = glm::max(hi, glm::vec2(s));
+        nearest = std::max(nearest, s.z);
+    }
+
+    const int x0 = std::max(0, static_cast<int>(std::floor(lo.x)));
+    const int x1 = std::min(m_Width - 1, static_cast<int>(std::floor(hi.x)));
+    const int y0 = std::max(0, static_cast<int>(std::floor(lo.y)));
+    const int y1 = std::min(m_Height - 1, static_cast<int>(std::floor(hi.y)));
+    if (x0 > x1 || y0 > y1)
+        return false;
+
+    const float threshold = nearest * (1.f + DEPTH_BIAS);
+    for (int y = y0; y <= y1; ++y)
+    {
+        const float *row = &m_Depth[static_cast<size_t>(y) * m_Width];
+        int x = x0;
+#if defined(VC_OCCLUSION_SIMD)
+        const __m128 limit = _mm_set1_ps(threshold);
+        for (; x + LANES <= x1 + 1; x += LANES)
+            if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(row + x), limit)))
+                return false;
+#endif
+        for (; x <= x1; ++x)
+            if (row[x] <= threshold)
+                return false;
+    }
+    return true;
+}
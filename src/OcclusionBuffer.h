@@ -0,0 +1,51 @@
+#pragma once
+#include "math/AABB.h"
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// Low-resolution software depth buffer for occlusion culling. Occluders are boxes known to be
+// solid: the outline of their camera-facing sides, clipped at the near plane, is rasterized at
+// the 1/w of its farthest corner, and only into pixels it covers completely, keeping the nearest
+// 1/w per pixel. A box is occluded when every pixel under its screen rectangle holds an occluder
+// nearer than the box's nearest corner, so nothing visible is ever reported occluded.
+class OcclusionBuffer
+{
+public:
+    // Width is rounded up to a multiple of the SIMD width.
+    void begin(const glm::mat4 &viewProj, const glm::vec3 &cameraPos, int width, int height);
+    void addOccluder(const AABB &box);
+    // Rasterizes every added occluder into rows [rowBegin, rowEnd). Disjoint bands may run in parallel.
+    void rasterize(int rowBegin, int rowEnd);
+    // Safe to call from several threads once rasterizing is done.
+    bool isOccluded(const AABB &box) const;
+
+    int getWidth() const { return m_Width; }
+    int getHeight() const { return m_Height; }
+    size_t getOccluderCount() const { return m_Occluders.size(); }
+    // Row-major 1/w of the nearest occluder, 0 where there is none.
+    const float *getDepth() const { return m_Depth.data(); }
+
+private:
+    static constexpr int MAX_OUTLINE = 16;
+
+    // Convex, counter-clockwise in screen space.
+    struct Occluder
+    {
+        std::array<glm::vec2, MAX_OUTLINE> outline;
+        int count = 0;
+        float depth = 0.f;
+        float minY = 0.f;
+        float maxY = 0.f;
+    };
+
+    glm::vec3 toScreen(const glm::vec4 &clip) const;
+
+    glm::mat4 m_ViewProj{1.f};
+    glm::vec3 m_CameraPos{0.f};
+    int m_Width = 0;
+    int m_Height = 0;
+    std::vector<float> m_Depth;
+    std::vector<Occluder> m_Occluders;
+};
@@ -0,0 +1,82 @@
+#include "ParallelFor.h"
+#include <algorithm>
+
+ParallelFor::ParallelFor(size_t threadCount)
+{
+    m_Threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+        m_Threads.emplace_back([this, slot = i + 1]
+                               { workerLoop(slot); });
+}
+
+ParallelFor::~ParallelFor()
+{
+    {
+        std::scoped_lock lock(m_Mutex);
+        m_Quit = true;
+    }
+    m_Wake.notify_all();
+    m_Threads.clear();
+}
+
+void ParallelFor::run(size_t count, size_t grain, const Body &body)
+{
+    grain = std::max<size_t>(1, grain);
+    if (m_Threads.empty() || count <= grain)
+    {
+        if (count > 0)
+            body(0, count, 0);
+        return;
+    }
+
+    {
+        std::scoped_lock lock(m_Mutex);
+        m_Body = &body;
+        m_Count = count;
+        m_Grain = grain;
+        m_Next.store(0, std::memory_order_relaxed);
+        m_Busy = m_Threads.size();
+        ++m_Generation;
+    }
+    m_Wake.notify_all();
+
+    drain(0);
+
+    std::unique_lock lock(m_Mutex);
+    m_Done.wait(lock, [this]
+                { return m_Busy == 0; });
+    m_Body = nullptr;
+}
+
+void ParallelFor::workerLoop(size_t slot)
+{
+    uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock lock(m_Mutex);
+            m_Wake.wait(lock, [&]
+                        { return m_Quit || m_Generation != seen; });
+            if (m_Quit)
+                return;
+            seen = m_Generation;
+        }
+
+        drain(slot);
+
+        std::scoped_lock lock(m_Mutex);
+        if (--m_Busy == 0)
+            m_Done.notify_one();
+    }
+}
+
+void ParallelFor::drain(size_t slot)
+{
+    for (;;)
+    {
+        size_t begin = m_Next.fetch_add(m_Grain, std::memory_order_relaxed);
+        if (begin >= m_Count)
+            return;
+        (*m_Body)(begin, std::min(begin + m_Grain, m_Count), slot);
+    }
+}
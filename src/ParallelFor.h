@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork-join helper for short per-frame work. Unlike ThreadPool its threads are reserved for
+// the caller, so a frame's work never queues behind chunk generation. The calling thread
+// works too and run() returns once every batch has been processed.
+class ParallelFor
+{
+public:
+    using Body = std::function<void(size_t begin, size_t end, size_t slot)>;
+
+    // threadCount helper threads; 0 runs everything on the caller.
+    explicit ParallelFor(size_t threadCount);
+    ~ParallelFor();
+    ParallelFor(const ParallelFor &) = delete;
+    ParallelFor &operator=(const ParallelFor &) = delete;
+
+    // Number of distinct slot values passed to the body.
+    size_t concurrency() const { return m_Threads.size() + 1; }
+
+    // Calls body over [0, count) in batches of at most grain items.
+    void run(size_t count, size_t grain, const Body &body);
+
+private:
+    void workerLoop(size_t slot);
+    void drain(size_t slot);
+
+    std::vector<std::jthread> m_Threads;
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Done;
+    uint64_t m_Generation = 0;
+    size_t m_Busy = 0;
+    bool m_Quit = false;
+
+    const Body *m_Body = nullptr;
+    size_t m_Count = 0;
+    size_t m_Grain = 1;
+    std::atomic<size_t> m_Next{0};
+};
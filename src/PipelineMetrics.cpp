@@ -0,0 +1,137 @@
+#include "PipelineMetrics.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration latency)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    uint64_t value = us > 0 ? static_cast<uint64_t>(us) : 0;
+
+    m_Buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_Count.fetch_add(1, std::memory_order_relaxed);
+    m_SumUs.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t prev = m_MaxUs.load(std::memory_order_relaxed);
+    while (value > prev && !m_MaxUs.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+double LatencyHistogram::meanMs() const
+{
+    uint64_t n = count();
+    return n ? m_SumUs.load(std::memory_order_relaxed) / 1000.0 / n : 0.0;
+}
+
+double LatencyHistogram::percentileMs(double percentile) const
+{
+    uint64_t n = count();
+    if (n == 0)
+        return 0.0;
+
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * n)));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i)
+    {
+        seen += m_Buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(bucketMidpoint(i), m_MaxUs.load(std::memory_order_relaxed)) / 1000.0;
+    }
+    return maxMs();
+}
+
+int LatencyHistogram::bucketIndex(uint64_t us)
+{
+    if (us < SUB_BUCKETS)
+        return static_cast<int>(us);
+
+    int msb = std::bit_width(us) - 1;
+    int shift = msb - SUB_BITS;
+    int sub = static_cast<int>(us >> shift) - SUB_BUCKETS;
+    return (shift + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketMidpoint(int index)
+{
+    if (index < SUB_BUCKETS)
+        return static_cast<uint64_t>(index);
+
+    int shift = index / SUB_BUCKETS - 1;
+    uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return lower + ((1ull << shift) >> 1);
+}
+
+void PipelineStats::fillStages(const PipelineMetrics &metrics)
+{
+    auto fill = [](Stage &s, const char *name, const LatencyHistogram &h)
+    {
+        s.name = name;
+        s.count = h.count();
+        s.p50Ms = h.percentileMs(50);
+        s.p95Ms = h.percentileMs(95);
+        s.p99Ms = h.percentileMs(99);
+        s.maxMs = h.maxMs();
+    };
+    fill(stages[0], "queued->generated", metrics.queuedToGenerated);
+    fill(stages[1], "generated->meshed", metrics.generatedToMeshed);
+    fill(stages[2], "meshed->staged", metrics.meshedToStaged);
+    fill(stages[3], "staged->gpu_ready", metrics.stagedToReady);
+    remeshes = metrics.remeshes.load(std::memory_order_relaxed);
+}
+
+std::vector<std::string> PipelineStats::toLines() const
+{
+    char buf[160];
+    std::vector<std::string> lines;
+
+    std::snprintf(buf, sizeof(buf), "Chunks: %zu loaded, %zu awaiting terrain, %zu awaiting upload, %zu uploading",
+                  chunksLoaded, awaitingTerrain, awaitingUpload, uploading);
+    lines.emplace_back(buf);
+    std::snprintf(buf, sizeof(buf), "Queues: workers %zu  mesh %zu queued / %zu in flight  garbage %zu",
+                  workerQueue, meshJobsQueued, meshJobsInFlight, garbage);
+    lines.emplace_back(buf);
+    std::snprintf(buf, sizeof(buf), "Staging: %.1f / %.0f MB in flight (peak %.1f)  Rejected: %llu  Remeshes: %llu",
+                  staging.inFlightBytes / 1048576.0, staging.capacityBytes / 1048576.0,
+                  staging.peakInFlightBytes / 1048576.0, (unsigned long long)staging.rejectedAllocations,
+                  (unsigned long long)remeshes);
+    lines.emplace_back(buf);
+    std::snprintf(buf, sizeof(buf), "Streaming: %.2f / %.2f ms budget  Mesh job limit: %d (%.0f jobs/s)",
+                  streamingSpentMs, streamingBudgetMs, meshJobLimit, meshJobsPerSecond);
+    lines.emplace_back(buf);
+    for (const Stage &s : stages)
+    {
+        std::snprintf(buf, sizeof(buf), "%-18s p50 %7.2f  p95 %7.2f  p99 %7.2f  max %7.2f ms (%llu)",
+                      s.name, s.p50Ms, s.p95Ms, s.p99Ms, s.maxMs, (unsigned long long)s.count);
+        lines.emplace_back(buf);
+    }
+    return lines;
+}
+
+std::string PipelineStats::toJson(double timeSeconds) const
+{
+    char buf[640];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"t\":%.3f,\"chunks\":%zu,\"awaitingTerrain\":%zu,\"awaitingUpload\":%zu,\"uploading\":%zu,"
+                  "\"workerQueue\":%zu,\"meshJobsQueued\":%zu,\"meshJobsInFlight\":%zu,\"garbage\":%zu,"
+                  "\"stagingInFlightBytes\":%llu,\"stagingPeakBytes\":%llu,\"stagingCapacityBytes\":%llu,"
+                  "\"stagingRejected\":%llu,\"remeshes\":%llu,\"streamingBudgetMs\":%.3f,\"streamingSpentMs\":%.3f,"
+                  "\"meshJobLimit\":%d,\"meshJobsPerSecond\":%.1f,\"stages\":{",
+                  timeSeconds, chunksLoaded, awaitingTerrain, awaitingUpload, uploading,
+                  workerQueue, meshJobsQueued, meshJobsInFlight, garbage,
+                  (unsigned long long)staging.inFlightBytes, (unsigned long long)staging.peakInFlightBytes,
+                  (unsigned long long)staging.capacityBytes, (unsigned long long)staging.rejectedAllocations,
+                  (unsigned long long)remeshes, streamingBudgetMs, streamingSpentMs, meshJobLimit, meshJobsPerSecond);
+    std::string json = buf;
+
+    for (size_t i = 0; i < stages.size(); ++i)
+    {
+        const Stage &s = stages[i];
+        std::snprintf(buf, sizeof(buf), "%s\"%s\":{\"count\":%llu,\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"max\":%.3f}",
+                      i ? "," : "", s.name, (unsigned long long)s.count, s.p50Ms, s.p95Ms, s.p99Ms, s.maxMs);
+        json += buf;
+    }
+    json += "}}";
+    return json;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "RenderBackend.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// HdrHistogram-style latency histogram: each power-of-two range of microseconds is split
+// into 16 linear sub-buckets, so percentiles are within ~6% at any magnitude. Recording
+// is a few relaxed atomic ops, safe from any thread.
+class LatencyHistogram
+{
+public:
+    void record(std::chrono::steady_clock::duration latency);
+
+    uint64_t count() const { return m_Count.load(std::memory_order_relaxed); }
+    double meanMs() const;
+    double maxMs() const { return m_MaxUs.load(std::memory_order_relaxed) / 1000.0; }
+    double percentileMs(double percentile) const;
+
+private:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    static int bucketIndex(uint64_t us);
+    static uint64_t bucketMidpoint(int index);
+
+    std::array<std::atomic<uint64_t>, BUCKETS> m_Buckets{};
+    std::atomic<uint64_t> m_Count{0};
+    std::atomic<uint64_t> m_SumUs{0};
+    std::atomic<uint64_t> m_MaxUs{0};
+};
+
+// Per-stage latencies of the chunk pipeline, fed by World and its workers.
+struct PipelineMetrics
+{
+    LatencyHistogram queuedToGenerated;
+    LatencyHistogram generatedToMeshed;
+    LatencyHistogram meshedToStaged;
+    LatencyHistogram stagedToReady;
+    std::atomic<uint64_t> remeshes{0};
+};
+
+// Point-in-time view of the pipeline for the debug overlay and metric dumps.
+struct PipelineStats
+{
+    struct Stage
+    {
+        const char *name = "";
+        uint64_t count = 0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    std::array<Stage, 4> stages;
+
+    size_t chunksLoaded = 0;
+    size_t awaitingTerrain = 0;
+    size_t awaitingUpload = 0;
+    size_t uploading = 0;
+    size_t workerQueue = 0;
+    size_t meshJobsQueued = 0;
+    size_t meshJobsInFlight = 0;
+    size_t garbage = 0;
+    uint64_t remeshes = 0;
+    StagingStats staging;
+
+    double streamingBudgetMs = 0.0;
+    double streamingSpentMs = 0.0;
+    int meshJobLimit = 0;
+    double meshJobsPerSecond = 0.0;
+
+    void fillStages(const PipelineMetrics &metrics);
+    std::vector<std::string> toLines() const;
+    std::string toJson(double timeSeconds) const;
+};
@@ -1,12 +1,12 @@
 #include "Player.h"
-#include "Engine.h"
+#include "World.h"
 #include "Block.h"
 #include "Settings.h"
 #include <glm/gtc/constants.hpp>
 #include <algorithm>
 
-Player::Player(Engine *engine, glm::vec3 position, const Settings &settings)
-    : Entity(engine, position), m_settings(settings)
+Player::Player(World *world, glm::vec3 position, const Settings &settings)
+    : Entity(world, position), m_settings(settings)
 {
 }
 
@@ -25,7 +25,7 @@ void Player::update(float dt)
     Entity::update(dt);
 }
 
-void Player::process_keyboard(GLFWwindow *window, float dt)
+void Player::process_keyboard(const PlayerInput &input, float dt)
 {
 
     if (m_is_flying)
@@ -35,17 +35,17 @@ void Player::process_keyboard(GLFWwindow *window, float dt)
         glm::vec3 up = {0.f, 1.f, 0.f};
         glm::vec3 move_direction{0.f};
 
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        if (input.forward)
             move_direction += forward;
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        if (input.back)
             move_direction -= forward;
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        if (input.left)
             move_direction -= right;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        if (input.right)
             move_direction += right;
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+        if (input.jump)
             move_direction += up;
-        if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+        if (input.sprint)
             move_direction -= up;
 
         if (glm::length(move_direction) > 0.0f)
@@ -61,13 +61,13 @@ void Player::process_keyboard(GLFWwindow *window, float dt)
         glm::vec3 right = glm::normalize(glm::cross(forward, {0.f, 1.f, 0.f}));
         glm::vec3 move_direction{0.f};
 
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        if (input.forward)
             move_direction += forward;
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        if (input.back)
             move_direction -= forward;
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        if (input.left)
             move_direction -= right;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        if (input.right)
             move_direction += right;
 
         if (glm::length(move_direction) > 0.0f)
@@ -76,7 +76,7 @@ void Player::process_keyboard(GLFWwindow *window, float dt)
         }
         m_velocity += move_direction * SWIM_ACCELERATION * dt;
 
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+        if (input.jump)
         {
             m_velocity.y += SWIM_UP_ACCELERATION * dt;
         }
@@ -89,13 +89,13 @@ void Player::process_keyboard(GLFWwindow *window, float dt)
         glm::vec3 right = glm::normalize(glm::cross(forward, {0.f, 1.f, 0.f}));
         glm::vec3 move_direction{0.f};
 
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        if (input.forward)
             move_direction += forward;
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        if (input.back)
             move_direction -= forward;
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        if (input.left)
             move_direction -= right;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        if (input.right)
             move_direction += right;
 
         if (glm::length(move_direction) > 0.0f)
@@ -110,7 +110,7 @@ void Player::process_keyboard(GLFWwindow *window, float dt)
         m_velocity.x += move_direction.x * acceleration * dt;
         m_velocity.z += move_direction.z * acceleration * dt;
 
-        m_is_sprinting = (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS);
+        m_is_sprinting = input.sprint;
         float current_speed_limit = m_is_sprinting ? SPRINT_SPEED : WALK_SPEED;
 
         glm::vec3 horizontal_velocity = {m_velocity.x, 0.0f, m_velocity.z};
@@ -121,7 +121,7 @@ void Player::process_keyboard(GLFWwindow *window, float dt)
             m_velocity.z = limited_velocity.z;
         }
 
-        if (m_is_on_ground && glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+        if (m_is_on_ground && input.jump)
         {
             m_velocity.y = JUMP_FORCE;
         }
@@ -146,7 +146,7 @@ bool Player::raycast(glm::vec3 &out_block_pos) const
         int block_y = static_cast<int>(floor(current_pos.y));
         int block_z = static_cast<int>(floor(current_pos.z));
 
-        Block block = m_engine->get_block(block_x, block_y, block_z);
+        Block block = m_world->get_block(block_x, block_y, block_z);
         if (BlockDatabase::get().get_block_data(block.id).is_solid)
         {
             out_block_pos = {block_x, block_y, block_z};
@@ -163,7 +163,13 @@ void Player::get_orientation(float &yaw, float &pitch) const
     pitch = m_pitch;
 }
 
-void Player::update_camera_interpolated(Engine *engine, float alpha)
+void Player::set_orientation(float yaw, float pitch)
+{
+    m_yaw = yaw;
+    m_pitch = glm::clamp(pitch, -glm::half_pi<float>() + 0.01f, glm::half_pi<float>() - 0.01f);
+}
+
+void Player::update_camera_interpolated(float alpha, float aspect)
 {
 
     glm::vec3 interpolated_pos = glm::mix(m_previousPosition, m_position, alpha);
@@ -175,12 +181,11 @@ void Player::update_camera_interpolated(Engine *engine, float alpha)
         sin(m_yaw) * cos(m_pitch)};
     m_camera.setViewDirection(eye_position, look_direction);
 
-    auto ext = engine->get_window().getExtent();
-    if (ext.height > 0)
+    if (aspect > 0.f)
     {
         m_camera.setPerspectiveProjection(
             glm::radians(m_settings.fov),
-            static_cast<float>(ext.width) / ext.height,
+            aspect,
             0.1f,
             1000.f);
     }
@@ -194,7 +199,7 @@ void Player::process_mouse_movement(float dx, float dy)
     m_pitch = glm::clamp(m_pitch, -glm::half_pi<float>() + 0.01f, glm::half_pi<float>() - 0.01f);
 }
 
-void Player::update_camera(Engine *engine)
+void Player::update_camera(float aspect)
 {
     glm::vec3 eye_position = m_position + glm::vec3(0.f, m_hitbox.max.y * 0.9f, 0.f);
     glm::vec3 look_direction{
@@ -203,12 +208,11 @@ void Player::update_camera(Engine *engine)
         sin(m_yaw) * cos(m_pitch)};
     m_camera.setViewDirection(eye_position, look_direction);
 
-    auto ext = engine->get_window().getExtent();
-    if (ext.height > 0)
+    if (aspect > 0.f)
     {
         m_camera.setPerspectiveProjection(
             glm::radians(m_settings.fov),
-            static_cast<float>(ext.width) / ext.height,
+            aspect,
             0.1f,
             1000.f);
     }
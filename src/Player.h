@@ -3,29 +3,39 @@
 #include "Entity.h"
 #include "Camera.h"
 #include <glm/gtc/constants.hpp>
-#include <GLFW/glfw3.h>
 
 struct Settings;
 
+struct PlayerInput
+{
+    bool forward = false;
+    bool back = false;
+    bool left = false;
+    bool right = false;
+    bool jump = false;
+    bool sprint = false;
+};
+
 class Player : public Entity
 {
 public:
-    Player(Engine *engine, glm::vec3 position, const Settings &settings);
+    Player(World *world, glm::vec3 position, const Settings &settings);
 
     void update(float dt) override;
 
     bool raycast(glm::vec3 &out_block_pos) const;
     void process_mouse_movement(float dx, float dy);
     void get_orientation(float &yaw, float &pitch) const;
-    void process_keyboard(GLFWwindow *window, float dt);
+    void set_orientation(float yaw, float pitch);
+    void process_keyboard(const PlayerInput &input, float dt);
     void toggle_flight();
 
     Camera &get_camera() { return m_camera; }
 
-    void update_camera_interpolated(Engine *engine, float alpha);
+    void update_camera_interpolated(float alpha, float aspect);
 
 private:
-    void update_camera(Engine *engine);
+    void update_camera(float aspect);
 
     Camera m_camera;
     float m_yaw = -glm::half_pi<float>();
@@ -0,0 +1,154 @@
+#include "Profiler.h"
+
+#ifdef VIBECRAFT_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint64_t RING_CAPACITY = 1 << 15;
+
+    struct Event
+    {
+        const char *name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    struct ThreadRing
+    {
+        uint32_t tid = 0;
+        std::string name;
+        std::atomic<uint64_t> head{0};
+        std::unique_ptr<Event[]> events{new Event[RING_CAPACITY]};
+    };
+
+    // Rings are never freed: a thread may still be writing while another exports, and
+    // the engine's threads live for the whole process anyway.
+    struct Registry
+    {
+        std::mutex mtx;
+        std::vector<ThreadRing *> rings;
+    };
+
+    Registry &registry()
+    {
+        static Registry *r = new Registry();
+        return *r;
+    }
+
+    const Clock::time_point g_Epoch = Clock::now();
+
+    ThreadRing &localRing()
+    {
+        thread_local ThreadRing *ring = nullptr;
+        if (!ring)
+        {
+            auto *r = new ThreadRing();
+            Registry &reg = registry();
+            std::scoped_lock lock(reg.mtx);
+            r->tid = static_cast<uint32_t>(reg.rings.size()) + 1;
+            r->name = "Thread " + std::to_string(r->tid);
+            reg.rings.push_back(r);
+            ring = r;
+        }
+        return *ring;
+    }
+
+    void writeJsonString(std::ostream &out, const std::string &s)
+    {
+        out << '"';
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+}
+
+namespace Profiler
+{
+    uint64_t now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - g_Epoch).count());
+    }
+
+    void record(const char *name, uint64_t start, uint64_t end)
+    {
+        ThreadRing &ring = localRing();
+        uint64_t h = ring.head.load(std::memory_order_relaxed);
+        ring.events[h & (RING_CAPACITY - 1)] = {name, start, end};
+        ring.head.store(h + 1, std::memory_order_release);
+    }
+
+    void setThreadName(const char *name)
+    {
+        ThreadRing &ring = localRing();
+        std::scoped_lock lock(registry().mtx);
+        ring.name = name;
+    }
+
+    bool writeChromeTrace(const std::string &path)
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+            return false;
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out.setf(std::ios::fixed);
+        out.precision(3);
+
+        bool first = true;
+        auto separator = [&]
+        {
+            if (!first)
+                out << ",\n";
+            first = false;
+        };
+
+        Registry &reg = registry();
+        std::scoped_lock lock(reg.mtx);
+        std::vector<Event> snapshot;
+        for (ThreadRing *ring : reg.rings)
+        {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid << ",\"args\":{\"name\":";
+            writeJsonString(out, ring->name);
+            out << "}}";
+
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t begin = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+            snapshot.clear();
+            for (uint64_t i = begin; i < head; ++i)
+                snapshot.push_back(ring->events[i & (RING_CAPACITY - 1)]);
+
+            // The owner keeps writing while we copy; drop every slot it may have reused.
+            uint64_t after = ring->head.load(std::memory_order_acquire);
+            uint64_t valid = after + 1 > RING_CAPACITY ? after + 1 - RING_CAPACITY : 0;
+
+            for (uint64_t i = std::max(begin, valid); i < head; ++i)
+            {
+                const Event &e = snapshot[i - begin];
+                separator();
+                out << "{\"name\":";
+                writeJsonString(out, e.name);
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->tid
+                    << ",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << (e.end - e.start) / 1000.0 << "}";
+            }
+        }
+
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+}
+
+#endif
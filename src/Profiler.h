@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Scoped-zone CPU profiler. Every thread appends to its own fixed-size ring without
+// locking; writeChromeTrace() snapshots all rings into a Chrome trace event JSON file
+// (chrome://tracing, Perfetto). Zone names must be string literals.
+// Build with -DVIBECRAFT_PROFILER=OFF to compile every zone out.
+namespace Profiler
+{
+#ifdef VIBECRAFT_PROFILER
+    constexpr bool ENABLED = true;
+
+    uint64_t now();
+    void record(const char *name, uint64_t start, uint64_t end);
+    void setThreadName(const char *name);
+    bool writeChromeTrace(const std::string &path);
+
+    class Zone
+    {
+    public:
+        explicit Zone(const char *name) : m_Name(name), m_Start(now()) {}
+        ~Zone() { record(m_Name, m_Start, now()); }
+        Zone(const Zone &) = delete;
+        Zone &operator=(const Zone &) = delete;
+
+    private:
+        const char *m_Name;
+        uint64_t m_Start;
+    };
+#else
+    constexpr bool ENABLED = false;
+
+    inline void setThreadName(const char *) {}
+    inline bool writeChromeTrace(const std::string &) { return false; }
+#endif
+}
+
+#ifdef VIBECRAFT_PROFILER
+#define VC_PROFILE_CONCAT_IMPL(a, b) a##b
+#define VC_PROFILE_CONCAT(a, b) VC_PROFILE_CONCAT_IMPL(a, b)
+#define VC_PROFILE_ZONE(name) ::Profiler::Zone VC_PROFILE_CONCAT(vcProfileZone_, __LINE__)(name)
+#else
+#define VC_PROFILE_ZONE(name) ((void)0)
+#endif
@@ -0,0 +1,79 @@
+#include "RangeAllocator.h"
+#include <iterator>
+#include <stdexcept>
+
+RangeAllocator::RangeAllocator(uint64_t capacity)
+{
+    reset(capacity);
+}
+
+void RangeAllocator::reset(uint64_t capacity)
+{
+    m_Capacity = capacity;
+    m_Used = 0;
+    m_ByOffset.clear();
+    m_BySize.clear();
+    if (capacity > 0)
+        insertFree(0, capacity);
+}
+
+void RangeAllocator::insertFree(uint64_t offset, uint64_t size)
+{
+    m_ByOffset.emplace(offset, size);
+    m_BySize.emplace(size, offset);
+}
+
+void RangeAllocator::eraseFree(std::map<uint64_t, uint64_t>::iterator it)
+{
+    m_BySize.erase({it->second, it->first});
+    m_ByOffset.erase(it);
+}
+
+bool RangeAllocator::allocate(uint64_t size, uint64_t &offset)
+{
+    if (size == 0)
+        return false;
+
+    auto fit = m_BySize.lower_bound({size, 0});
+    if (fit == m_BySize.end())
+        return false;
+
+    const auto [freeSize, freeOffset] = *fit;
+    eraseFree(m_ByOffset.find(freeOffset));
+    if (freeSize > size)
+        insertFree(freeOffset + size, freeSize - size);
+
+    offset = freeOffset;
+    m_Used += size;
+    return true;
+}
+
+void RangeAllocator::free(uint64_t offset, uint64_t size)
+{
+    if (size == 0)
+        return;
+    if (offset + size > m_Capacity || size > m_Used)
+        throw std::runtime_error("RangeAllocator::free: range was not allocated");
+    m_Used -= size;
+
+    auto next = m_ByOffset.lower_bound(offset);
+    if (next != m_ByOffset.end() && next->first == offset + size)
+    {
+        size += next->second;
+        eraseFree(next);
+    }
+
+    next = m_ByOffset.lower_bound(offset);
+    if (next != m_ByOffset.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            eraseFree(prev);
+        }
+    }
+
+    insertFree(offset, size);
+}
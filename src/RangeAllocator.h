@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+
+// Hands out ranges of a fixed-size linear space, such as elements of a shared GPU buffer.
+// Allocation is best fit; freed ranges are merged with free neighbours so the space does not
+// fragment into unusable slivers. Not thread-safe.
+class RangeAllocator
+{
+public:
+    explicit RangeAllocator(uint64_t capacity = 0);
+
+    // Drops every allocation.
+    void reset(uint64_t capacity);
+    bool allocate(uint64_t size, uint64_t &offset);
+    // size must be the size the range was allocated with.
+    void free(uint64_t offset, uint64_t size);
+
+    uint64_t getCapacity() const { return m_Capacity; }
+    uint64_t getUsed() const { return m_Used; }
+    uint64_t getLargestFree() const { return m_BySize.empty() ? 0 : m_BySize.rbegin()->first; }
+    size_t getFreeRangeCount() const { return m_ByOffset.size(); }
+
+private:
+    void insertFree(uint64_t offset, uint64_t size);
+    void eraseFree(std::map<uint64_t, uint64_t>::iterator it);
+
+    uint64_t m_Capacity = 0;
+    uint64_t m_Used = 0;
+    // Free ranges keyed by offset for merging, and by (size, offset) for best fit.
+    std::map<uint64_t, uint64_t> m_ByOffset;
+    std::set<std::pair<uint64_t, uint64_t>> m_BySize;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+class Chunk;
+
+// Backend-owned GPU storage for one uploaded mesh section.
+struct GpuMesh
+{
+    virtual ~GpuMesh() = default;
+
+    // Where the section sits in the backend's shared vertex and index buffers, in elements.
+    // Sections that did not fit there are not pooled and are drawn from their own buffers.
+    bool pooled = false;
+    uint32_t firstIndex = 0;
+    int32_t vertexOffset = 0;
+};
+
+// A mesh section written into the backend's staging memory, waiting for upload.
+struct StagedMesh
+{
+    uint64_t vertexOffset = 0;
+    uint64_t vertexBytes = 0;
+    uint64_t indexOffset = 0;
+    uint64_t indexBytes = 0;
+
+    bool empty() const { return vertexBytes == 0 || indexBytes == 0; }
+};
+
+// Staging memory pressure: bytes submitted for upload whose copy has not finished
+// yet, and reservations refused because the ring had no room.
+struct StagingStats
+{
+    uint64_t capacityBytes = 0;
+    uint64_t inFlightBytes = 0;
+    uint64_t peakInFlightBytes = 0;
+    uint64_t rejectedAllocations = 0;
+};
+
+// What the chunk pipeline needs from a renderer. reserveStaging is called from
+// mesh workers; everything else runs on the main thread.
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() = default;
+
+    // Returns the base of the mapped staging memory with out's offsets filled in,
+    // or nullptr when the section is empty or does not fit.
+    virtual uint8_t *reserveStaging(uint64_t vertexBytes, uint64_t indexBytes, StagedMesh &out) = 0;
+
+    virtual std::unique_ptr<GpuMesh> uploadMesh(const StagedMesh &staged) = 0;
+    virtual bool isUploadComplete(GpuMesh &mesh) = 0;
+    virtual void retireMesh(std::unique_ptr<GpuMesh> mesh) = 0;
+
+    virtual void scheduleChunkGpuCleanup(std::shared_ptr<Chunk> chunk) = 0;
+
+    virtual StagingStats getStagingStats() = 0;
+
+    bool stageMesh(const void *vertices, uint64_t vertexBytes, const void *indices, uint64_t indexBytes, StagedMesh &out)
+    {
+        uint8_t *base = reserveStaging(vertexBytes, indexBytes, out);
+        if (!base)
+            return false;
+        std::memcpy(base + out.vertexOffset, vertices, vertexBytes);
+        std::memcpy(base + out.indexOffset, indices, indexBytes);
+        return true;
+    }
+};
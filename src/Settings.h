@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <string>
 
 namespace SettingsEnums
 {
@@ -11,6 +12,12 @@ namespace SettingsEnums
         REFLECTIONS = 1 << 1,
         GI = 1 << 2
     };
+
+    enum class PersistenceMode
+    {
+        REGION_SNAPSHOTS,
+        EDIT_LOG
+    };
 }
 
 struct Settings
@@ -29,10 +36,24 @@ struct Settings
 
     int renderDistance = 12;
     std::vector<int> lodDistances = {8, 16, 24};
-
-    int chunksToCreatePerFrame = 8;
-    int chunksToUploadPerFrame = 4;
-
-    int maxMeshJobsInFlight = 2;
-    int maxMeshJobsBurst = 6;
+    int cullingThreads = 2;
+    int recordingThreads = 2;
+    bool caveCulling = true;
+    bool occlusionCulling = true;
+    int occlusionRange = 4;
+    // Skips cave and occlusion culling and the cached chunk secondaries; off until it does them.
+    bool gpuCulling = false;
+
+    double targetFrameMs = 1000.0 / 60.0;
+    double streamingMinBudgetMs = 0.5;
+
+    std::string pipelineMetricsFile;
+    int pipelineMetricsIntervalMs = 5000;
+
+    int worldSeed = 1337;
+    std::string worldDirectory = "world";
+    SettingsEnums::PersistenceMode persistenceMode = SettingsEnums::PersistenceMode::REGION_SNAPSHOTS;
+    int saveQueueBudgetMB = 32;
+    int saveSyncIntervalMs = 5000;
+    bool meshCache = true;
 };
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "StreamingScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using milli = std::chrono::duration<double, std::milli>;
+
+    constexpr double INITIAL_COST_MS[] = {0.10, 0.05, 0.02, 0.05};
+    constexpr auto THROUGHPUT_WINDOW = std::chrono::milliseconds(250);
+    constexpr size_t MAX_JOBS_PER_WORKER = 32;
+}
+
+StreamingScheduler::StreamingScheduler(const Settings &settings, size_t workerCount)
+    : m_Settings(settings), m_Workers(std::max<size_t>(1, workerCount)),
+      m_SampleStart(Clock::now()), m_MeshJobLimit(static_cast<int>(m_Workers))
+{
+    for (size_t i = 0; i < m_CostMs.size(); ++i)
+        m_CostMs[i] = INITIAL_COST_MS[i];
+}
+
+void StreamingScheduler::beginFrame(double frameWorkSeconds)
+{
+    m_FrameStart = Clock::now();
+
+    const double target = m_Settings.targetFrameMs;
+    const double otherWorkMs = std::max(0.0, frameWorkSeconds * 1000.0 - m_StreamingMsEMA);
+    m_BudgetMs = std::clamp(target - otherWorkMs, m_Settings.streamingMinBudgetMs, std::max(target, m_Settings.streamingMinBudgetMs));
+    m_AnyAdmitted = false;
+
+    m_Current = Stats{};
+    m_Current.budgetMs = m_BudgetMs;
+
+    updateMeshJobLimit(m_FrameStart);
+}
+
+void StreamingScheduler::endFrame()
+{
+    double spent = milli(Clock::now() - m_FrameStart).count();
+    m_StreamingMsEMA = 0.9 * m_StreamingMsEMA + 0.1 * spent;
+
+    m_Current.spentMs = spent;
+    m_Current.costMs = m_CostMs;
+    m_Current.meshJobLimit = m_MeshJobLimit;
+    m_Current.meshJobsPerSecond = m_MeshJobsPerSecond;
+    m_Stats = m_Current;
+}
+
+bool StreamingScheduler::admit(Op op)
+{
+    const size_t i = static_cast<size_t>(op);
+    double elapsed = milli(Clock::now() - m_FrameStart).count();
+
+    // Always let one operation through so streaming progresses even when the rest of
+    // the frame already overruns the target.
+    if (m_AnyAdmitted && elapsed + m_CostMs[i] > m_BudgetMs)
+    {
+        ++m_Current.deferred[i];
+        return false;
+    }
+
+    m_AnyAdmitted = true;
+    ++m_Current.admitted[i];
+    return true;
+}
+
+void StreamingScheduler::complete(Op op, std::chrono::steady_clock::duration cost)
+{
+    const size_t i = static_cast<size_t>(op);
+    double ms = milli(cost).count();
+
+    // Rise quickly on an expensive sample and decay slowly, so one cheap run does not
+    // invite a spike on the next frame.
+    double alpha = ms > m_CostMs[i] ? 0.5 : 0.05;
+    m_CostMs[i] += alpha * (ms - m_CostMs[i]);
+}
+
+void StreamingScheduler::updateMeshJobLimit(Clock::time_point now)
+{
+    auto window = now - m_SampleStart;
+    if (window < THROUGHPUT_WINDOW)
+        return;
+
+    uint64_t completed = m_MeshJobsCompleted.load(std::memory_order_relaxed);
+    double rate = (completed - m_MeshJobsAtSample) / std::chrono::duration<double>(window).count();
+    m_MeshJobsAtSample = completed;
+    m_SampleStart = now;
+    m_MeshJobsPerSecond = 0.5 * m_MeshJobsPerSecond + 0.5 * rate;
+
+    // Keep enough jobs queued that workers stay busy until the next frame refills them,
+    // but no more: queued jobs are not re-sorted when the player moves.
+    double perFrame = m_MeshJobsPerSecond * m_Settings.targetFrameMs / 1000.0;
+    size_t limit = m_Workers + static_cast<size_t>(std::ceil(perFrame));
+    m_MeshJobLimit = static_cast<int>(std::clamp(limit, m_Workers, m_Workers * MAX_JOBS_PER_WORKER));
+}
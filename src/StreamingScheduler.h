@@ -0,0 +1,82 @@
+#pragma once
+#include "Settings.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Decides how much chunk streaming work the main thread does each frame. The budget is
+// what the target frame time leaves after the rest of the frame's work. Each operation
+// kind keeps a running estimate of its own cost and is admitted only while that still
+// fits. The mesh-job limit follows measured worker throughput instead of a constant.
+class StreamingScheduler
+{
+public:
+    enum class Op
+    {
+        UPLOAD_CHUNK,
+        SUBMIT_MESH_JOB,
+        CREATE_CHUNK,
+        RETIRE_CHUNK,
+        COUNT
+    };
+
+    struct Stats
+    {
+        double budgetMs = 0.0;
+        double spentMs = 0.0;
+        int meshJobLimit = 0;
+        double meshJobsPerSecond = 0.0;
+        std::array<double, static_cast<size_t>(Op::COUNT)> costMs{};
+        std::array<uint32_t, static_cast<size_t>(Op::COUNT)> admitted{};
+        std::array<uint32_t, static_cast<size_t>(Op::COUNT)> deferred{};
+    };
+
+    StreamingScheduler(const Settings &settings, size_t workerCount);
+
+    // frameWorkSeconds: main-thread busy time per frame, excluding vsync and GPU waits.
+    void beginFrame(double frameWorkSeconds);
+    void endFrame();
+
+    // Admits one operation if its estimated cost fits; the caller then runs it and
+    // reports the measured time through complete().
+    bool admit(Op op);
+    void complete(Op op, std::chrono::steady_clock::duration cost);
+
+    template <typename F>
+    bool run(Op op, F &&work)
+    {
+        if (!admit(op))
+            return false;
+        auto start = std::chrono::steady_clock::now();
+        work();
+        complete(op, std::chrono::steady_clock::now() - start);
+        return true;
+    }
+
+    // Called from workers when a mesh job finishes.
+    void onMeshJobCompleted() { m_MeshJobsCompleted.fetch_add(1, std::memory_order_relaxed); }
+    int meshJobLimit() const { return m_MeshJobLimit; }
+
+    const Stats &getStats() const { return m_Stats; }
+
+private:
+    void updateMeshJobLimit(std::chrono::steady_clock::time_point now);
+
+    const Settings &m_Settings;
+    size_t m_Workers;
+
+    std::array<double, static_cast<size_t>(Op::COUNT)> m_CostMs{};
+    double m_StreamingMsEMA = 0.0;
+    double m_BudgetMs = 0.0;
+    bool m_AnyAdmitted = false;
+    std::chrono::steady_clock::time_point m_FrameStart;
+    Stats m_Stats;
+    Stats m_Current;
+
+    std::atomic<uint64_t> m_MeshJobsCompleted{0};
+    uint64_t m_MeshJobsAtSample = 0;
+    std::chrono::steady_clock::time_point m_SampleStart;
+    double m_MeshJobsPerSecond = 0.0;
+    int m_MeshJobLimit;
+};
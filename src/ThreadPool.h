@@ -18,10 +18,10 @@ class ThreadPool
     bool quit = false;
 
 public:
-    explicit ThreadPool()
+    explicit ThreadPool(size_t threadCount = 0)
     {
         size_t hw = std::thread::hardware_concurrency();
-        size_t n = hw > 2 ? hw - 2 : 1;
+        size_t n = threadCount > 0 ? threadCount : (hw > 2 ? hw - 2 : 1);
         for (size_t i = 0; i < n; ++i)
         {
             workers.emplace_back([this](std::stop_token st)
@@ -68,6 +68,14 @@ public:
         std::cout << "ThreadPool: All workers joined. Shutdown complete." << std::endl;
     }
 
+    size_t size() const { return workers.size(); }
+
+    size_t pending()
+    {
+        std::scoped_lock lock(mtx);
+        return jobs.size();
+    }
+
     void submit(std::function<void(std::stop_token)> f)
     {
         {
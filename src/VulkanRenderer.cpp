@@ -10,21 +10,32 @@
 #include "generation/TerrainGenerator.h"
 #include <stb_image.h>
 #include <numeric>
+#include <algorithm>
+#include <chrono>
 #include "renderer/RayTracingPushConstants.h"
+#include "renderer/ChunkCullPushConstants.h"
+#include "Profiler.h"
 
 VulkanRenderer::VulkanRenderer(Window &window,
                                Settings &settings,
-                               Player *player,
-                               TerrainGenerator *terrainGen)
-    : m_Window(window), m_Settings(settings), m_player(player), m_terrainGen(terrainGen)
+                               Player *player)
+    : m_Window(window), m_Settings(settings), m_player(player)
 {
 
     m_InstanceContext = std::make_unique<InstanceContext>(m_Window);
     m_DeviceContext = std::make_unique<DeviceContext>(*m_InstanceContext);
 
+    m_Culler = std::make_unique<ChunkCuller>(m_Settings, static_cast<size_t>(std::max(0, m_Settings.cullingThreads)));
+    m_DrawTable = std::make_unique<GpuDrawTable>(m_Settings);
+
     VkDeviceSize arenaSize = 64ull * 1024 * 1024;
     m_StagingArena = std::make_unique<RingStagingArena>(*m_DeviceContext, arenaSize);
 
+    VkDeviceSize meshPoolVertexBytes = 256ull * 1024 * 1024;
+    VkDeviceSize meshPoolIndexBytes = 128ull * 1024 * 1024;
+    m_MeshPool = std::make_unique<ChunkMeshPool>(*m_DeviceContext, meshPoolVertexBytes, meshPoolIndexBytes);
+    m_ChunkOrigins = std::make_unique<ChunkOriginTable>(*m_DeviceContext, 4096);
+
     if (m_DeviceContext->hasTransferQueue())
     {
         VkCommandPoolCreateInfo ci{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
@@ -41,13 +52,15 @@ VulkanRenderer::VulkanRenderer(Window &window,
     m_PipelineCache = std::make_unique<PipelineCache>(
         *m_DeviceContext, *m_SwapChainContext, *m_DescriptorLayout);
     m_CommandManager = std::make_unique<CommandManager>(
-        *m_DeviceContext, *m_SwapChainContext, *m_PipelineCache);
+        *m_DeviceContext, *m_SwapChainContext, *m_PipelineCache,
+        static_cast<size_t>(std::max(0, m_Settings.recordingThreads)));
     m_SyncPrimitives = std::make_unique<SyncPrimitives>(
         *m_DeviceContext, *m_SwapChainContext);
 
     m_debugOverlay = std::make_unique<DebugOverlay>(
         *m_DeviceContext,
-        m_CommandManager->getCommandPool());
+        m_CommandManager->getCommandPool(),
+        m_PipelineCache->getVkPipelineCache());
 
     m_debugOverlay->recreate(m_SwapChainContext->getRenderPass(), m_SwapChainContext->getSwapChainExtent());
 
@@ -60,9 +73,9 @@ VulkanRenderer::VulkanRenderer(Window &window,
     createSkyResources();
     createLightUbo();
     createUniformBuffers();
-    createModelMatrixSsbos();
     createDescriptorPool();
     createDescriptorSets();
+    createGpuCullResources();
     createCrosshairResources();
     recreateCrosshairVertexBuffer();
     createOutlineVertexBuffer();
@@ -160,44 +173,120 @@ void VulkanRenderer::recreateCrosshairVertexBuffer()
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
 }
 
-void VulkanRenderer::createModelMatrixSsbos()
+void VulkanRenderer::createGpuCullResources()
 {
-    VkDeviceSize bufferSize = sizeof(glm::mat4) * MAX_CHUNKS_PER_FRAME;
-    m_ModelMatrixSsbos.resize(MAX_FRAMES_IN_FLIGHT);
-    m_ModelMatrixSsbosMapped.resize(MAX_FRAMES_IN_FLIGHT);
+    if (m_PipelineCache->getChunkCullPipeline() == VK_NULL_HANDLE)
+        return;
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * 3)};
+    VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(m_DeviceContext->getDevice(), &poolInfo, nullptr, &pool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create chunk cull descriptor pool!");
+    m_CullDescriptorPool = VulkanHandle<VkDescriptorPool, DescriptorPoolDeleter>(pool, {m_DeviceContext->getDevice()});
+
+    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_DescriptorLayout->getChunkCullSetLayout());
+    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> sets{};
+    VkDescriptorSetAllocateInfo alloc{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    alloc.descriptorPool = m_CullDescriptorPool.get();
+    alloc.descriptorSetCount = MAX_FRAMES_IN_FLIGHT;
+    alloc.pSetLayouts = layouts.data();
+    if (vkAllocateDescriptorSets(m_DeviceContext->getDevice(), &alloc, sets.data()) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate chunk cull descriptor sets");
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
     {
-        VkBufferCreateInfo bufferInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-        bufferInfo.size = bufferSize;
-        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        m_GpuCullFrames[i].set = sets[i];
 
+        VkBufferCreateInfo bufferInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+        bufferInfo.size = sizeof(uint32_t);
+        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
         VmaAllocationCreateInfo allocInfo{};
-        allocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-        allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        m_GpuCullFrames[i].count = VmaBuffer(m_DeviceContext->getAllocator(), bufferInfo, allocInfo);
 
-        m_ModelMatrixSsbos[i] = VmaBuffer(m_DeviceContext->getAllocator(), bufferInfo, allocInfo);
+        reserveGpuCullFrame(i, 1024);
+    }
+}
 
-        VmaAllocationInfo allocationInfo;
+// Grows the slot's table and command buffers to hold at least draws entries. Only called
+// once the slot's fence has signalled, so the old buffers are no longer read.
+void VulkanRenderer::reserveGpuCullFrame(uint32_t frame, uint32_t draws)
+{
+    GpuCullFrame &f = m_GpuCullFrames[frame];
+    if (draws <= f.capacity)
+        return;
+
+    uint32_t capacity = std::max(f.capacity, 1024u);
+    while (capacity < draws)
+        capacity *= 2;
+
+    if (f.draws.get() != VK_NULL_HANDLE)
+        enqueueDestroy(std::move(f.draws));
+    if (f.commands.get() != VK_NULL_HANDLE)
+        enqueueDestroy(std::move(f.commands));
+
+    VkBufferCreateInfo bufferInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bufferInfo.size = sizeof(GpuChunkDraw) * capacity;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    f.draws = VmaBuffer(m_DeviceContext->getAllocator(), bufferInfo, allocInfo);
+
+    VmaAllocationInfo allocationInfo;
+    vmaGetAllocationInfo(m_DeviceContext->getAllocator(), f.draws.getAllocation(), &allocationInfo);
+    f.drawsMapped = allocationInfo.pMappedData;
 
-        vmaGetAllocationInfo(m_DeviceContext->getAllocator(), m_ModelMatrixSsbos[i].getAllocation(), &allocationInfo);
-        m_ModelMatrixSsbosMapped[i] = allocationInfo.pMappedData;
+    bufferInfo.size = sizeof(VkDrawIndexedIndirectCommand) * capacity;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    allocInfo = {};
+    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    f.commands = VmaBuffer(m_DeviceContext->getAllocator(), bufferInfo, allocInfo);
+
+    f.capacity = capacity;
+    f.tableVersion = 0;
+
+    std::array<VkDescriptorBufferInfo, 3> infos{{{f.draws.get(), 0, VK_WHOLE_SIZE},
+                                                 {f.commands.get(), 0, VK_WHOLE_SIZE},
+                                                 {f.count.get(), 0, VK_WHOLE_SIZE}}};
+    std::array<VkWriteDescriptorSet, 3> writes{};
+    for (uint32_t i = 0; i < writes.size(); ++i)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = f.set;
+        writes[i].dstBinding = i;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].descriptorCount = 1;
+        writes[i].pBufferInfo = &infos[i];
     }
+    vkUpdateDescriptorSets(m_DeviceContext->getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
 }
 
 bool VulkanRenderer::drawFrame(Camera &camera,
                                const glm::vec3 &playerPos,
                                std::map<glm::ivec3, std::shared_ptr<Chunk>, ivec3_less> &chunks,
+                               uint64_t chunkSetVersion,
+                               uint64_t cullDataVersion,
                                const glm::ivec3 &playerChunkPos,
                                uint32_t gameTicks,
-                               const std::vector<AABB> &debugAABBs,
+                               const std::pmr::vector<AABB> &debugAABBs,
                                bool showDebugOverlay,
-                               const std::vector<glm::vec3> &outlineVertices,
+                               const std::pmr::vector<glm::vec3> &outlineVertices,
                                const std::optional<glm::ivec3> &hoveredBlockPos)
 {
+    VC_PROFILE_ZONE("VulkanRenderer::drawFrame");
     const uint32_t slot = m_CurrentFrame;
+    const auto waitStart = std::chrono::steady_clock::now();
 
-    vkWaitForFences(m_DeviceContext->getDevice(), 1, m_SyncPrimitives->getInFlightFencePtr(slot), VK_TRUE, UINT64_MAX);
+    {
+        VC_PROFILE_ZONE("Wait for frame fence");
+        vkWaitForFences(m_DeviceContext->getDevice(), 1, m_SyncPrimitives->getInFlightFencePtr(slot), VK_TRUE, UINT64_MAX);
+    }
 
     VkResult deviceStatus = vkGetFenceStatus(m_DeviceContext->getDevice(), m_SyncPrimitives->getInFlightFence(slot));
     if (deviceStatus == VK_ERROR_DEVICE_LOST)
@@ -211,11 +300,13 @@ bool VulkanRenderer::drawFrame(Camera &camera,
         UINT64_MAX,
         m_SyncPrimitives->getImageAvailableSemaphore(slot),
         VK_NULL_HANDLE, &imageIndex);
+    m_LastFrameWaitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
 
     if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR || m_Window.wasWindowResized())
     {
         m_Window.resetWindowResizedFlag();
         m_SwapChainContext->recreateSwapChain();
+        m_CommandManager->invalidateSecondaries();
         if (m_debugOverlay)
             m_debugOverlay->recreate(m_SwapChainContext->getRenderPass(), m_SwapChainContext->getSwapChainExtent());
 
@@ -235,6 +326,8 @@ bool VulkanRenderer::drawFrame(Camera &camera,
     m_blasBuildScratchBuffers[slot].clear();
     m_BufferDestroyQueue[slot].clear();
     m_ImageDestroyQueue[slot].clear();
+    m_MeshPool->releaseFrame(slot);
+    m_ChunkOrigins->releaseFrame(slot);
 
     for (auto &as : m_AsDestroyQueue[slot])
     {
@@ -243,6 +336,34 @@ bool VulkanRenderer::drawFrame(Camera &camera,
 
     m_AsDestroyQueue[slot].clear();
 
+    // Unloaded chunks hand their meshes back here so pooled ranges are reused rather than leaked.
+    for (auto &chunk : m_ChunkCleanupQueue[slot])
+    {
+        std::scoped_lock lock(chunk->m_MeshesMutex);
+        for (auto *meshes : {&chunk->m_Meshes, &chunk->m_TransparentMeshes})
+        {
+            for (auto &[lod, mesh] : *meshes)
+            {
+                if (mesh.gpu)
+                    retireMesh(std::move(mesh.gpu));
+            }
+        }
+        m_ChunkOrigins->release(*chunk, slot);
+    }
+    m_ChunkCleanupQueue[slot].clear();
+
+    // A chunk's origin is written once when it joins the map; draws then only pass its slot.
+    if (chunkSetVersion != m_OriginsChunkSetVersion)
+    {
+        VC_PROFILE_ZONE("Assign chunk origin slots");
+        const uint32_t capacity = m_ChunkOrigins->getCapacity();
+        for (auto &[pos, chunk] : chunks)
+            m_ChunkOrigins->add(*chunk, slot);
+        if (m_ChunkOrigins->getCapacity() != capacity)
+            ++m_DescriptorRevision;
+        m_OriginsChunkSetVersion = chunkSetVersion;
+    }
+
     updateLightUbo(slot, gameTicks);
     glm::vec3 skyColor = updateUniformBuffer(slot, camera, playerPos);
 
@@ -253,76 +374,79 @@ bool VulkanRenderer::drawFrame(Camera &camera,
 
     updateDescriptorSets();
 
-    std::vector<std::pair<Chunk *, int>> opaqueChunks;
-    std::vector<std::pair<Chunk *, int>> transparentChunks;
-    std::vector<std::pair<Chunk *, int>> renderChunks;
-
-    if (showDebugOverlay && m_debugOverlay)
-    {
-
-        m_debugOverlay->update(*m_player, m_Settings, 0.f, m_terrainGen->getSeed());
-    }
+    glm::mat4 invView = glm::inverse(camera.getViewMatrix());
+    glm::vec3 camPos = glm::vec3(invView[3]);
 
-    renderChunks.reserve(chunks.size());
-    const Frustum &fr = camera.getFrustum();
-    for (auto &[pos, ch_ptr] : chunks)
+    FrameArena &arena = m_FrameArenas[slot];
+    std::pmr::vector<std::pair<Chunk *, int>> opaqueChunks(&arena);
+    std::pmr::vector<std::pair<Chunk *, int>> transparentChunks(&arena);
+    const std::pmr::vector<std::pair<Chunk *, int>> *opaqueList = &opaqueChunks;
+    const std::pmr::vector<std::pair<Chunk *, int>> *transparentList = &transparentChunks;
+    const std::pmr::vector<std::pair<Chunk *, int>> *rayTracedChunks = &opaqueChunks;
+    GpuCullFrame &cullFrame = m_GpuCullFrames[slot];
+
+    // GPU culling draws every resident mesh the compute pass lets through. The CPU path is the
+    // default, and the fallback when the device lacks multi-draw indirect; only it runs cave and
+    // occlusion culling.
+    const bool gpuCulling = m_Settings.gpuCulling && cullFrame.set != VK_NULL_HANDLE;
+    if (gpuCulling)
     {
-        ch_ptr->markReady(*this);
-        if (!fr.intersects(ch_ptr->getAABB()))
-            continue;
-
-        float d = glm::distance(glm::vec2(pos.x, pos.z), glm::vec2(playerChunkPos.x, playerChunkPos.z));
-        int req = (!m_Settings.lodDistances.empty() && d <= m_Settings.lodDistances[0]) ? 0 : 1;
-        int best = ch_ptr->getBestAvailableLOD(req);
-        if (best != -1)
+        m_DrawTable->update(chunks, chunkSetVersion, cullDataVersion, playerChunkPos);
+        if (cullFrame.tableVersion != m_DrawTable->getVersion())
         {
-            Chunk *ch = ch_ptr.get();
-
-            renderChunks.emplace_back(ch, best);
-
-            const ChunkMesh *opaqueMesh = ch->getMesh(best);
-            if (opaqueMesh && opaqueMesh->indexCount > 0)
-            {
-                opaqueChunks.emplace_back(ch, best);
-            }
-
-            const ChunkMesh *transparentMesh = ch->getTransparentMesh(best);
-            if (transparentMesh && transparentMesh->indexCount > 0)
-            {
-                transparentChunks.emplace_back(ch, best);
-            }
+            VC_PROFILE_ZONE("Upload GPU draw table");
+            const std::vector<GpuChunkDraw> &draws = m_DrawTable->getDraws();
+            reserveGpuCullFrame(slot, static_cast<uint32_t>(draws.size()));
+            if (!draws.empty())
+                memcpy(cullFrame.drawsMapped, draws.data(), draws.size() * sizeof(GpuChunkDraw));
+            cullFrame.tableVersion = m_DrawTable->getVersion();
         }
+        opaqueList = &m_DrawTable->getUnpooledOpaque();
+        transparentList = &m_DrawTable->getUnpooledTransparent();
+        rayTracedChunks = &m_DrawTable->getOpaqueChunks();
     }
-
-    std::vector<glm::mat4> modelMatrices;
-    modelMatrices.reserve(opaqueChunks.size() + transparentChunks.size());
-    for (const auto &p : opaqueChunks)
-    {
-        modelMatrices.push_back(p.first->getModelMatrix());
-    }
-    for (const auto &p : transparentChunks)
-    {
-        modelMatrices.push_back(p.first->getModelMatrix());
-    }
-
-    if (!modelMatrices.empty())
+    else
     {
-        memcpy(m_ModelMatrixSsbosMapped[slot], modelMatrices.data(), modelMatrices.size() * sizeof(glm::mat4));
+        m_Culler->cull(chunks, chunkSetVersion, cullDataVersion, camera.getFrustum(), camera.getViewProjectionMatrix(), camPos,
+                       playerChunkPos, opaqueChunks, transparentChunks);
     }
 
-    updateDescriptorSets();
-
     VkCommandBuffer cmd = m_CommandManager->getCommandBuffer(slot);
     vkResetCommandBuffer(cmd, 0);
     VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
     vkBeginCommandBuffer(cmd, &bi);
 
+    IndirectChunkDraws indirect;
+    if (gpuCulling)
+    {
+        indirect.commandBuffer = cullFrame.commands.get();
+        indirect.countBuffer = m_DeviceContext->isDrawIndirectCountSupported() ? cullFrame.count.get() : VK_NULL_HANDLE;
+        indirect.opaqueDraws = m_DrawTable->getOpaqueDrawCount();
+        indirect.transparentDraws = m_DrawTable->getTransparentDrawCount();
+
+        ChunkCullPushConstants pc{};
+        const auto &planes = camera.getFrustum().getPlanes();
+        for (size_t i = 0; i < planes.size(); ++i)
+            pc.planes[i] = glm::vec4(planes[i].normal, planes[i].distance);
+        pc.cameraPos = glm::vec4(camPos, 1.f);
+        pc.opaqueDraws = indirect.opaqueDraws;
+        pc.totalDraws = indirect.opaqueDraws + indirect.transparentDraws;
+        pc.compactOpaque = indirect.countBuffer != VK_NULL_HANDLE;
+
+        if (pc.totalDraws > 0)
+        {
+            VC_PROFILE_ZONE("Record GPU culling");
+            m_CommandManager->recordChunkCull(cmd, cullFrame.set, pc, cullFrame.commands.get(), cullFrame.count.get());
+        }
+    }
+
     if (m_DeviceContext->isRayTracingSupported() && (m_Settings.rayTracingFlags & SettingsEnums::SHADOWS))
     {
         try
         {
-            buildBlas(opaqueChunks, cmd);
-            buildTlasAsync(opaqueChunks, cmd, slot);
+            VC_PROFILE_ZONE("Ray tracing acceleration structures");
+            buildBlas(*rayTracedChunks, cmd);
+            buildTlasAsync(*rayTracedChunks, cmd, slot);
 
             if (m_tlas.handle != VK_NULL_HANDLE)
             {
@@ -369,9 +493,6 @@ bool VulkanRenderer::drawFrame(Camera &camera,
     float sun_angle = time_of_day * 2.0f * glm::pi<float>() - glm::half_pi<float>();
     float moon_angle = sun_angle + glm::pi<float>();
 
-    glm::mat4 invView = glm::inverse(camera.getViewMatrix());
-    glm::vec3 camPos = glm::vec3(invView[3]);
-
     glm::vec3 sunDir = glm::normalize(glm::vec3(sin(sun_angle), cos(sun_angle), 0.2f));
     glm::vec3 moonDir = glm::normalize(glm::vec3(sin(moon_angle), cos(moon_angle), 0.2f));
 
@@ -400,18 +521,18 @@ bool VulkanRenderer::drawFrame(Camera &camera,
     bool isSunVisible = sunDir.y > -0.1f;
     bool isMoonVisible = moonDir.y > -0.1f;
 
-    m_CommandManager->recordCommandBuffer(
-        imageIndex, slot, opaqueChunks, transparentChunks, m_DescriptorSets,
-        skyColor, sun_pc, moon_pc, isSunVisible, isMoonVisible,
-        m_SkySphereVertexBuffer.get(), m_SkySphereIndexBuffer.get(), m_SkySphereIndexCount,
-        m_CrosshairVertexBuffer.get(), m_CrosshairIndexBuffer.get(), m_CrosshairDescriptorSet,
-        m_DebugCubeVertexBuffer.get(), m_DebugCubeIndexBuffer.get(), m_DebugCubeIndexCount,
-        m_Settings, debugAABBs,
-        m_outlineVertexBuffer.get(), static_cast<uint32_t>(outlineVertices.size()), hoveredBlockPos);
-
-    if (showDebugOverlay && m_debugOverlay)
     {
-        m_debugOverlay->draw(cmd);
+        VC_PROFILE_ZONE("Record command buffer");
+        m_CommandManager->recordCommandBuffer(
+            imageIndex, slot, *opaqueList, *transparentList, camPos, m_DescriptorSets,
+            skyColor, sun_pc, moon_pc, isSunVisible, isMoonVisible,
+            m_SkySphereVertexBuffer.get(), m_SkySphereIndexBuffer.get(), m_SkySphereIndexCount,
+            m_CrosshairVertexBuffer.get(), m_CrosshairIndexBuffer.get(), m_CrosshairDescriptorSet,
+            m_DebugCubeVertexBuffer.get(), m_DebugCubeIndexBuffer.get(), m_DebugCubeIndexCount,
+            m_Settings, debugAABBs,
+            m_outlineVertexBuffer.get(), static_cast<uint32_t>(outlineVertices.size()), hoveredBlockPos,
+            *m_MeshPool, gpuCulling ? &indirect : nullptr,
+            showDebugOverlay ? m_debugOverlay.get() : nullptr);
     }
 
     vkEndCommandBuffer(cmd);
@@ -447,6 +568,7 @@ bool VulkanRenderer::drawFrame(Camera &camera,
     pi.pImageIndices = &imageIndex;
 
     {
+        VC_PROFILE_ZONE("Present");
         std::scoped_lock lk(gGraphicsQueueMutex);
         res = vkQueuePresentKHR(m_DeviceContext->getPresentQueue(), &pi);
     }
@@ -464,6 +586,14 @@ bool VulkanRenderer::drawFrame(Camera &camera,
     return true;
 }
 
+FrameArena &VulkanRenderer::beginFrameArena()
+{
+    FrameArena &arena = m_FrameArenas[m_CurrentFrame];
+    arena.reset();
+    m_FrameArenaStats = arena.getLastFrameStats();
+    return arena;
+}
+
 void VulkanRenderer::scheduleChunkGpuCleanup(std::shared_ptr<Chunk> chunk)
 {
     if (chunk)
@@ -472,6 +602,127 @@ void VulkanRenderer::scheduleChunkGpuCleanup(std::shared_ptr<Chunk> chunk)
     }
 }
 
+uint8_t *VulkanRenderer::reserveStaging(uint64_t vertexBytes, uint64_t indexBytes, StagedMesh &out)
+{
+    UploadJob job;
+    uint8_t *base = UploadHelpers::reserveChunkMesh(*m_StagingArena, vertexBytes, indexBytes, job);
+    if (!base)
+    {
+        if (vertexBytes != 0 && indexBytes != 0)
+            m_StagingRejects.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    out.vertexOffset = job.stagingVbOffset;
+    out.vertexBytes = job.stagingVbSize;
+    out.indexOffset = job.stagingIbOffset;
+    out.indexBytes = job.stagingIbSize;
+    return base;
+}
+
+std::unique_ptr<GpuMesh> VulkanRenderer::uploadMesh(const StagedMesh &staged)
+{
+    VC_PROFILE_ZONE("VulkanRenderer::uploadMesh");
+    auto mesh = std::make_unique<VulkanChunkMesh>();
+    mesh->generation = ++m_MeshGeneration;
+    UploadJob &job = mesh->upload;
+    job.stagingVB = m_StagingArena->getBuffer();
+    job.stagingVbOffset = staged.vertexOffset;
+    job.stagingVbSize = staged.vertexBytes;
+    job.stagingIB = m_StagingArena->getBuffer();
+    job.stagingIbOffset = staged.indexOffset;
+    job.stagingIbSize = staged.indexBytes;
+
+    if (!staged.empty() && m_MeshPool->allocate(staged.vertexBytes, staged.indexBytes, *mesh))
+        UploadHelpers::submitChunkMeshCopy(*m_DeviceContext, m_CommandManager->getCommandPool(), job,
+                                           m_MeshPool->getVertexBuffer(), m_MeshPool->vertexByteOffset(*mesh),
+                                           m_MeshPool->getIndexBuffer(), m_MeshPool->indexByteOffset(*mesh));
+    else
+        UploadHelpers::submitChunkMeshUpload(*m_DeviceContext, m_CommandManager->getCommandPool(), job,
+                                             mesh->vertexBuffer, mesh->indexBuffer);
+
+    if (job.cmdBuffer != VK_NULL_HANDLE)
+    {
+        VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        si.commandBufferCount = 1;
+        si.pCommandBuffers = &job.cmdBuffer;
+
+        VkResult result;
+        {
+            std::scoped_lock lk(gGraphicsQueueMutex);
+            result = vkQueueSubmit(m_DeviceContext->getGraphicsQueue(), 1, &si, job.fence);
+        }
+
+        if (result != VK_SUCCESS)
+        {
+            vkFreeCommandBuffers(getDevice(), m_CommandManager->getCommandPool(), 1, &job.cmdBuffer);
+            job.cmdBuffer = VK_NULL_HANDLE;
+            if (job.fence != VK_NULL_HANDLE)
+            {
+                vkDestroyFence(getDevice(), job.fence, nullptr);
+                job.fence = VK_NULL_HANDLE;
+            }
+
+            if (result == VK_ERROR_DEVICE_LOST)
+            {
+                throw std::runtime_error("Vulkan device lost during chunk mesh upload queue submit. This is often caused by an error in a previous frame's rendering commands.");
+            }
+
+            throw std::runtime_error("vkQueueSubmit failed in chunk mesh upload! Vulkan Error Code: " + std::to_string(result));
+        }
+
+        m_StagingInFlightBytes += job.stagingVbSize + job.stagingIbSize;
+        m_StagingPeakInFlightBytes = std::max(m_StagingPeakInFlightBytes, m_StagingInFlightBytes);
+    }
+
+    return mesh;
+}
+
+bool VulkanRenderer::isUploadComplete(GpuMesh &gpuMesh)
+{
+    UploadJob &job = static_cast<VulkanChunkMesh &>(gpuMesh).upload;
+    if (job.fence != VK_NULL_HANDLE)
+    {
+        if (vkGetFenceStatus(getDevice(), job.fence) != VK_SUCCESS)
+            return false;
+        vkDestroyFence(getDevice(), job.fence, nullptr);
+        job.fence = VK_NULL_HANDLE;
+        m_StagingInFlightBytes -= job.stagingVbSize + job.stagingIbSize;
+    }
+    if (job.cmdBuffer != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(getDevice(), m_CommandManager->getCommandPool(), 1, &job.cmdBuffer);
+        job.cmdBuffer = VK_NULL_HANDLE;
+    }
+    return true;
+}
+
+void VulkanRenderer::retireMesh(std::unique_ptr<GpuMesh> gpuMesh)
+{
+    auto &mesh = static_cast<VulkanChunkMesh &>(*gpuMesh);
+    if (mesh.upload.fence != VK_NULL_HANDLE)
+        vkWaitForFences(getDevice(), 1, &mesh.upload.fence, VK_TRUE, UINT64_MAX);
+    isUploadComplete(mesh);
+
+    m_MeshPool->retire(mesh, mesh.upload.stagingVbSize, mesh.upload.stagingIbSize, m_CurrentFrame);
+    if (mesh.vertexBuffer.get() != VK_NULL_HANDLE)
+        enqueueDestroy(std::move(mesh.vertexBuffer));
+    if (mesh.indexBuffer.get() != VK_NULL_HANDLE)
+        enqueueDestroy(std::move(mesh.indexBuffer));
+    if (mesh.blas.handle != VK_NULL_HANDLE)
+        enqueueDestroy(std::move(mesh.blas));
+}
+
+StagingStats VulkanRenderer::getStagingStats()
+{
+    StagingStats s;
+    s.capacityBytes = m_StagingArena->getSize();
+    s.inFlightBytes = m_StagingInFlightBytes;
+    s.peakInFlightBytes = m_StagingPeakInFlightBytes;
+    s.rejectedAllocations = m_StagingRejects.load(std::memory_order_relaxed);
+    return s;
+}
+
 void VulkanRenderer::recreateRayTracingShadowImage()
 {
     if (!m_DeviceContext->isRayTracingSupported())
@@ -479,6 +730,7 @@ void VulkanRenderer::recreateRayTracingShadowImage()
 
     vkDeviceWaitIdle(m_DeviceContext->getDevice());
 
+    ++m_DescriptorRevision;
     m_rtShadowImageView = {};
     m_rtShadowImage = {};
     m_rtDescriptorSets.clear();
@@ -687,14 +939,15 @@ void VulkanRenderer::updateRtDescriptorSet(uint32_t frame)
                            static_cast<uint32_t>(w.size()), w.data(), 0, nullptr);
 }
 
-void VulkanRenderer::buildBlas(const std::vector<std::pair<Chunk *, int>> &chunksToBuild, VkCommandBuffer cmd)
+void VulkanRenderer::buildBlas(const std::pmr::vector<std::pair<Chunk *, int>> &chunksToBuild, VkCommandBuffer cmd)
 {
     if (!m_rtFunctionsLoaded || cmd == VK_NULL_HANDLE)
     {
         return;
     }
 
-    std::vector<std::pair<Chunk *, int>> dirty;
+    FrameArena &arena = m_FrameArenas[m_CurrentFrame];
+    std::pmr::vector<std::pair<Chunk *, int>> dirty(&arena);
     dirty.reserve(chunksToBuild.size());
     for (const auto &p : chunksToBuild)
     {
@@ -717,11 +970,11 @@ void VulkanRenderer::buildBlas(const std::vector<std::pair<Chunk *, int>> &chunk
         dirty.resize(MAX_BLAS_PER_FRAME);
     }
 
-    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> buildInfos;
-    std::vector<VkAccelerationStructureGeometryKHR> geometries;
-    std::vector<VkAccelerationStructureGeometryTrianglesDataKHR> triangles;
-    std::vector<uint32_t> triangleCounts;
-    std::vector<ChunkMesh *> targetMeshes;
+    std::pmr::vector<VkAccelerationStructureBuildGeometryInfoKHR> buildInfos(&arena);
+    std::pmr::vector<VkAccelerationStructureGeometryKHR> geometries(&arena);
+    std::pmr::vector<VkAccelerationStructureGeometryTrianglesDataKHR> triangles(&arena);
+    std::pmr::vector<uint32_t> triangleCounts(&arena);
+    std::pmr::vector<VulkanChunkMesh *> targetMeshes(&arena);
 
     buildInfos.reserve(dirty.size());
     geometries.reserve(dirty.size());
@@ -735,17 +988,33 @@ void VulkanRenderer::buildBlas(const std::vector<std::pair<Chunk *, int>> &chunk
         int lod = p.second;
         ChunkMesh *mesh = chunk->getMesh(lod);
 
-        if (!mesh || mesh->indexCount == 0 || mesh->vertexCount == 0 || mesh->vertexBuffer.get() == VK_NULL_HANDLE || mesh->indexBuffer.get() == VK_NULL_HANDLE)
+        if (!mesh || mesh->indexCount == 0 || mesh->vertexCount == 0 || !mesh->gpu)
         {
             chunk->m_blas_dirty.store(false, std::memory_order_release);
             continue;
         }
 
-        if (mesh->blas.handle != VK_NULL_HANDLE)
-            enqueueDestroy(std::move(mesh->blas));
+        VulkanChunkMesh &gpu = vulkanMesh(*mesh);
+        if (!gpu.pooled && (gpu.vertexBuffer.get() == VK_NULL_HANDLE || gpu.indexBuffer.get() == VK_NULL_HANDLE))
+        {
+            chunk->m_blas_dirty.store(false, std::memory_order_release);
+            continue;
+        }
+
+        if (gpu.blas.handle != VK_NULL_HANDLE)
+            enqueueDestroy(std::move(gpu.blas));
 
-        VkDeviceAddress vAddr = getBufferDeviceAddress(mesh->vertexBuffer.get());
-        VkDeviceAddress iAddr = getBufferDeviceAddress(mesh->indexBuffer.get());
+        VkDeviceAddress vAddr, iAddr;
+        if (gpu.pooled)
+        {
+            vAddr = getBufferDeviceAddress(m_MeshPool->getVertexBuffer()) + m_MeshPool->vertexByteOffset(gpu);
+            iAddr = getBufferDeviceAddress(m_MeshPool->getIndexBuffer()) + m_MeshPool->indexByteOffset(gpu);
+        }
+        else
+        {
+            vAddr = getBufferDeviceAddress(gpu.vertexBuffer.get());
+            iAddr = getBufferDeviceAddress(gpu.indexBuffer.get());
+        }
 
         if (vAddr == 0 || iAddr == 0)
         {
@@ -782,15 +1051,15 @@ void VulkanRenderer::buildBlas(const std::vector<std::pair<Chunk *, int>> &chunk
                               {}});
 
         triangleCounts.push_back(mesh->indexCount / 3);
-        targetMeshes.push_back(mesh);
+        targetMeshes.push_back(&gpu);
     }
 
     if (buildInfos.empty())
         return;
 
-    std::vector<VkAccelerationStructureBuildSizesInfoKHR> sizeInfos(buildInfos.size(), {VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR});
-    std::vector<const VkAccelerationStructureBuildRangeInfoKHR *> rangesPtrs(buildInfos.size());
-    std::vector<VkAccelerationStructureBuildRangeInfoKHR> ranges(buildInfos.size());
+    std::pmr::vector<VkAccelerationStructureBuildSizesInfoKHR> sizeInfos(buildInfos.size(), {VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR}, &arena);
+    std::pmr::vector<const VkAccelerationStructureBuildRangeInfoKHR *> rangesPtrs(buildInfos.size(), &arena);
+    std::pmr::vector<VkAccelerationStructureBuildRangeInfoKHR> ranges(buildInfos.size(), &arena);
 
     for (size_t i = 0; i < buildInfos.size(); ++i)
     {
@@ -839,7 +1108,7 @@ void VulkanRenderer::buildBlas(const std::vector<std::pair<Chunk *, int>> &chunk
         p.first->m_blas_dirty.store(false, std::memory_order_release);
 }
 
-void VulkanRenderer::buildTlasAsync(const std::vector<std::pair<Chunk *, int>> &drawList,
+void VulkanRenderer::buildTlasAsync(const std::pmr::vector<std::pair<Chunk *, int>> &drawList,
                                     VkCommandBuffer cmd, uint32_t frame)
 {
     if (!m_rtFunctionsLoaded || !m_DeviceContext->isRayTracingSupported() || cmd == VK_NULL_HANDLE)
@@ -852,7 +1121,7 @@ void VulkanRenderer::buildTlasAsync(const std::vector<std::pair<Chunk *, int>> &
 
     try
     {
-        std::vector<VkAccelerationStructureInstanceKHR> instances;
+        std::pmr::vector<VkAccelerationStructureInstanceKHR> instances(&m_FrameArenas[frame]);
 
         instances.reserve(drawList.size());
 
@@ -862,7 +1131,7 @@ void VulkanRenderer::buildTlasAsync(const std::vector<std::pair<Chunk *, int>> &
 
             const ChunkMesh *m = c->getMesh(p.second);
 
-            if (!m || m->blas.handle == VK_NULL_HANDLE || c->m_blas_dirty.load(std::memory_order_acquire))
+            if (!m || !m->gpu || vulkanMesh(*m).blas.handle == VK_NULL_HANDLE || c->m_blas_dirty.load(std::memory_order_acquire))
                 continue;
 
             VkAccelerationStructureInstanceKHR inst{};
@@ -870,7 +1139,7 @@ void VulkanRenderer::buildTlasAsync(const std::vector<std::pair<Chunk *, int>> &
             memcpy(&inst.transform, &tr, sizeof(inst.transform));
             inst.mask = 0xFF;
             inst.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
-            inst.accelerationStructureReference = m->blas.deviceAddress;
+            inst.accelerationStructureReference = vulkanMesh(*m).blas.deviceAddress;
             instances.push_back(inst);
         }
 
@@ -1264,8 +1533,15 @@ void VulkanRenderer::createDescriptorSets()
         throw std::runtime_error("failed to allocate descriptor sets");
 }
 
+// Writes the frame slot's descriptor set only when its contents changed: updating a set also
+// invalidates every command buffer it is bound in, including cached chunk secondaries.
 void VulkanRenderer::updateDescriptorSets()
 {
+    if (m_DescriptorSetRevisions[m_CurrentFrame] == m_DescriptorRevision)
+        return;
+    m_DescriptorSetRevisions[m_CurrentFrame] = m_DescriptorRevision;
+    m_CommandManager->invalidateSecondaries();
+
     VkDescriptorBufferInfo mainUboInfo{m_UniformBuffers[m_CurrentFrame].get(), 0, sizeof(UniformBufferObject)};
     VkDescriptorImageInfo atlasInfo{m_TextureManager->getTextureSampler(), m_TextureManager->getTextureImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
     VkDescriptorImageInfo sunInfo{m_TextureManager->getTextureSampler(), m_SunTextureView.get(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
@@ -1287,7 +1563,7 @@ void VulkanRenderer::updateDescriptorSets()
 
     std::array<VkWriteDescriptorSet, 7> writes{};
 
-    VkDescriptorBufferInfo modelMatrixInfo{m_ModelMatrixSsbos[m_CurrentFrame].get(), 0, VK_WHOLE_SIZE};
+    VkDescriptorBufferInfo chunkOriginInfo{m_ChunkOrigins->getBuffer(), 0, VK_WHOLE_SIZE};
 
     writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     writes[0].dstSet = m_DescriptorSets[m_CurrentFrame];
@@ -1336,7 +1612,7 @@ void VulkanRenderer::updateDescriptorSets()
     writes[6].dstBinding = 6;
     writes[6].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     writes[6].descriptorCount = 1;
-    writes[6].pBufferInfo = &modelMatrixInfo;
+    writes[6].pBufferInfo = &chunkOriginInfo;
 
     vkUpdateDescriptorSets(m_DeviceContext->getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
 }
@@ -5,6 +5,7 @@
 #include "Camera.h"
 #include "UploadJob.h"
 #include "Chunk.h"
+#include "RenderBackend.h"
 #include "Globals.h"
 #include "renderer/Vertex.h"
 #include "renderer/core/InstanceContext.h"
@@ -17,41 +18,62 @@
 #include "renderer/resources/TextureManager.h"
 #include "renderer/resources/RingStagingArena.h"
 #include "renderer/resources/UploadHelpers.h"
+#include "renderer/resources/ChunkMeshPool.h"
+#include "renderer/resources/ChunkOriginTable.h"
 #include "renderer/RendererConfig.h"
 #include "math/Ivec3Less.h"
 #include "renderer/DebugOverlay.h"
 #include "renderer/RayTracingPushConstants.h"
+#include "renderer/VulkanChunkMesh.h"
+#include "FrameArena.h"
+#include "ChunkCuller.h"
+#include "GpuDrawTable.h"
 
+#include <array>
+#include <atomic>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <glm/glm.hpp>
 #include <optional>
 
 class Player;
-class TerrainGenerator;
 
-const int MAX_CHUNKS_PER_FRAME = 4096;
-
-class VulkanRenderer
+class VulkanRenderer : public RenderBackend
 {
 public:
-    VulkanRenderer(Window &window, Settings &settings, Player *player, TerrainGenerator *terrainGen);
-    ~VulkanRenderer();
+    VulkanRenderer(Window &window, Settings &settings, Player *player);
+    ~VulkanRenderer() override;
     VulkanRenderer(const VulkanRenderer &) = delete;
     VulkanRenderer &operator=(const VulkanRenderer &) = delete;
 
     bool drawFrame(Camera &camera,
                    const glm::vec3 &playerPos,
                    std::map<glm::ivec3, std::shared_ptr<Chunk>, ivec3_less> &chunks,
+                   uint64_t chunkSetVersion,
+                   uint64_t cullDataVersion,
                    const glm::ivec3 &playerChunkPos,
                    uint32_t gameTicks,
-                   const std::vector<AABB> &debugAABBs,
+                   const std::pmr::vector<AABB> &debugAABBs,
                    bool showDebugOverlay,
-                   const std::vector<glm::vec3> &outlineVertices,
+                   const std::pmr::vector<glm::vec3> &outlineVertices,
                    const std::optional<glm::ivec3> &hoveredBlockPos);
 
-    void scheduleChunkGpuCleanup(std::shared_ptr<Chunk> chunk);
+    uint8_t *reserveStaging(uint64_t vertexBytes, uint64_t indexBytes, StagedMesh &out) override;
+    std::unique_ptr<GpuMesh> uploadMesh(const StagedMesh &staged) override;
+    bool isUploadComplete(GpuMesh &mesh) override;
+    void retireMesh(std::unique_ptr<GpuMesh> mesh) override;
+    void scheduleChunkGpuCleanup(std::shared_ptr<Chunk> chunk) override;
+    StagingStats getStagingStats() override;
+
+    // Rewinds and returns the arena of the frame about to be recorded. Everything built for
+    // that frame, by the engine and by drawFrame, allocates from it.
+    FrameArena &beginFrameArena();
+    const FrameArena::Stats &getFrameArenaStats() const { return m_FrameArenaStats; }
+
+    // Time the last drawFrame spent blocked on the frame fence and swapchain acquire.
+    double getLastFrameWaitSeconds() const { return m_LastFrameWaitSeconds; }
 
     void enqueueDestroy(VmaBuffer &&buffer);
     void enqueueDestroy(VmaImage &&image);
@@ -69,8 +91,8 @@ public:
 private:
     glm::vec3 updateUniformBuffer(uint32_t currentImage, Camera &camera, const glm::vec3 &playerPos);
     void updateLightUbo(uint32_t currentImage, uint32_t gameTicks);
-    void buildBlas(const std::vector<std::pair<Chunk *, int>> &chunksToBuild, VkCommandBuffer cmd);
-    void buildTlasAsync(const std::vector<std::pair<Chunk *, int>> &drawList, VkCommandBuffer cmd, uint32_t frame);
+    void buildBlas(const std::pmr::vector<std::pair<Chunk *, int>> &chunksToBuild, VkCommandBuffer cmd);
+    void buildTlasAsync(const std::pmr::vector<std::pair<Chunk *, int>> &drawList, VkCommandBuffer cmd, uint32_t frame);
     void createRayTracingResources();
     void recreateRayTracingShadowImage();
     void createShaderBindingTable();
@@ -85,7 +107,8 @@ private:
     void createOutlineVertexBuffer();
     void createCrosshairResources();
     void recreateCrosshairVertexBuffer();
-    void createModelMatrixSsbos();
+    void createGpuCullResources();
+    void reserveGpuCullFrame(uint32_t frame, uint32_t draws);
     void createDebugCubeMesh();
     void loadRayTracingFunctions();
     VkDeviceAddress getBufferDeviceAddress(VkBuffer buffer);
@@ -99,7 +122,6 @@ private:
     Window &m_Window;
     Settings &m_Settings;
     Player *m_player;
-    TerrainGenerator *m_terrainGen;
 
     std::unique_ptr<InstanceContext> m_InstanceContext;
     std::unique_ptr<DeviceContext> m_DeviceContext;
@@ -110,6 +132,11 @@ private:
     std::unique_ptr<SyncPrimitives> m_SyncPrimitives;
     std::unique_ptr<TextureManager> m_TextureManager;
     std::unique_ptr<RingStagingArena> m_StagingArena;
+    std::unique_ptr<ChunkCuller> m_Culler;
+    std::unique_ptr<ChunkMeshPool> m_MeshPool;
+    std::unique_ptr<ChunkOriginTable> m_ChunkOrigins;
+    uint64_t m_OriginsChunkSetVersion = ~0ull;
+    std::unique_ptr<GpuDrawTable> m_DrawTable;
     std::vector<VmaBuffer> m_blasBuildScratchBuffers[MAX_FRAMES_IN_FLIGHT];
     std::vector<VkDescriptorSet> m_rtDescriptorSets;
 
@@ -150,11 +177,26 @@ private:
     std::vector<VmaBuffer> m_LightUbos;
     std::vector<void *> m_LightUbosMapped;
 
-    std::vector<VmaBuffer> m_ModelMatrixSsbos;
-    std::vector<void *> m_ModelMatrixSsbosMapped;
+    // Input and output of chunk_cull.comp per frame slot. tableVersion is the GpuDrawTable
+    // version the slot's draws hold.
+    struct GpuCullFrame
+    {
+        VmaBuffer draws;
+        void *drawsMapped = nullptr;
+        VmaBuffer commands;
+        VmaBuffer count;
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        uint32_t capacity = 0;
+        uint64_t tableVersion = 0;
+    };
+    std::array<GpuCullFrame, MAX_FRAMES_IN_FLIGHT> m_GpuCullFrames;
+    VulkanHandle<VkDescriptorPool, DescriptorPoolDeleter> m_CullDescriptorPool;
 
     VulkanHandle<VkDescriptorPool, DescriptorPoolDeleter> m_DescriptorPool;
     std::vector<VkDescriptorSet> m_DescriptorSets;
+    // Bumped whenever a resource the descriptor sets point at is replaced.
+    uint64_t m_DescriptorRevision = 1;
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_DescriptorSetRevisions{};
 
     VmaBuffer m_SkySphereVertexBuffer;
     VmaBuffer m_SkySphereIndexBuffer;
@@ -177,6 +219,14 @@ private:
     std::vector<VmaImage> m_ImageDestroyQueue[MAX_FRAMES_IN_FLIGHT];
     std::vector<VmaBuffer> m_asBuildStagingBuffers[MAX_FRAMES_IN_FLIGHT];
     std::vector<std::shared_ptr<Chunk>> m_ChunkCleanupQueue[MAX_FRAMES_IN_FLIGHT];
+
+    std::atomic<uint64_t> m_StagingRejects{0};
+    uint64_t m_StagingInFlightBytes = 0;
+    uint64_t m_StagingPeakInFlightBytes = 0;
+    uint64_t m_MeshGeneration = 0;
+    double m_LastFrameWaitSeconds = 0.0;
+    std::array<FrameArena, MAX_FRAMES_IN_FLIGHT> m_FrameArenas;
+    FrameArena::Stats m_FrameArenaStats;
     std::vector<AccelerationStructure> m_AsDestroyQueue[MAX_FRAMES_IN_FLIGHT];
 
     VmaImage m_CrosshairTexture;
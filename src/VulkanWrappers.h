@@ -141,6 +141,15 @@ struct SamplerDeleter
             vkDestroySampler(device, s, nullptr);
     }
 };
+struct PipelineCacheDeleter
+{
+    VkDevice device;
+    void operator()(VkPipelineCache c) const
+    {
+        if (c)
+            vkDestroyPipelineCache(device, c, nullptr);
+    }
+};
 struct ShaderModuleDeleter
 {
     VkDevice device;
@@ -0,0 +1,542 @@
+#include "World.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <stdexcept>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/norm.hpp>
+
+using hrc = std::chrono::high_resolution_clock;
+using milli = std::chrono::duration<double, std::milli>;
+
+World::World(Settings &settings, RenderBackend &backend)
+    : m_Settings(settings),
+      m_Backend(backend),
+      m_TerrainGen(settings.worldSeed),
+      m_RegionStore(m_Settings.worldDirectory),
+      m_ChunkSaver(m_RegionStore, static_cast<size_t>(m_Settings.saveQueueBudgetMB) * 1024 * 1024,
+                   std::chrono::milliseconds(m_Settings.saveSyncIntervalMs)),
+      m_Scheduler(m_Settings, m_Pool.size())
+{
+    if (m_Settings.persistenceMode == SettingsEnums::PersistenceMode::EDIT_LOG)
+        m_EditLog = std::make_unique<EditLog>(std::filesystem::path(m_Settings.worldDirectory) / "edits.vclog");
+    if (m_Settings.meshCache)
+        m_MeshCache = std::make_unique<MeshCache>(std::filesystem::path(m_Settings.worldDirectory) / "meshcache");
+
+    m_MetricsStart = m_LastMetricsDump = std::chrono::steady_clock::now();
+    if (!m_Settings.pipelineMetricsFile.empty())
+    {
+        m_MetricsFile.open(m_Settings.pipelineMetricsFile, std::ios::app);
+        if (!m_MetricsFile)
+            throw std::runtime_error("World: failed to open pipeline metrics file " + m_Settings.pipelineMetricsFile);
+    }
+}
+
+World::~World()
+{
+    m_Pool.shutdown();
+
+    for (auto &[pos, chunk] : m_Chunks)
+        saveChunk(*chunk, true);
+    for (auto &chunk : m_Garbage)
+        saveChunk(*chunk, true);
+    m_ChunkSaver.flush();
+    if (m_EditLog)
+        m_EditLog->flush();
+}
+
+Block World::get_block(int x, int y, int z)
+{
+    if (y < 0 || y >= Chunk::HEIGHT)
+    {
+        return {BlockId::AIR};
+    }
+
+    int chunk_x = static_cast<int>(floor(static_cast<float>(x) / Chunk::WIDTH));
+    int chunk_z = static_cast<int>(floor(static_cast<float>(z) / Chunk::DEPTH));
+
+    auto it = m_Chunks.find({chunk_x, 0, chunk_z});
+    if (it != m_Chunks.end() && it->second->getState() >= Chunk::State::TERRAIN_READY)
+    {
+        int local_x = x - chunk_x * Chunk::WIDTH;
+        int local_z = z - chunk_z * Chunk::DEPTH;
+        return it->second->getBlock(local_x, y, local_z);
+    }
+
+    return {BlockId::AIR};
+}
+
+void World::set_block(int x, int y, int z, BlockId id)
+{
+    if (y < 0 || y >= Chunk::HEIGHT)
+        return;
+
+    auto set_chunk_dirty = [&](int block_x, int block_z)
+    {
+        int chunk_x = static_cast<int>(floor(static_cast<float>(block_x) / Chunk::WIDTH));
+        int chunk_z = static_cast<int>(floor(static_cast<float>(block_z) / Chunk::DEPTH));
+        auto it = m_Chunks.find({chunk_x, 0, chunk_z});
+        if (it != m_Chunks.end())
+        {
+            int local_x = block_x - chunk_x * Chunk::WIDTH;
+            int local_z = block_z - chunk_z * Chunk::DEPTH;
+            it->second->setBlock(local_x, y, local_z, {id});
+            if (m_EditLog)
+                m_EditLog->record({chunk_x, 0, chunk_z}, local_x, y, local_z, id);
+            saveChunk(*it->second);
+        }
+    };
+
+    set_chunk_dirty(x, z);
+
+    int local_x = x % Chunk::WIDTH;
+    if (local_x < 0)
+        local_x += Chunk::WIDTH;
+    int local_z = z % Chunk::DEPTH;
+    if (local_z < 0)
+        local_z += Chunk::DEPTH;
+
+    auto mark_neighbor_dirty = [&](int nx, int nz)
+    {
+        int chunk_x = static_cast<int>(floor(static_cast<float>(nx) / Chunk::WIDTH));
+        int chunk_z = static_cast<int>(floor(static_cast<float>(nz) / Chunk::DEPTH));
+        auto it = m_Chunks.find({chunk_x, 0, chunk_z});
+
+        if (it != m_Chunks.end())
+        {
+            it->second->m_is_dirty.store(true);
+        }
+    };
+
+    if (local_x == 0)
+        mark_neighbor_dirty(x - 1, z);
+    if (local_x == Chunk::WIDTH - 1)
+        mark_neighbor_dirty(x + 1, z);
+    if (local_z == 0)
+        mark_neighbor_dirty(x, z - 1);
+    if (local_z == Chunk::DEPTH - 1)
+        mark_neighbor_dirty(x, z + 1);
+}
+
+void World::updateChunks(const glm::vec3 &cam_pos, double frameWorkSeconds)
+{
+    glm::ivec3 playerChunkPos{
+        static_cast<int>(std::floor(cam_pos.x / Chunk::WIDTH)), 0,
+        static_cast<int>(std::floor(cam_pos.z / Chunk::DEPTH))};
+
+    VC_PROFILE_ZONE("World::updateChunks");
+    m_Scheduler.beginFrame(frameWorkSeconds);
+
+    // Budgeted stages run in order of how soon their result reaches the screen.
+    auto t0 = hrc::now();
+    unloadDistantChunks(playerChunkPos);
+    auto t1 = hrc::now();
+    createMeshJobs(playerChunkPos);
+    auto t2 = hrc::now();
+    uploadReadyMeshes();
+    auto t3 = hrc::now();
+    submitMeshJobs(playerChunkPos);
+    auto t4 = hrc::now();
+    loadVisibleChunks(playerChunkPos);
+    auto t5 = hrc::now();
+    processGarbage();
+    auto t6 = hrc::now();
+
+    m_Scheduler.endFrame();
+
+    m_LastTimings.unloadMs = milli(t1 - t0).count();
+    m_LastTimings.createJobsMs = milli(t2 - t1).count();
+    m_LastTimings.uploadMs = milli(t3 - t2).count();
+    m_LastTimings.submitJobsMs = milli(t4 - t3).count();
+    m_LastTimings.loadMs = milli(t5 - t4).count();
+    m_LastTimings.garbageMs = milli(t6 - t5).count();
+
+    if (m_MetricsFile.is_open())
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_LastMetricsDump >= std::chrono::milliseconds(m_Settings.pipelineMetricsIntervalMs))
+        {
+            m_LastMetricsDump = now;
+            dumpPipelineMetrics();
+        }
+    }
+}
+
+World::Counters World::getCounters() const
+{
+    Counters c;
+    c.generated = m_ChunksGenerated.load(std::memory_order_relaxed);
+    c.meshed = m_ChunksMeshed.load(std::memory_order_relaxed);
+    c.uploaded = m_ChunksUploaded;
+    return c;
+}
+
+PipelineStats World::getPipelineStats()
+{
+    PipelineStats s;
+    s.fillStages(m_Metrics);
+    s.chunksLoaded = m_Chunks.size();
+    for (auto &[pos, chunk] : m_Chunks)
+    {
+        switch (chunk->getState())
+        {
+        case Chunk::State::INITIAL:
+            ++s.awaitingTerrain;
+            break;
+        case Chunk::State::STAGING_READY:
+            ++s.awaitingUpload;
+            break;
+        case Chunk::State::UPLOADING:
+            ++s.uploading;
+            break;
+        default:
+            break;
+        }
+    }
+    s.workerQueue = m_Pool.pending();
+    {
+        std::scoped_lock lock(m_MeshJobsMutex);
+        s.meshJobsQueued = m_MeshJobsToCreate.size();
+        s.meshJobsInFlight = m_MeshJobsInProgress.size();
+    }
+    s.garbage = m_Garbage.size();
+    s.staging = m_Backend.getStagingStats();
+
+    const StreamingScheduler::Stats &sched = m_Scheduler.getStats();
+    s.streamingBudgetMs = sched.budgetMs;
+    s.streamingSpentMs = sched.spentMs;
+    s.meshJobLimit = sched.meshJobLimit;
+    s.meshJobsPerSecond = sched.meshJobsPerSecond;
+    return s;
+}
+
+void World::dumpPipelineMetrics()
+{
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_MetricsStart).count();
+    m_MetricsFile << getPipelineStats().toJson(t) << '\n';
+    m_MetricsFile.flush();
+}
+
+void World::unloadDistantChunks(const glm::ivec3 &playerChunkPos)
+{
+    VC_PROFILE_ZONE("World::unloadDistantChunks");
+    std::vector<glm::ivec3> chunksToUnload;
+    for (auto &[pos, chunk] : m_Chunks)
+    {
+        if (std::max(std::abs(pos.x - playerChunkPos.x), std::abs(pos.z - playerChunkPos.z)) > m_Settings.renderDistance)
+        {
+            chunksToUnload.push_back(pos);
+        }
+    }
+
+    for (auto &pos : chunksToUnload)
+    {
+        m_Garbage.push_back(std::move(m_Chunks.at(pos)));
+        m_Chunks.erase(pos);
+        ++m_ChunkSetVersion;
+    }
+}
+
+void World::processGarbage()
+{
+    VC_PROFILE_ZONE("World::processGarbage");
+    if (m_Garbage.empty())
+        return;
+
+    m_Garbage.erase(
+        std::remove_if(m_Garbage.begin(), m_Garbage.end(),
+                       [this](const std::shared_ptr<Chunk> &chunk)
+                       {
+                           if (chunk.use_count() != 1)
+                               return false;
+
+                           bool retired = false;
+                           m_Scheduler.run(StreamingScheduler::Op::RETIRE_CHUNK, [&]
+                                           {
+                               if (!saveChunk(*chunk))
+                                   return;
+                               m_Backend.scheduleChunkGpuCleanup(chunk);
+                               retired = true; });
+                           return retired;
+                       }),
+        m_Garbage.end());
+}
+
+void World::loadVisibleChunks(const glm::ivec3 &playerChunkPos)
+{
+    VC_PROFILE_ZONE("World::loadVisibleChunks");
+    std::vector<glm::ivec3> chunk_positions_to_load;
+
+    for (int z = -m_Settings.renderDistance; z <= m_Settings.renderDistance; ++z)
+    {
+        for (int x = -m_Settings.renderDistance; x <= m_Settings.renderDistance; ++x)
+        {
+            glm::ivec3 chunkPos = playerChunkPos + glm::ivec3(x, 0, z);
+            if (!m_Chunks.count(chunkPos))
+            {
+                chunk_positions_to_load.push_back(chunkPos);
+            }
+        }
+    }
+
+    glm::vec2 player_pos_2d(playerChunkPos.x, playerChunkPos.z);
+    std::sort(chunk_positions_to_load.begin(), chunk_positions_to_load.end(),
+              [&](const glm::ivec3 &a, const glm::ivec3 &b)
+              {
+                  float dist_a = glm::distance2(glm::vec2(a.x, a.z), player_pos_2d);
+                  float dist_b = glm::distance2(glm::vec2(b.x, b.z), player_pos_2d);
+                  return dist_a < dist_b;
+              });
+
+    for (const auto &pos : chunk_positions_to_load)
+    {
+        if (!m_Scheduler.run(StreamingScheduler::Op::CREATE_CHUNK, [&]
+                             { createChunkContainer(pos); }))
+            break;
+    }
+}
+
+void World::createMeshJobs(const glm::ivec3 &playerChunkPos)
+{
+    VC_PROFILE_ZONE("World::createMeshJobs");
+    std::vector<std::pair<glm::ivec3, int>> pending;
+
+    for (int z = -m_Settings.renderDistance; z <= m_Settings.renderDistance; ++z)
+    {
+        for (int x = -m_Settings.renderDistance; x <= m_Settings.renderDistance; ++x)
+        {
+            glm::ivec3 pos = playerChunkPos + glm::ivec3(x, 0, z);
+            auto it = m_Chunks.find(pos);
+            if (it == m_Chunks.end())
+                continue;
+
+            Chunk *ch = it->second.get();
+            if (ch->getState() == Chunk::State::INITIAL)
+                continue;
+
+            float dist = glm::distance(glm::vec2(x, z), glm::vec2(0.f));
+            int reqLod = (!m_Settings.lodDistances.empty() && dist <= m_Settings.lodDistances[0]) ? 0 : 1;
+
+            bool is_dirty = ch->m_is_dirty.load(std::memory_order_acquire);
+            bool blas_is_dirty = ch->m_blas_dirty.load(std::memory_order_acquire);
+
+            if (!ch->hasLOD(reqLod) || is_dirty)
+            {
+                pending.emplace_back(pos, reqLod);
+
+                if (ch->hasLOD(reqLod))
+                {
+                    ch->m_blas_dirty.store(true, std::memory_order_release);
+                }
+            }
+
+            if (is_dirty && !ch->hasLOD(1 - reqLod))
+            {
+                pending.emplace_back(pos, 1 - reqLod);
+            }
+        }
+    }
+
+    std::lock_guard lock(m_MeshJobsMutex);
+    for (auto &job : pending)
+    {
+        if (!m_MeshJobsInProgress.count(job) && !m_MeshJobsToCreate.count(job))
+        {
+            m_MeshJobsToCreate.insert(job);
+
+            auto it = m_Chunks.find(job.first);
+            if (it != m_Chunks.end())
+            {
+                it->second->m_is_dirty.store(false, std::memory_order_release);
+                if (it->second->hasLOD(job.second))
+                    m_Metrics.remeshes.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void World::submitMeshJobs(const glm::ivec3 &playerChunkPos)
+{
+    VC_PROFILE_ZONE("World::submitMeshJobs");
+    const int dynCap = m_Scheduler.meshJobLimit();
+
+    std::scoped_lock lock(m_MeshJobsMutex);
+    if (m_MeshJobsToCreate.empty() || static_cast<int>(m_MeshJobsInProgress.size()) >= dynCap)
+    {
+        return;
+    }
+
+    glm::vec2 player_chunk_pos_2d(playerChunkPos.x, playerChunkPos.z);
+
+    std::vector<std::pair<glm::ivec3, int>> sorted_jobs;
+    sorted_jobs.assign(m_MeshJobsToCreate.begin(), m_MeshJobsToCreate.end());
+
+    std::sort(sorted_jobs.begin(), sorted_jobs.end(),
+              [&](const auto &a, const auto &b)
+              {
+                  if (a.second != b.second)
+                  {
+                      return a.second < b.second;
+                  }
+
+                  float dist_a = glm::distance2(glm::vec2(a.first.x, a.first.z), player_chunk_pos_2d);
+                  float dist_b = glm::distance2(glm::vec2(b.first.x, b.first.z), player_chunk_pos_2d);
+                  return dist_a < dist_b;
+              });
+
+    int slots_to_fill = dynCap - static_cast<int>(m_MeshJobsInProgress.size());
+    for (int i = 0; i < slots_to_fill && i < sorted_jobs.size(); ++i)
+    {
+        if (!m_Scheduler.admit(StreamingScheduler::Op::SUBMIT_MESH_JOB))
+            break;
+        const auto opStart = std::chrono::steady_clock::now();
+        auto &job = sorted_jobs[i];
+
+        m_MeshJobsToCreate.erase(job);
+        m_MeshJobsInProgress.insert(job);
+
+        auto it = m_Chunks.find(job.first);
+        if (it == m_Chunks.end())
+        {
+            m_MeshJobsInProgress.erase(job);
+            continue;
+        }
+
+        ChunkMeshInput in;
+        in.selfChunk = it->second;
+        glm::ivec3 p = it->second->getPos();
+
+        glm::ivec3 off[8] = {{p.x - 1, 0, p.z}, {p.x + 1, 0, p.z}, {p.x, 0, p.z - 1}, {p.x, 0, p.z + 1}, {p.x - 1, 0, p.z - 1}, {p.x + 1, 0, p.z - 1}, {p.x - 1, 0, p.z + 1}, {p.x + 1, 0, p.z + 1}};
+        for (int j = 0; j < 8; ++j)
+        {
+            auto n = m_Chunks.find(off[j]);
+            if (n != m_Chunks.end() && n->second->getState() >= Chunk::State::TERRAIN_READY)
+                in.neighborChunks[j] = n->second;
+        }
+
+        m_Pool.submit(
+            [this, job, in = std::move(in)](std::stop_token st) mutable
+            {
+                if (st.stop_requested())
+                {
+                    std::lock_guard lk(m_MeshJobsMutex);
+                    m_MeshJobsInProgress.erase(job);
+                    return;
+                }
+                VC_PROFILE_ZONE("Mesh job");
+                MeshStageTimes times;
+                if (in.selfChunk->buildAndStageMesh(m_Backend, job.second, in, m_MeshCache.get(), &times))
+                {
+                    if (times.firstMesh)
+                        m_Metrics.generatedToMeshed.record(times.meshed - in.selfChunk->getTerrainReadyTime());
+                    m_Metrics.meshedToStaged.record(times.staged - times.meshed);
+                }
+                m_ChunksMeshed.fetch_add(1, std::memory_order_relaxed);
+                m_Scheduler.onMeshJobCompleted();
+                std::lock_guard lk(m_MeshJobsMutex);
+                m_MeshJobsInProgress.erase(job);
+            });
+        m_Scheduler.complete(StreamingScheduler::Op::SUBMIT_MESH_JOB, std::chrono::steady_clock::now() - opStart);
+    }
+}
+
+void World::uploadReadyMeshes()
+{
+    VC_PROFILE_ZONE("World::uploadReadyMeshes");
+    const auto now = std::chrono::steady_clock::now();
+    for (auto &[pos, ch] : m_Chunks)
+        if (ch->markReady(m_Backend))
+            m_Metrics.stagedToReady.record(now - ch->getStagedTime());
+
+    for (auto &[pos, ch] : m_Chunks)
+    {
+        if (ch->getState() != Chunk::State::STAGING_READY)
+            continue;
+        if (!m_Scheduler.admit(StreamingScheduler::Op::UPLOAD_CHUNK))
+            break;
+        const auto opStart = std::chrono::steady_clock::now();
+
+        bool did_upload = false;
+        if (ch->uploadMesh(m_Backend, 0))
+            did_upload = true;
+        if (ch->uploadMesh(m_Backend, 1))
+            did_upload = true;
+        if (ch->uploadTransparentMesh(m_Backend, 0))
+            did_upload = true;
+        if (ch->uploadTransparentMesh(m_Backend, 1))
+            did_upload = true;
+
+        const auto opEnd = std::chrono::steady_clock::now();
+        m_Scheduler.complete(StreamingScheduler::Op::UPLOAD_CHUNK, opEnd - opStart);
+
+        if (did_upload)
+        {
+            m_ChunksUploaded++;
+            ++m_CullDataVersion;
+            if (ch->getState() == Chunk::State::GPU_READY)
+                m_Metrics.stagedToReady.record(opEnd - ch->getStagedTime());
+        }
+    }
+}
+
+void World::createChunkContainer(const glm::ivec3 &pos)
+{
+    if (m_Chunks.count(pos))
+        return;
+
+    // An unloaded chunk that has not been handed to the saver yet is the only copy of
+    // its latest edits, so take it back instead of reading the region file.
+    auto garbage = std::find_if(m_Garbage.begin(), m_Garbage.end(),
+                                [&](const std::shared_ptr<Chunk> &chunk)
+                                { return chunk->getPos() == pos; });
+    if (garbage != m_Garbage.end())
+    {
+        m_Chunks[pos] = std::move(*garbage);
+        m_Garbage.erase(garbage);
+        ++m_ChunkSetVersion;
+        return;
+    }
+
+    auto ch = std::make_shared<Chunk>(pos);
+    std::weak_ptr<Chunk> weak = ch;
+    m_Chunks[pos] = std::move(ch);
+    ++m_ChunkSetVersion;
+
+    const auto queuedAt = std::chrono::steady_clock::now();
+    m_Pool.submit([this, weak, queuedAt](std::stop_token st)
+                  {
+        if (st.stop_requested()) return;
+        auto raw = weak.lock();
+        if (!raw) return;
+        VC_PROFILE_ZONE("Chunk load job");
+        if (m_EditLog)
+            raw->populate(m_TerrainGen, m_EditLog.get());
+        else if (!raw->load(m_RegionStore, &m_ChunkSaver))
+            raw->populate(m_TerrainGen);
+        m_Metrics.queuedToGenerated.record(raw->getTerrainReadyTime() - queuedAt);
+        m_ChunksGenerated.fetch_add(1, std::memory_order_relaxed); });
+}
+
+bool World::saveChunk(Chunk &chunk, bool blocking)
+{
+    if (chunk.getState() == Chunk::State::INITIAL || !chunk.m_save_dirty.exchange(false, std::memory_order_acq_rel))
+        return true;
+    if (m_EditLog)
+        return true;
+
+    if (blocking)
+    {
+        m_ChunkSaver.submit(chunk.getPos(), chunk.getBlocks());
+        return true;
+    }
+
+    if (!m_ChunkSaver.trySubmit(chunk.getPos(), chunk.getBlocks()))
+    {
+        chunk.m_save_dirty.store(true, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "Settings.h"
+#include "Chunk.h"
+#include "RenderBackend.h"
+#include <map>
+#include <memory>
+#include <glm/glm.hpp>
+#include "math/Ivec3Less.h"
+#include "generation/TerrainGenerator.h"
+#include "world/RegionStore.h"
+#include "world/ChunkSaver.h"
+#include "world/EditLog.h"
+#include "world/MeshCache.h"
+#include "ThreadPool.h"
+#include "PipelineMetrics.h"
+#include "StreamingScheduler.h"
+#include <set>
+#include <mutex>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+struct ChunkLodRequestLess
+{
+    bool operator()(const std::pair<glm::ivec3, int> &a, const std::pair<glm::ivec3, int> &b) const
+    {
+        if (a.second != b.second)
+            return a.second < b.second;
+        if (a.first.x != b.first.x)
+            return a.first.x < b.first.x;
+        if (a.first.y != b.first.y)
+            return a.first.y < b.first.y;
+        return a.first.z < b.first.z;
+    }
+};
+
+using ChunkMap = std::map<glm::ivec3, std::shared_ptr<Chunk>, ivec3_less>;
+
+// Chunk streaming, meshing and persistence. Knows the GPU only through RenderBackend,
+// so it runs the same behind VulkanRenderer and NullRenderBackend.
+class World
+{
+public:
+    struct UpdateTimings
+    {
+        double unloadMs = 0.0;
+        double garbageMs = 0.0;
+        double loadMs = 0.0;
+        double createJobsMs = 0.0;
+        double submitJobsMs = 0.0;
+        double uploadMs = 0.0;
+    };
+
+    struct Counters
+    {
+        uint64_t generated = 0;
+        uint64_t meshed = 0;
+        uint64_t uploaded = 0;
+    };
+
+    World(Settings &settings, RenderBackend &backend);
+    ~World();
+    World(const World &) = delete;
+    World &operator=(const World &) = delete;
+
+    Block get_block(int x, int y, int z);
+    void set_block(int x, int y, int z, BlockId id);
+
+    // frameWorkSeconds: main-thread busy time per frame, excluding vsync and GPU waits.
+    void updateChunks(const glm::vec3 &cameraPos, double frameWorkSeconds);
+    const UpdateTimings &getLastUpdateTimings() const { return m_LastTimings; }
+    Counters getCounters() const;
+    PipelineStats getPipelineStats();
+    const StreamingScheduler::Stats &getSchedulerStats() const { return m_Scheduler.getStats(); }
+
+    ChunkMap &getChunks() { return m_Chunks; }
+    // Changes whenever a chunk is added to or removed from getChunks().
+    uint64_t getChunkSetVersion() const { return m_ChunkSetVersion; }
+    // Changes whenever an upload may have changed a chunk's mesh bounds.
+    uint64_t getCullDataVersion() const { return m_CullDataVersion; }
+    const TerrainGenerator &getTerrainGenerator() const { return m_TerrainGen; }
+    const ChunkSaver &getChunkSaver() const { return m_ChunkSaver; }
+    const EditLog *getEditLog() const { return m_EditLog.get(); }
+    const MeshCache *getMeshCache() const { return m_MeshCache.get(); }
+
+private:
+    void unloadDistantChunks(const glm::ivec3 &playerChunkPos);
+    void processGarbage();
+    void loadVisibleChunks(const glm::ivec3 &playerChunkPos);
+    void createMeshJobs(const glm::ivec3 &playerChunkPos);
+    void submitMeshJobs(const glm::ivec3 &playerChunkPos);
+    void uploadReadyMeshes();
+    void createChunkContainer(const glm::ivec3 &pos);
+    bool saveChunk(Chunk &chunk, bool blocking = false);
+    void dumpPipelineMetrics();
+
+    Settings &m_Settings;
+    RenderBackend &m_Backend;
+
+    TerrainGenerator m_TerrainGen;
+    RegionStore m_RegionStore;
+    ChunkSaver m_ChunkSaver;
+    std::unique_ptr<EditLog> m_EditLog;
+    std::unique_ptr<MeshCache> m_MeshCache;
+
+    mutable std::mutex m_MeshJobsMutex;
+    std::set<std::pair<glm::ivec3, int>, ChunkLodRequestLess> m_MeshJobsToCreate;
+    std::set<std::pair<glm::ivec3, int>, ChunkLodRequestLess> m_MeshJobsInProgress;
+
+    UpdateTimings m_LastTimings;
+    std::atomic<uint64_t> m_ChunksGenerated{0};
+    std::atomic<uint64_t> m_ChunksMeshed{0};
+    uint64_t m_ChunksUploaded = 0;
+
+    PipelineMetrics m_Metrics;
+    std::ofstream m_MetricsFile;
+    std::chrono::steady_clock::time_point m_MetricsStart;
+    std::chrono::steady_clock::time_point m_LastMetricsDump;
+
+    ChunkMap m_Chunks;
+    uint64_t m_ChunkSetVersion = 0;
+    uint64_t m_CullDataVersion = 0;
+    std::vector<std::shared_ptr<Chunk>> m_Garbage;
+    ThreadPool m_Pool;
+    StreamingScheduler m_Scheduler;
+};
@@ -0,0 +1,168 @@
+#include "AtlasCooker.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    constexpr char ATLAS_MAGIC[4] = {'V', 'C', 'T', 'X'};
+    constexpr uint32_t ATLAS_VERSION = 1;
+    constexpr uint32_t FORMAT_RGBA8_SRGB = 1;
+    constexpr uint64_t DATA_ALIGNMENT = 16;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t tileSize;
+        uint32_t levelCount;
+        uint32_t reserved;
+    };
+
+    uint64_t alignUp(uint64_t v, uint64_t a)
+    {
+        return (v + a - 1) / a * a;
+    }
+
+    bool isPowerOfTwo(uint32_t v)
+    {
+        return v != 0 && (v & (v - 1)) == 0;
+    }
+
+    const std::array<float, 256> &srgbToLinearTable()
+    {
+        static const std::array<float, 256> table = []
+        {
+            std::array<float, 256> t{};
+            for (int i = 0; i < 256; ++i)
+            {
+                float c = i / 255.0f;
+                t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    uint8_t linearToSrgb(float c)
+    {
+        c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::lround(std::fmin(std::fmax(c, 0.0f), 1.0f) * 255.0f));
+    }
+
+    void downsample(const uint8_t *src, uint32_t srcW, uint8_t *dst, uint32_t dstW, uint32_t dstH)
+    {
+        const auto &lin = srgbToLinearTable();
+        for (uint32_t y = 0; y < dstH; ++y)
+        {
+            for (uint32_t x = 0; x < dstW; ++x)
+            {
+                float rgb[3] = {0, 0, 0};
+                float plain[3] = {0, 0, 0};
+                float alpha = 0;
+                for (uint32_t dy = 0; dy < 2; ++dy)
+                {
+                    for (uint32_t dx = 0; dx < 2; ++dx)
+                    {
+                        const uint8_t *p = src + ((size_t)(2 * y + dy) * srcW + (2 * x + dx)) * 4;
+                        float a = p[3] / 255.0f;
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            rgb[c] += lin[p[c]] * a;
+                            plain[c] += lin[p[c]];
+                        }
+                        alpha += a;
+                    }
+                }
+
+                uint8_t *out = dst + ((size_t)y * dstW + x) * 4;
+                for (int c = 0; c < 3; ++c)
+                    out[c] = linearToSrgb(alpha > 0 ? rgb[c] / alpha : plain[c] * 0.25f);
+                out[3] = static_cast<uint8_t>(std::lround(alpha * 0.25f * 255.0f));
+            }
+        }
+    }
+}
+
+std::vector<uint8_t> AtlasCooker::cook(const uint8_t *rgba, uint32_t width, uint32_t height, uint32_t tileSize)
+{
+    if (!isPowerOfTwo(tileSize) || width % tileSize != 0 || height % tileSize != 0)
+        throw std::runtime_error("atlas size must be a multiple of a power-of-two tile size");
+
+    uint32_t levelCount = 1;
+    while ((tileSize >> levelCount) != 0)
+        ++levelCount;
+
+    std::vector<Level> levels(levelCount);
+    uint64_t offset = alignUp(sizeof(FileHeader) + levelCount * sizeof(Level), DATA_ALIGNMENT);
+    for (uint32_t l = 0; l < levelCount; ++l)
+    {
+        levels[l].width = width >> l;
+        levels[l].height = height >> l;
+        levels[l].offset = offset;
+        levels[l].size = static_cast<uint64_t>(levels[l].width) * levels[l].height * 4;
+        offset = alignUp(offset + levels[l].size, DATA_ALIGNMENT);
+    }
+
+    std::vector<uint8_t> out(offset, 0);
+
+    FileHeader header{};
+    std::memcpy(header.magic, ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+    header.version = ATLAS_VERSION;
+    header.format = FORMAT_RGBA8_SRGB;
+    header.width = width;
+    header.height = height;
+    header.tileSize = tileSize;
+    header.levelCount = levelCount;
+    std::memcpy(out.data(), &header, sizeof(header));
+    std::memcpy(out.data() + sizeof(header), levels.data(), levelCount * sizeof(Level));
+
+    std::memcpy(out.data() + levels[0].offset, rgba, levels[0].size);
+    for (uint32_t l = 1; l < levelCount; ++l)
+    {
+        downsample(out.data() + levels[l - 1].offset, levels[l - 1].width,
+                   out.data() + levels[l].offset, levels[l].width, levels[l].height);
+    }
+    return out;
+}
+
+AtlasCooker::CookedAtlas AtlasCooker::parse(const uint8_t *data, size_t size)
+{
+    FileHeader header{};
+    if (!data || size < sizeof(header))
+        throw std::runtime_error("cooked atlas is truncated");
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, ATLAS_MAGIC, sizeof(ATLAS_MAGIC)) != 0 || header.version != ATLAS_VERSION)
+        throw std::runtime_error("cooked atlas has an unknown header");
+    if (header.format != FORMAT_RGBA8_SRGB || header.levelCount == 0 || header.levelCount > 16)
+        throw std::runtime_error("cooked atlas has an unsupported layout");
+    if (size < sizeof(header) + header.levelCount * sizeof(Level))
+        throw std::runtime_error("cooked atlas is truncated");
+
+    CookedAtlas atlas;
+    atlas.width = header.width;
+    atlas.height = header.height;
+    atlas.tileSize = header.tileSize;
+    atlas.levels.resize(header.levelCount);
+    std::memcpy(atlas.levels.data(), data + sizeof(header), header.levelCount * sizeof(Level));
+
+    for (uint32_t l = 0; l < header.levelCount; ++l)
+    {
+        const Level &lv = atlas.levels[l];
+        if (lv.width != (header.width >> l) || lv.height != (header.height >> l) ||
+            lv.size != static_cast<uint64_t>(lv.width) * lv.height * 4 ||
+            lv.offset < atlas.levels[0].offset || lv.offset + lv.size > size)
+            throw std::runtime_error("cooked atlas level " + std::to_string(l) + " is out of range");
+    }
+
+    atlas.pixels = data + atlas.levels[0].offset;
+    const Level &last = atlas.levels.back();
+    atlas.pixelBytes = static_cast<size_t>(last.offset + last.size - atlas.levels[0].offset);
+    return atlas;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace AtlasCooker
+{
+    struct Level
+    {
+        uint32_t width;
+        uint32_t height;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct CookedAtlas
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t tileSize = 0;
+        std::vector<Level> levels;
+
+        const uint8_t *pixels = nullptr;
+        size_t pixelBytes = 0;
+    };
+
+    std::vector<uint8_t> cook(const uint8_t *rgba, uint32_t width, uint32_t height, uint32_t tileSize);
+    CookedAtlas parse(const uint8_t *data, size_t size);
+}
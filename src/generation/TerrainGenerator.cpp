@@ -4,8 +4,15 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/noise.hpp>
 
-TerrainGenerator::TerrainGenerator()
+TerrainGenerator::TerrainGenerator(int seed) : m_seed(seed)
 {
+    for (FastNoiseLite *noise : {&m_continent, &m_erosion, &m_terrainRoughness, &m_terrainType, &m_domainWarp,
+                                 &m_temperature, &m_humidity, &m_cavernNoise, &m_tunnelNoise1, &m_tunnelNoise2,
+                                 &m_bedrockNoise})
+    {
+        noise->SetSeed(seed);
+    }
+
     m_continent.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
     m_continent.SetFrequency(0.004f);
 
@@ -32,7 +39,6 @@ TerrainGenerator::TerrainGenerator()
     m_tunnelNoise1.SetFrequency(0.015f);
     m_tunnelNoise2.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
     m_tunnelNoise2.SetFrequency(0.015f);
-    m_tunnelNoise2.SetSeed(1337);
 
     m_bedrockNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
     m_bedrockNoise.SetFrequency(0.1f);
@@ -86,16 +92,16 @@ bool TerrainGenerator::isCave(float x, float y, float z) const
     return in_tunnel || in_cavern;
 }
 
-void TerrainGenerator::populateChunk(Chunk &c)
+void TerrainGenerator::generateBlocks(const glm::ivec3 &cp, std::vector<Block> &out) const
 {
-    glm::ivec3 cp = c.getPos();
+    out.resize(ChunkLayout::VOLUME);
 
-    for (int x = 0; x < Chunk::WIDTH; ++x)
+    for (int x = 0; x < ChunkLayout::WIDTH; ++x)
     {
-        for (int z = 0; z < Chunk::DEPTH; ++z)
+        for (int z = 0; z < ChunkLayout::DEPTH; ++z)
         {
-            int gx = cp.x * Chunk::WIDTH + x;
-            int gz = cp.z * Chunk::DEPTH + z;
+            int gx = cp.x * ChunkLayout::WIDTH + x;
+            int gz = cp.z * ChunkLayout::DEPTH + z;
 
             float h_center = heightAt(gx, gz);
             int ih = static_cast<int>(std::floor(SEA_LEVEL + h_center));
@@ -103,7 +109,7 @@ void TerrainGenerator::populateChunk(Chunk &c)
             float temp_val = (m_temperature.GetNoise((float)gx, (float)gz) + 1.f) * 0.5f;
             float biome_blend_alpha = glm::smoothstep(0.4f, 0.6f, temp_val);
 
-            for (int y = 0; y < Chunk::HEIGHT; ++y)
+            for (int y = 0; y < ChunkLayout::HEIGHT; ++y)
             {
                 Block block;
 
@@ -175,9 +181,8 @@ void TerrainGenerator::populateChunk(Chunk &c)
                     block.id = BlockId::WATER;
                 }
 
-                c.setBlock(x, y, z, block);
+                out[ChunkLayout::index(x, y, z)] = block;
             }
         }
     }
-    c.m_State.store(Chunk::State::TERRAIN_READY, std::memory_order_release);
-}
\ No newline at end of file
+}
@@ -1,8 +1,12 @@
 #pragma once
 #include <unordered_map>
 #include <memory>
-#include "../Chunk.h"
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
 #include <FastNoiseLite.h>
+#include "../Block.h"
+#include "../ChunkLayout.h"
 
 #include "Biome.h"
 #include "PlainsBiome.h"
@@ -12,12 +16,14 @@
 class TerrainGenerator
 {
 public:
-    TerrainGenerator();
-    void populateChunk(Chunk &c);
+    explicit TerrainGenerator(int seed = 1337);
+    void generateBlocks(const glm::ivec3 &chunkPos, std::vector<Block> &out) const;
     static constexpr int SEA_LEVEL = 80;
-    int64_t getSeed() const { return 1337; }
+    int64_t getSeed() const { return m_seed; }
 
 private:
+    int m_seed;
+
     FastNoiseLite m_continent;
     FastNoiseLite m_erosion;
     FastNoiseLite m_terrainRoughness;
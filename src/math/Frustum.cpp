@@ -1,4 +1,52 @@
 #include "Frustum.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define VC_FRUSTUM_SIMD 1
+#endif
+
+namespace
+{
+    // Storage grows in whole batches of the widest variant.
+    constexpr size_t SOA_PAD = 8;
+}
+
+void AABBSoA::clear()
+{
+    m_Size = 0;
+    for (auto *v : {&m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ})
+        v->clear();
+}
+
+void AABBSoA::reserve(size_t count)
+{
+    for (auto *v : {&m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ})
+        v->reserve((count + SOA_PAD - 1) / SOA_PAD * SOA_PAD);
+}
+
+void AABBSoA::push_back(const AABB &box)
+{
+    if (m_Size == m_CenterX.size())
+    {
+        for (auto *v : {&m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ})
+            v->resize(m_Size + SOA_PAD, 0.f);
+    }
+    set(m_Size++, box);
+}
+
+void AABBSoA::set(size_t index, const AABB &box)
+{
+    const glm::vec3 center = (box.min + box.max) * 0.5f;
+    const glm::vec3 extent = (box.max - box.min) * 0.5f;
+    m_CenterX[index] = center.x;
+    m_CenterY[index] = center.y;
+    m_CenterZ[index] = center.z;
+    m_ExtentX[index] = extent.x;
+    m_ExtentY[index] = extent.y;
+    m_ExtentZ[index] = extent.z;
+}
 
 float Plane::getSignedDistance(const glm::vec3 &point) const
 {
@@ -59,4 +107,106 @@ bool Frustum::intersects(const AABB &aabb) const
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+Frustum::Containment Frustum::classify(const AABB &aabb) const
+{
+    bool partial = false;
+    for (const auto &plane : planes)
+    {
+        const glm::vec3 p(
+            plane.normal.x < 0 ? aabb.min.x : aabb.max.x,
+            plane.normal.y < 0 ? aabb.min.y : aabb.max.y,
+            plane.normal.z < 0 ? aabb.min.z : aabb.max.z);
+        if (glm::dot(plane.normal, p) + plane.distance < 0)
+            return Containment::OUTSIDE;
+
+        const glm::vec3 n(
+            plane.normal.x < 0 ? aabb.max.x : aabb.min.x,
+            plane.normal.y < 0 ? aabb.max.y : aabb.min.y,
+            plane.normal.z < 0 ? aabb.max.z : aabb.min.z);
+        if (glm::dot(plane.normal, n) + plane.distance < 0)
+            partial = true;
+    }
+
+    return partial ? Containment::PARTIAL : Containment::INSIDE;
+}
+
+// For a box with center c and half extent e, n.c + d is the plane distance of the center and
+// |n|.e how far the box reaches along n. Outside when even the furthest corner is behind a
+// plane, inside when the nearest corner is in front of all of them.
+Frustum::BatchResult Frustum::testBatch(const AABBSoA &boxes, size_t first) const
+{
+    if (first >= boxes.size())
+        return {};
+    const uint32_t valid = (1u << std::min(BATCH_WIDTH, boxes.size() - first)) - 1;
+    uint32_t outside = 0;
+    uint32_t partial = 0;
+
+#if defined(VC_FRUSTUM_SIMD) && defined(__AVX__)
+    const __m256 cx = _mm256_loadu_ps(boxes.centerX() + first);
+    const __m256 cy = _mm256_loadu_ps(boxes.centerY() + first);
+    const __m256 cz = _mm256_loadu_ps(boxes.centerZ() + first);
+    const __m256 ex = _mm256_loadu_ps(boxes.extentX() + first);
+    const __m256 ey = _mm256_loadu_ps(boxes.extentY() + first);
+    const __m256 ez = _mm256_loadu_ps(boxes.extentZ() + first);
+    __m256 out = _mm256_setzero_ps();
+    __m256 part = _mm256_setzero_ps();
+    for (const auto &plane : planes)
+    {
+        __m256 dist = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.normal.x), cx), _mm256_mul_ps(_mm256_set1_ps(plane.normal.y), cy)),
+            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.normal.z), cz), _mm256_set1_ps(plane.distance)));
+        __m256 reach = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(std::abs(plane.normal.x)), ex), _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.normal.y)), ey)),
+            _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.normal.z)), ez));
+        out = _mm256_or_ps(out, _mm256_cmp_ps(_mm256_add_ps(dist, reach), _mm256_setzero_ps(), _CMP_LT_OQ));
+        part = _mm256_or_ps(part, _mm256_cmp_ps(_mm256_sub_ps(dist, reach), _mm256_setzero_ps(), _CMP_LT_OQ));
+    }
+    outside = static_cast<uint32_t>(_mm256_movemask_ps(out));
+    partial = static_cast<uint32_t>(_mm256_movemask_ps(part));
+#elif defined(VC_FRUSTUM_SIMD)
+    const __m128 cx = _mm_loadu_ps(boxes.centerX() + first);
+    const __m128 cy = _mm_loadu_ps(boxes.centerY() + first);
+    const __m128 cz = _mm_loadu_ps(boxes.centerZ() + first);
+    const __m128 ex = _mm_loadu_ps(boxes.extentX() + first);
+    const __m128 ey = _mm_loadu_ps(boxes.extentY() + first);
+    const __m128 ez = _mm_loadu_ps(boxes.extentZ() + first);
+    __m128 out = _mm_setzero_ps();
+    __m128 part = _mm_setzero_ps();
+    for (const auto &plane : planes)
+    {
+        __m128 dist = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal.x), cx), _mm_mul_ps(_mm_set1_ps(plane.normal.y), cy)),
+            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.normal.z), cz), _mm_set1_ps(plane.distance)));
+        __m128 reach = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::abs(plane.normal.x)), ex), _mm_mul_ps(_mm_set1_ps(std::abs(plane.normal.y)), ey)),
+            _mm_mul_ps(_mm_set1_ps(std::abs(plane.normal.z)), ez));
+        out = _mm_or_ps(out, _mm_cmplt_ps(_mm_add_ps(dist, reach), _mm_setzero_ps()));
+        part = _mm_or_ps(part, _mm_cmplt_ps(_mm_sub_ps(dist, reach), _mm_setzero_ps()));
+    }
+    outside = static_cast<uint32_t>(_mm_movemask_ps(out));
+    partial = static_cast<uint32_t>(_mm_movemask_ps(part));
+#else
+    for (size_t lane = 0; lane < BATCH_WIDTH; ++lane)
+    {
+        const size_t i = first + lane;
+        const glm::vec3 c(boxes.centerX()[i], boxes.centerY()[i], boxes.centerZ()[i]);
+        const glm::vec3 e(boxes.extentX()[i], boxes.extentY()[i], boxes.extentZ()[i]);
+        for (const auto &plane : planes)
+        {
+            float dist = glm::dot(plane.normal, c) + plane.distance;
+            float reach = glm::dot(glm::abs(plane.normal), e);
+            if (dist + reach < 0)
+                outside |= 1u << lane;
+            if (dist - reach < 0)
+                partial |= 1u << lane;
+        }
+    }
+#endif
+
+    BatchResult r;
+    r.visible = ~outside & valid;
+    r.inside = ~partial & r.visible;
+    return r;
+}
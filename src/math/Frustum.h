@@ -2,6 +2,9 @@
 #include "AABB.h"
 #include <glm/glm.hpp>
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 struct Plane
 {
@@ -11,12 +14,64 @@ struct Plane
     float getSignedDistance(const glm::vec3 &point) const;
 };
 
+// Boxes as centers and half extents in structure-of-arrays form for Frustum::testBatch.
+// Storage is padded to a whole number of batches so a batch load never reads past the end.
+class AABBSoA
+{
+public:
+    void clear();
+    void reserve(size_t count);
+    void push_back(const AABB &box);
+    void set(size_t index, const AABB &box);
+    size_t size() const { return m_Size; }
+
+    const float *centerX() const { return m_CenterX.data(); }
+    const float *centerY() const { return m_CenterY.data(); }
+    const float *centerZ() const { return m_CenterZ.data(); }
+    const float *extentX() const { return m_ExtentX.data(); }
+    const float *extentY() const { return m_ExtentY.data(); }
+    const float *extentZ() const { return m_ExtentZ.data(); }
+
+private:
+    size_t m_Size = 0;
+    std::vector<float> m_CenterX, m_CenterY, m_CenterZ, m_ExtentX, m_ExtentY, m_ExtentZ;
+};
+
 class Frustum
 {
 public:
+    enum class Containment
+    {
+        OUTSIDE,
+        PARTIAL,
+        INSIDE
+    };
+
+    // Lane i of each mask is box first + i.
+    struct BatchResult
+    {
+        uint32_t visible = 0;
+        uint32_t inside = 0;
+    };
+
+#if defined(__AVX__)
+    static constexpr size_t BATCH_WIDTH = 8;
+#else
+    static constexpr size_t BATCH_WIDTH = 4;
+#endif
+
     void update(const glm::mat4 &viewProjMatrix);
     bool intersects(const AABB &aabb) const;
+    // INSIDE means no plane cuts the box, so anything it contains needs no further test.
+    Containment classify(const AABB &aabb) const;
+
+    // Tests boxes [first, first + BATCH_WIDTH); first must be a multiple of BATCH_WIDTH.
+    // Lanes past boxes.size() read as not visible.
+    BatchResult testBatch(const AABBSoA &boxes, size_t first) const;
+
+    // Normals point inward and are unit length.
+    const std::array<Plane, 6> &getPlanes() const { return planes; }
 
 private:
     std::array<Plane, 6> planes;
-};
\ No newline at end of file
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// Matches CullPushConstants in chunk_cull.comp.
+struct ChunkCullPushConstants
+{
+    glm::vec4 planes[6];
+    glm::vec4 cameraPos;
+    uint32_t opaqueDraws;
+    uint32_t totalDraws;
+    uint32_t compactOpaque;
+};
@@ -8,6 +8,8 @@
 #include <array>
 #include <fstream>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "stb_truetype.h"
@@ -44,14 +46,17 @@ namespace
 
 static stbtt_bakedchar cdata[96];
 
-DebugOverlay::DebugOverlay(DeviceContext &deviceContext, VkCommandPool commandPool)
-    : m_deviceContext(deviceContext), m_commandPool(commandPool)
+DebugOverlay::DebugOverlay(DeviceContext &deviceContext, VkCommandPool commandPool, VkPipelineCache pipelineCache)
+    : m_deviceContext(deviceContext), m_commandPool(commandPool), m_pipelineCache(pipelineCache)
 {
     VkPhysicalDeviceProperties properties;
     vkGetPhysicalDeviceProperties(m_deviceContext.getPhysicalDevice(), &properties);
     m_gpuName = properties.deviceName;
     m_raytracingSupport = m_deviceContext.isRayTracingSupported() ? "Yes" : "No";
 
+    m_vertShader = createShaderModule(m_deviceContext.getDevice(), readBinaryFile("shaders/text.vert.spv"));
+    m_fragShader = createShaderModule(m_deviceContext.getDevice(), readBinaryFile("shaders/text.frag.spv"));
+
     createFontTexture();
 }
 
@@ -62,6 +67,8 @@ void DebugOverlay::cleanupPipeline()
     m_descriptorPool = {nullptr, {}};
     m_descriptorSetLayout = {nullptr, {}};
     m_vertexBuffer = {};
+    m_vertexBufferMapped = nullptr;
+    m_descriptorSet = VK_NULL_HANDLE;
 }
 
 void DebugOverlay::recreate(VkRenderPass renderPass, VkExtent2D viewportExtent)
@@ -169,17 +176,192 @@ void DebugOverlay::createPipeline(VkRenderPass renderPass)
     vkCreatePipelineLayout(m_deviceContext.getDevice(), &pipelineLayoutInfo, nullptr, &pl);
     m_pipelineLayout = VulkanHandle<VkPipelineLayout, PipelineLayoutDeleter>(pl, {m_deviceContext.getDevice()});
 
-    auto vertShader = createShaderModule(m_deviceContext.getDevice(), readBinaryFile("shaders/debug.vert.spv"));
-    auto fragShader = createShaderModule(m_deviceContext.getDevice(), readBinaryFile("shaders/debug.frag.spv"));
+    VkDescriptorSetAllocateInfo setInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    setInfo.descriptorPool = pool;
+    setInfo.descriptorSetCount = 1;
+    setInfo.pSetLayouts = &dsl;
+    if (vkAllocateDescriptorSets(m_deviceContext.getDevice(), &setInfo, &m_descriptorSet) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate debug overlay descriptor set!");
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = m_fontSampler.get();
+    imageInfo.imageView = m_fontImageView.get();
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    write.dstSet = m_descriptorSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(m_deviceContext.getDevice(), 1, &write, 0, nullptr);
 
     VkPipelineShaderStageCreateInfo stages[2] = {
-        {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vertShader.get(), "main"},
-        {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, fragShader.get(), "main"}};
+        {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, m_vertShader.get(), "main"},
+        {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, m_fragShader.get(), "main"}};
+
+    VkVertexInputBindingDescription bindingDesc{0, sizeof(glm::vec4), VK_VERTEX_INPUT_RATE_VERTEX};
+    std::array<VkVertexInputAttributeDescription, 2> attrDescs{{{0, 0, VK_FORMAT_R32G32_SFLOAT, 0},
+                                                                {1, 0, VK_FORMAT_R32G32_SFLOAT, sizeof(glm::vec2)}}};
+
+    VkPipelineVertexInputStateCreateInfo vertexInput{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+    vertexInput.vertexBindingDescriptionCount = 1;
+    vertexInput.pVertexBindingDescriptions = &bindingDesc;
+    vertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrDescs.size());
+    vertexInput.pVertexAttributeDescriptions = attrDescs.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
+    depthStencil.depthTestEnable = VK_FALSE;
+    depthStencil.depthWriteEnable = VK_FALSE;
+
+    VkPipelineColorBlendAttachmentState blendAttachment{};
+    blendAttachment.colorWriteMask = 0xf;
+    blendAttachment.blendEnable = VK_TRUE;
+    blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    blendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    blendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &blendAttachment;
+
+    std::array<VkDynamicState, 2> dynamicStates{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = stages;
+    pipelineInfo.pVertexInputState = &vertexInput;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = pl;
+    pipelineInfo.renderPass = renderPass;
+
+    VkPipeline pipeline;
+    if (vkCreateGraphicsPipelines(m_deviceContext.getDevice(), m_pipelineCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+        throw std::runtime_error("failed to create debug overlay pipeline!");
+    m_pipeline = VulkanHandle<VkPipeline, PipelineDeleter>(pipeline, {m_deviceContext.getDevice()});
+
+    VkBufferCreateInfo bufferInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    bufferInfo.size = sizeof(glm::vec4) * MAX_VERTICES * MAX_FRAMES_IN_FLIGHT;
+    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    VmaAllocationCreateInfo bufferAlloc{};
+    bufferAlloc.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    bufferAlloc.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    m_vertexBuffer = VmaBuffer(m_deviceContext.getAllocator(), bufferInfo, bufferAlloc);
+
+    VmaAllocationInfo allocInfo;
+    vmaGetAllocationInfo(m_deviceContext.getAllocator(), m_vertexBuffer.getAllocation(), &allocInfo);
+    m_vertexBufferMapped = allocInfo.pMappedData;
+}
+
+void DebugOverlay::generateStringMesh(float x, float y, const std::string &text, std::vector<glm::vec4> &vertices)
+{
+    const float w = static_cast<float>(m_viewportExtent.width);
+    const float h = static_cast<float>(m_viewportExtent.height);
+    auto ndc = [&](float px, float py)
+    { return glm::vec2(px / w * 2.f - 1.f, py / h * 2.f - 1.f); };
+
+    for (char c : text)
+    {
+        if (c < 32 || c >= 128)
+            continue;
+
+        stbtt_aligned_quad q;
+        stbtt_GetBakedQuad(cdata, 512, 512, c - 32, &x, &y, &q, 1);
+
+        glm::vec2 p0 = ndc(q.x0, q.y0);
+        glm::vec2 p1 = ndc(q.x1, q.y1);
+
+        vertices.push_back({p0.x, p0.y, q.s0, q.t0});
+        vertices.push_back({p1.x, p0.y, q.s1, q.t0});
+        vertices.push_back({p1.x, p1.y, q.s1, q.t1});
+        vertices.push_back({p0.x, p0.y, q.s0, q.t0});
+        vertices.push_back({p1.x, p1.y, q.s1, q.t1});
+        vertices.push_back({p0.x, p1.y, q.s0, q.t1});
+    }
 }
+
+void DebugOverlay::setSection(const std::string &title, std::vector<std::string> lines)
+{
+    m_sections[title] = std::move(lines);
+}
+
 void DebugOverlay::update(const Player &player, const Settings &settings, float fps, int64_t seed)
 {
+    std::vector<std::string> lines;
+    char buf[160];
+
+    std::snprintf(buf, sizeof(buf), "FPS: %.0f", fps);
+    lines.emplace_back(buf);
+    glm::vec3 pos = player.get_position();
+    std::snprintf(buf, sizeof(buf), "XYZ: %.2f / %.2f / %.2f", pos.x, pos.y, pos.z);
+    lines.emplace_back(buf);
+    std::snprintf(buf, sizeof(buf), "Seed: %lld", static_cast<long long>(seed));
+    lines.emplace_back(buf);
+    std::snprintf(buf, sizeof(buf), "Render distance: %d", settings.renderDistance);
+    lines.emplace_back(buf);
+    lines.push_back("GPU: " + m_gpuName);
+    lines.push_back("Ray tracing: " + m_raytracingSupport);
+
+    for (const auto &[title, sectionLines] : m_sections)
+    {
+        lines.emplace_back();
+        lines.push_back("[" + title + "]");
+        lines.insert(lines.end(), sectionLines.begin(), sectionLines.end());
+    }
+
+    m_vertices.clear();
+    float y = 20.f;
+    for (const std::string &line : lines)
+    {
+        generateStringMesh(10.f, y, line, m_vertices);
+        y += 16.f;
+    }
+    m_vertexCount = static_cast<uint32_t>(std::min<size_t>(m_vertices.size(), MAX_VERTICES));
 }
 
-void DebugOverlay::draw(VkCommandBuffer commandBuffer)
+void DebugOverlay::draw(VkCommandBuffer commandBuffer, uint32_t frameIndex)
 {
-}
\ No newline at end of file
+    if (m_vertexCount == 0 || !m_pipeline.get() || !m_vertexBufferMapped)
+        return;
+
+    const VkDeviceSize offset = sizeof(glm::vec4) * MAX_VERTICES * frameIndex;
+    std::memcpy(static_cast<char *>(m_vertexBufferMapped) + offset, m_vertices.data(), sizeof(glm::vec4) * m_vertexCount);
+
+    VkViewport viewport{0.f, 0.f, static_cast<float>(m_viewportExtent.width), static_cast<float>(m_viewportExtent.height), 0.f, 1.f};
+    VkRect2D scissor{{0, 0}, m_viewportExtent};
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.get());
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout.get(), 0, 1, &m_descriptorSet, 0, nullptr);
+    VkBuffer vb = m_vertexBuffer.get();
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vb, &offset);
+    vkCmdDraw(commandBuffer, m_vertexCount, 1, 0, 0);
+}
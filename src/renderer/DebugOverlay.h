@@ -2,8 +2,10 @@
 
 #include "VulkanWrappers.h"
 #include "core/DeviceContext.h"
+#include "RendererConfig.h"
 #include <vector>
 #include <string>
+#include <map>
 #include <glm/glm.hpp>
 
 class Player;
@@ -13,11 +15,14 @@ struct Settings;
 class DebugOverlay
 {
 public:
-    DebugOverlay(DeviceContext &deviceContext, VkCommandPool commandPool);
+    DebugOverlay(DeviceContext &deviceContext, VkCommandPool commandPool, VkPipelineCache pipelineCache = VK_NULL_HANDLE);
     ~DebugOverlay();
 
+    static constexpr uint32_t MAX_VERTICES = 6 * 8192;
+
     void update(const Player &player, const Settings &settings, float fps, int64_t seed);
-    void draw(VkCommandBuffer commandBuffer);
+    void setSection(const std::string &title, std::vector<std::string> lines);
+    void draw(VkCommandBuffer commandBuffer, uint32_t frameIndex);
 
     void recreate(VkRenderPass renderPass, VkExtent2D viewportExtent);
 
@@ -30,6 +35,10 @@ private:
 
     DeviceContext &m_deviceContext;
     VkCommandPool m_commandPool;
+    VkPipelineCache m_pipelineCache;
+
+    VulkanHandle<VkShaderModule, ShaderModuleDeleter> m_vertShader;
+    VulkanHandle<VkShaderModule, ShaderModuleDeleter> m_fragShader;
 
     VkRenderPass m_renderPass = VK_NULL_HANDLE;
     VkExtent2D m_viewportExtent;
@@ -46,7 +55,11 @@ private:
     VulkanHandle<VkPipeline, PipelineDeleter> m_pipeline;
 
     VmaBuffer m_vertexBuffer;
+    void *m_vertexBufferMapped = nullptr;
     uint32_t m_vertexCount = 0;
+    std::vector<glm::vec4> m_vertices;
+
+    std::map<std::string, std::vector<std::string>> m_sections;
 
     std::string m_gpuName;
     std::string m_raytracingSupport;
@@ -1,15 +1,10 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include <vulkan/vulkan.h>
-#include <array>
 
 struct Vertex
 {
     glm::vec3 pos;
     glm::vec3 color;
     glm::vec2 texCoord;
-
-    static VkVertexInputBindingDescription getBindingDescription();
-    static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions();
-};
\ No newline at end of file
+};
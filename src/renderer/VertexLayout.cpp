@@ -1,6 +1,7 @@
-#include "Vertex.h"
+#include "VertexLayout.h"
+#include <cstddef>
 
-VkVertexInputBindingDescription Vertex::getBindingDescription()
+VkVertexInputBindingDescription VertexLayout::getBindingDescription()
 {
     VkVertexInputBindingDescription binding{};
     binding.binding = 0;
@@ -9,7 +10,7 @@ VkVertexInputBindingDescription Vertex::getBindingDescription()
     return binding;
 }
 
-std::array<VkVertexInputAttributeDescription, 3> Vertex::getAttributeDescriptions()
+std::array<VkVertexInputAttributeDescription, 3> VertexLayout::getAttributeDescriptions()
 {
     std::array<VkVertexInputAttributeDescription, 3> attrs{};
     attrs[0].binding = 0;
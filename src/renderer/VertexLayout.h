@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Vertex.h"
+#include <vulkan/vulkan.h>
+#include <array>
+
+namespace VertexLayout
+{
+    VkVertexInputBindingDescription getBindingDescription();
+    std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions();
+}
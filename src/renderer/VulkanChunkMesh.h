@@ -0,0 +1,21 @@
+#pragma once
+#include "../RenderBackend.h"
+#include "../Chunk.h"
+#include "../UploadJob.h"
+#include "RayTracing.h"
+
+struct VulkanChunkMesh : GpuMesh
+{
+    VmaBuffer vertexBuffer;
+    VmaBuffer indexBuffer;
+    AccelerationStructure blas;
+    UploadJob upload;
+    // Unique per upload, so cached command buffers can tell a re-uploaded mesh from the one
+    // they were recorded with even when it reuses the same buffers or pool ranges.
+    uint64_t generation = 0;
+};
+
+inline VulkanChunkMesh &vulkanMesh(const ChunkMesh &mesh)
+{
+    return static_cast<VulkanChunkMesh &>(*mesh.gpu);
+}
@@ -1,23 +1,47 @@
 #include "CommandManager.h"
 #include <stdexcept>
+#include <algorithm>
 #include <array>
 #include "../../math/Ivec3Less.h"
 #include <Globals.h>
+#include "../DebugOverlay.h"
+#include "../VulkanChunkMesh.h"
+#include "../resources/ChunkMeshPool.h"
 #include <glm/gtc/matrix_transform.hpp>
+#include "../../Profiler.h"
 
-CommandManager::CommandManager(const DeviceContext &deviceContext, const SwapChainContext &swapChainContext, const PipelineCache &pipelineCache)
+namespace
+{
+    // Face directions of the mesh that can point at the camera; the rest are not drawn.
+    uint8_t facesTowardCamera(const glm::vec3 &cameraPos, const Chunk &chunk, const ChunkMesh &mesh)
+    {
+        return mesh.faces.facingCamera(cameraPos - chunk.getAABB().min);
+    }
+}
+
+CommandManager::CommandManager(const DeviceContext &deviceContext, const SwapChainContext &swapChainContext, const PipelineCache &pipelineCache,
+                               size_t recordingThreads)
     : m_DeviceContext(deviceContext), m_SwapChainContext(swapChainContext), m_PipelineCache(pipelineCache)
 {
     createCommandPool();
     createCommandBuffers();
+    if (recordingThreads > 0)
+    {
+        m_Recorders = std::make_unique<ParallelFor>(recordingThreads);
+        createRecordingPools();
+    }
+
+    if (m_DeviceContext.isDrawIndirectCountSupported())
+        m_vkCmdDrawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCount)vkGetDeviceProcAddr(m_DeviceContext.getDevice(), "vkCmdDrawIndexedIndirectCount");
 }
 
 CommandManager::~CommandManager() {}
 
 void CommandManager::recordCommandBuffer(
     uint32_t imageIndex, uint32_t currentFrame,
-    const std::vector<std::pair<Chunk *, int>> &opaqueChunks,
-    const std::vector<std::pair<Chunk *, int>> &transparentChunks,
+    const std::pmr::vector<std::pair<Chunk *, int>> &opaqueChunks,
+    const std::pmr::vector<std::pair<Chunk *, int>> &transparentChunks,
+    const glm::vec3 &cameraPos,
     const std::vector<VkDescriptorSet> &descriptorSets,
     const glm::vec3 &clearColor,
     const SkyPushConstant &sun_pc,
@@ -27,82 +51,143 @@ void CommandManager::recordCommandBuffer(
     VkBuffer skySphereVB, VkBuffer skySphereIB, uint32_t skySphereIndexCount,
     VkBuffer crosshairVB, VkBuffer crosshairIB, VkDescriptorSet crosshairDS,
     VkBuffer debugCubeVB, VkBuffer debugCubeIB, uint32_t debugCubeIndexCount,
-    const Settings &settings, const std::vector<AABB> &debugAABBs,
+    const Settings &settings, const std::pmr::vector<AABB> &debugAABBs,
     VkBuffer outlineVB,
     uint32_t outlineVertexCount,
-    const std::optional<glm::ivec3> &hoveredBlockPos)
+    const std::optional<glm::ivec3> &hoveredBlockPos,
+    const ChunkMeshPool &meshPool,
+    const IndirectChunkDraws *indirect,
+    DebugOverlay *debugOverlay)
 {
-
-    VkCommandBuffer cb = m_CommandBuffers[currentFrame];
-
-    const std::array<VkClearValue, 2> clearValues = {
-        VkClearValue{.color = {{clearColor.r, clearColor.g, clearColor.b, 1.0f}}},
-        VkClearValue{.depthStencil = {1.0f, 0}}};
-
-    VkRenderPassBeginInfo rp{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
-    rp.renderPass = m_SwapChainContext.getRenderPass();
-    rp.framebuffer = m_SwapChainContext.getFramebuffers()[imageIndex].get();
-    rp.renderArea = {{0, 0}, m_SwapChainContext.getSwapChainExtent()};
-    rp.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    rp.pClearValues = clearValues.data();
-
-    vkCmdBeginRenderPass(cb, &rp, VK_SUBPASS_CONTENTS_INLINE);
-
-    VkViewport vp{0, 0,
-                  float(m_SwapChainContext.getSwapChainExtent().width),
-                  float(m_SwapChainContext.getSwapChainExtent().height),
-                  0, 1};
-    VkRect2D sc{{0, 0}, m_SwapChainContext.getSwapChainExtent()};
-    vkCmdSetViewport(cb, 0, 1, &vp);
-    vkCmdSetScissor(cb, 0, 1, &sc);
-
-    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineCache.getSkyPipeline());
-    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                            m_PipelineCache.getSkyPipelineLayout(),
-                            0, 1, &descriptorSets[currentFrame], 0, nullptr);
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(cb, 0, 1, &skySphereVB, offsets);
-    vkCmdBindIndexBuffer(cb, skySphereIB, 0, VK_INDEX_TYPE_UINT32);
-
-    if (isSunVisible)
+    const VkExtent2D extent = m_SwapChainContext.getSwapChainExtent();
+    auto setViewport = [&](VkCommandBuffer cb)
     {
-        vkCmdPushConstants(cb, m_PipelineCache.getSkyPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SkyPushConstant), &sun_pc);
-        vkCmdDrawIndexed(cb, skySphereIndexCount, 1, 0, 0, 0);
-    }
+        VkViewport vp{0, 0, float(extent.width), float(extent.height), 0, 1};
+        VkRect2D sc{{0, 0}, extent};
+        vkCmdSetViewport(cb, 0, 1, &vp);
+        vkCmdSetScissor(cb, 0, 1, &sc);
+    };
 
-    if (isMoonVisible)
+    auto recordSky = [&](VkCommandBuffer cb)
     {
-        vkCmdPushConstants(cb, m_PipelineCache.getSkyPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SkyPushConstant), &moon_pc);
-        vkCmdDrawIndexed(cb, skySphereIndexCount, 1, 0, 0, 0);
-    }
+        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineCache.getSkyPipeline());
+        vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                m_PipelineCache.getSkyPipelineLayout(),
+                                0, 1, &descriptorSets[currentFrame], 0, nullptr);
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(cb, 0, 1, &skySphereVB, offsets);
+        vkCmdBindIndexBuffer(cb, skySphereIB, 0, VK_INDEX_TYPE_UINT32);
+
+        if (isSunVisible)
+        {
+            vkCmdPushConstants(cb, m_PipelineCache.getSkyPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SkyPushConstant), &sun_pc);
+            vkCmdDrawIndexed(cb, skySphereIndexCount, 1, 0, 0, 0);
+        }
+
+        if (isMoonVisible)
+        {
+            vkCmdPushConstants(cb, m_PipelineCache.getSkyPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SkyPushConstant), &moon_pc);
+            vkCmdDrawIndexed(cb, skySphereIndexCount, 1, 0, 0, 0);
+        }
+    };
 
     VkPipeline mainPipe = settings.wireframe
                               ? m_PipelineCache.getWireframePipeline()
                               : m_PipelineCache.getGraphicsPipeline();
 
-    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, mainPipe);
-    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                            m_PipelineCache.getGraphicsPipelineLayout(),
-                            0, 1, &descriptorSets[currentFrame], 0, nullptr);
+    constexpr uint32_t COMMAND_STRIDE = sizeof(VkDrawIndexedIndirectCommand);
 
-    uint32_t instanceOffset = 0;
-    for (uint32_t i = 0; i < opaqueChunks.size(); ++i)
+    // Draws entries [begin, end) of the opaque or transparent list. The pass's indirect draws
+    // are recorded with its first batch.
+    auto recordChunks = [&](VkCommandBuffer cb, bool transparent, size_t begin, size_t end)
     {
-        const auto &[chunk, lod] = opaqueChunks[i];
-        const ChunkMesh *mesh = chunk->getMesh(lod);
-
-        VkBuffer vertexBuffers[] = {mesh->vertexBuffer};
-        VkDeviceSize chunk_offsets[] = {0};
-        vkCmdBindVertexBuffers(cb, 0, 1, vertexBuffers, chunk_offsets);
-        vkCmdBindIndexBuffer(cb, mesh->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, transparent ? m_PipelineCache.getWaterPipeline() : mainPipe);
+        vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                m_PipelineCache.getGraphicsPipelineLayout(),
+                                0, 1, &descriptorSets[currentFrame], 0, nullptr);
 
-        vkCmdDrawIndexed(cb, mesh->indexCount, 1, 0, 0, i);
-    }
+        // Pooled meshes share the pool buffers, so those are only bound again after another mesh's.
+        VkBuffer boundVB = VK_NULL_HANDLE;
+        auto bindPool = [&]
+        {
+            if (boundVB == meshPool.getVertexBuffer())
+                return;
+            boundVB = meshPool.getVertexBuffer();
+            VkDeviceSize poolOffsets[] = {0};
+            vkCmdBindVertexBuffers(cb, 0, 1, &boundVB, poolOffsets);
+            vkCmdBindIndexBuffer(cb, meshPool.getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+        };
+        // Meshes with face ranges only draw the directions in faces, merged into as few draws as
+        // the ranges allow.
+        auto drawChunk = [&](const ChunkMesh &mesh, uint32_t instance, uint8_t faces)
+        {
+            const VulkanChunkMesh &gpu = vulkanMesh(mesh);
+            uint32_t firstIndex = 0;
+            int32_t vertexOffset = 0;
+            if (gpu.pooled)
+            {
+                bindPool();
+                firstIndex = gpu.firstIndex;
+                vertexOffset = gpu.vertexOffset;
+            }
+            else
+            {
+                boundVB = gpu.vertexBuffer.get();
+                VkDeviceSize chunk_offsets[] = {0};
+                vkCmdBindVertexBuffers(cb, 0, 1, &boundVB, chunk_offsets);
+                vkCmdBindIndexBuffer(cb, gpu.indexBuffer.get(), 0, VK_INDEX_TYPE_UINT32);
+            }
+
+            if (mesh.faces.empty())
+            {
+                vkCmdDrawIndexed(cb, mesh.indexCount, 1, firstIndex, vertexOffset, instance);
+                return;
+            }
+            mesh.faces.forEachRun(faces, [&](uint32_t first, uint32_t count)
+                                  { vkCmdDrawIndexed(cb, count, 1, firstIndex + first, vertexOffset, instance); });
+        };
+
+        if (indirect && begin == 0 && !transparent && indirect->opaqueDraws > 0)
+        {
+            bindPool();
+            if (indirect->countBuffer != VK_NULL_HANDLE && m_vkCmdDrawIndexedIndirectCount)
+                m_vkCmdDrawIndexedIndirectCount(cb, indirect->commandBuffer, 0, indirect->countBuffer, 0,
+                                                indirect->opaqueDraws, COMMAND_STRIDE);
+            else
+                vkCmdDrawIndexedIndirect(cb, indirect->commandBuffer, 0, indirect->opaqueDraws, COMMAND_STRIDE);
+        }
+        if (indirect && begin == 0 && transparent && indirect->transparentDraws > 0)
+        {
+            bindPool();
+            vkCmdDrawIndexedIndirect(cb, indirect->commandBuffer, VkDeviceSize(indirect->opaqueDraws) * COMMAND_STRIDE,
+                                     indirect->transparentDraws, COMMAND_STRIDE);
+        }
 
-    instanceOffset += static_cast<uint32_t>(opaqueChunks.size());
+        // A chunk's origin slot is its instance, which the vertex shaders look its origin up with.
+        if (transparent)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto &[chunk, lod] = transparentChunks[i];
+                drawChunk(*chunk->getTransparentMesh(lod), chunk->m_OriginSlot, SectionGraph::ALL_FACES);
+            }
+        }
+        else
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto &[chunk, lod] = opaqueChunks[i];
+                const ChunkMesh &mesh = *chunk->getMesh(lod);
+                drawChunk(mesh, chunk->m_OriginSlot, facesTowardCamera(cameraPos, *chunk, mesh));
+            }
+        }
+    };
 
-    if (outlineVertexCount > 0 && hoveredBlockPos)
+    auto recordOutline = [&](VkCommandBuffer cb)
     {
+        if (outlineVertexCount == 0 || !hoveredBlockPos)
+            return;
+
         vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineCache.getOutlinePipeline());
         vkCmdSetLineWidth(cb, 2.0f);
         vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -116,55 +201,271 @@ void CommandManager::recordCommandBuffer(
                            VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &model);
 
         vkCmdDraw(cb, outlineVertexCount, 1, 0, 0);
-    }
+    };
 
-    if (!settings.wireframe)
+    auto recordOverlays = [&](VkCommandBuffer cb)
     {
-        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineCache.getWaterPipeline());
-
-        for (uint32_t i = 0; i < transparentChunks.size(); ++i)
+        if (settings.showCollisionBoxes && !debugAABBs.empty())
         {
-            const auto &[chunk, lod] = transparentChunks[i];
-            const ChunkMesh *mesh = chunk->getTransparentMesh(lod);
+            vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineCache.getDebugPipeline());
+            vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    m_PipelineCache.getDebugPipelineLayout(),
+                                    0, 1, &descriptorSets[currentFrame], 0, nullptr);
+            VkBuffer vertexBuffers[] = {debugCubeVB};
+            VkDeviceSize debug_offsets[] = {0};
+            vkCmdBindVertexBuffers(cb, 0, 1, vertexBuffers, debug_offsets);
+            vkCmdBindIndexBuffer(cb, debugCubeIB, 0, VK_INDEX_TYPE_UINT32);
+
+            for (const auto &aabb : debugAABBs)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), aabb.min);
+                model = glm::scale(model, aabb.max - aabb.min);
+                vkCmdPushConstants(cb, m_PipelineCache.getDebugPipelineLayout(),
+                                   VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &model);
+                vkCmdDrawIndexed(cb, debugCubeIndexCount, 1, 0, 0, 0);
+            }
+        }
+
+        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineCache.getCrosshairPipeline());
+        vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineCache.getCrosshairPipelineLayout(), 0, 1, &crosshairDS, 0, nullptr);
+        VkDeviceSize crosshair_offsets[] = {0};
+        vkCmdBindVertexBuffers(cb, 0, 1, &crosshairVB, crosshair_offsets);
+        vkCmdBindIndexBuffer(cb, crosshairIB, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdDrawIndexed(cb, 6, 1, 0, 0, 0);
+
+        if (debugOverlay)
+            debugOverlay->draw(cb, currentFrame);
+    };
 
-            VkBuffer vertexBuffers[] = {mesh->vertexBuffer};
-            VkDeviceSize chunk_offsets[] = {0};
-            vkCmdBindVertexBuffers(cb, 0, 1, vertexBuffers, chunk_offsets);
-            vkCmdBindIndexBuffer(cb, mesh->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    VkCommandBuffer primary = m_CommandBuffers[currentFrame];
 
-            vkCmdDrawIndexed(cb, mesh->indexCount, 1, 0, 0, instanceOffset + i);
+    const std::array<VkClearValue, 2> clearValues = {
+        VkClearValue{.color = {{clearColor.r, clearColor.g, clearColor.b, 1.0f}}},
+        VkClearValue{.depthStencil = {1.0f, 0}}};
+
+    VkRenderPassBeginInfo rp{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+    rp.renderPass = m_SwapChainContext.getRenderPass();
+    rp.framebuffer = m_SwapChainContext.getFramebuffers()[imageIndex].get();
+    rp.renderArea = {{0, 0}, extent};
+    rp.clearValueCount = static_cast<uint32_t>(clearValues.size());
+    rp.pClearValues = clearValues.data();
+
+    const bool drawTransparent = !settings.wireframe;
+    const size_t listDraws = opaqueChunks.size() + (drawTransparent ? transparentChunks.size() : 0);
+    if (!m_Recorders || listDraws < 2 * MIN_DRAWS_PER_SECONDARY)
+    {
+        vkCmdBeginRenderPass(primary, &rp, VK_SUBPASS_CONTENTS_INLINE);
+        setViewport(primary);
+        recordSky(primary);
+        recordChunks(primary, false, 0, opaqueChunks.size());
+        recordOutline(primary);
+        if (drawTransparent)
+            recordChunks(primary, true, 0, transparentChunks.size());
+        recordOverlays(primary);
+        vkCmdEndRenderPass(primary);
+        return;
+    }
+
+    // Everything in the render pass goes into secondaries, in draw order. The chunk lists are
+    // split into batches recorded on the recording threads; those secondaries are kept per frame
+    // slot and only recorded again when what they would draw changes, so a still camera costs
+    // just the small per-frame parts.
+    ChunkSecondaries &chunkParts = m_ChunkSecondaries[currentFrame];
+    const uint64_t key = chunkDrawKey(opaqueChunks, transparentChunks, cameraPos, drawTransparent, descriptorSets[currentFrame], mainPipe,
+                                      meshPool, indirect, rp.renderPass, extent);
+    if (!chunkParts.valid || chunkParts.key != key)
+    {
+        VC_PROFILE_ZONE("Record chunk secondaries");
+        m_Parts.clear();
+        auto addBatches = [&](bool transparent, size_t count)
+        {
+            const size_t batches = std::clamp<size_t>(count / MIN_DRAWS_PER_SECONDARY, 1, m_Recorders->concurrency());
+            for (size_t b = 0; b < batches; ++b)
+                m_Parts.push_back({transparent, count * b / batches, count * (b + 1) / batches});
+        };
+        addBatches(false, opaqueChunks.size());
+        chunkParts.opaqueParts = m_Parts.size();
+        if (drawTransparent)
+            addBatches(true, transparentChunks.size());
+
+        // Any thread may end up recording every part, so each has enough secondaries up front and
+        // nothing on the recording threads can fail.
+        std::vector<RecordingPool> &pools = m_RecordingPools[currentFrame];
+        for (RecordingPool &pool : pools)
+        {
+            vkResetCommandPool(m_DeviceContext.getDevice(), pool.pool.get(), 0);
+            pool.used = 0;
+            reserveSecondaries(pool, m_Parts.size());
         }
+        chunkParts.valid = false;
+        chunkParts.buffers.assign(m_Parts.size(), VK_NULL_HANDLE);
+
+        // No framebuffer, so the batches stay valid whichever swapchain image they are drawn to.
+        VkCommandBufferInheritanceInfo inheritance{VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+        inheritance.renderPass = rp.renderPass;
+        inheritance.subpass = 0;
+
+        m_Recorders->run(m_Parts.size(), 1, [&](size_t begin, size_t end, size_t slot)
+                         {
+            VC_PROFILE_ZONE("Record secondaries");
+            RecordingPool &pool = pools[slot];
+            for (size_t i = begin; i < end; ++i)
+            {
+                VkCommandBuffer cb = pool.buffers[pool.used++];
+                VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+                bi.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+                bi.pInheritanceInfo = &inheritance;
+                vkBeginCommandBuffer(cb, &bi);
+                setViewport(cb);
+                recordChunks(cb, m_Parts[i].transparent, m_Parts[i].begin, m_Parts[i].end);
+                if (vkEndCommandBuffer(cb) == VK_SUCCESS)
+                    chunkParts.buffers[i] = cb;
+            } });
+
+        if (std::find(chunkParts.buffers.begin(), chunkParts.buffers.end(), VK_NULL_HANDLE) != chunkParts.buffers.end())
+            throw std::runtime_error("failed to record secondary command buffer");
+        chunkParts.key = key;
+        chunkParts.valid = true;
     }
 
-    if (settings.showCollisionBoxes && !debugAABBs.empty())
+    RecordingPool &framePool = m_FramePools[currentFrame];
+    vkResetCommandPool(m_DeviceContext.getDevice(), framePool.pool.get(), 0);
+    framePool.used = 0;
+    reserveSecondaries(framePool, 3);
+
+    VkCommandBufferInheritanceInfo inheritance{VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+    inheritance.renderPass = rp.renderPass;
+    inheritance.subpass = 0;
+    inheritance.framebuffer = rp.framebuffer;
+    auto recordFramePart = [&](auto &&record)
     {
-        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineCache.getDebugPipeline());
-        vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                m_PipelineCache.getDebugPipelineLayout(),
-                                0, 1, &descriptorSets[currentFrame], 0, nullptr);
-        VkBuffer vertexBuffers[] = {debugCubeVB};
-        VkDeviceSize debug_offsets[] = {0};
-        vkCmdBindVertexBuffers(cb, 0, 1, vertexBuffers, debug_offsets);
-        vkCmdBindIndexBuffer(cb, debugCubeIB, 0, VK_INDEX_TYPE_UINT32);
+        VkCommandBuffer cb = framePool.buffers[framePool.used++];
+        VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        bi.pInheritanceInfo = &inheritance;
+        vkBeginCommandBuffer(cb, &bi);
+        setViewport(cb);
+        record(cb);
+        if (vkEndCommandBuffer(cb) != VK_SUCCESS)
+            throw std::runtime_error("failed to record secondary command buffer");
+        return cb;
+    };
+
+    m_Secondaries.clear();
+    m_Secondaries.push_back(recordFramePart(recordSky));
+    m_Secondaries.insert(m_Secondaries.end(), chunkParts.buffers.begin(), chunkParts.buffers.begin() + chunkParts.opaqueParts);
+    m_Secondaries.push_back(recordFramePart(recordOutline));
+    m_Secondaries.insert(m_Secondaries.end(), chunkParts.buffers.begin() + chunkParts.opaqueParts, chunkParts.buffers.end());
+    m_Secondaries.push_back(recordFramePart(recordOverlays));
+
+    vkCmdBeginRenderPass(primary, &rp, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(primary, static_cast<uint32_t>(m_Secondaries.size()), m_Secondaries.data());
+    vkCmdEndRenderPass(primary);
+}
 
-        for (const auto &aabb : debugAABBs)
+// Covers everything the chunk secondaries record, down to each draw's mesh upload, so equal
+// keys mean the recorded commands would be the same.
+uint64_t CommandManager::chunkDrawKey(const std::pmr::vector<std::pair<Chunk *, int>> &opaqueChunks,
+                                      const std::pmr::vector<std::pair<Chunk *, int>> &transparentChunks,
+                                      const glm::vec3 &cameraPos, bool drawTransparent, VkDescriptorSet descriptorSet, VkPipeline mainPipe, const ChunkMeshPool &meshPool,
+                                      const IndirectChunkDraws *indirect, VkRenderPass renderPass, VkExtent2D extent) const
+{
+    uint64_t h = 0;
+    auto mix = [&h](uint64_t v)
+    { h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+    auto mixHandle = [&mix](auto handle)
+    { mix((uint64_t)handle); };
+
+    mixHandle(descriptorSet);
+    mixHandle(mainPipe);
+    mixHandle(m_PipelineCache.getWaterPipeline());
+    mixHandle(meshPool.getVertexBuffer());
+    mixHandle(renderPass);
+    mix(uint64_t(extent.width) << 32 | extent.height);
+    if (indirect)
+    {
+        mixHandle(indirect->commandBuffer);
+        mixHandle(indirect->countBuffer);
+        mix(uint64_t(indirect->opaqueDraws) << 32 | indirect->transparentDraws);
+    }
+
+    auto mixList = [&](const std::pmr::vector<std::pair<Chunk *, int>> &list, bool transparent)
+    {
+        mix(list.size());
+        for (const auto &[chunk, lod] : list)
         {
-            glm::mat4 model = glm::translate(glm::mat4(1.0f), aabb.min);
-            model = glm::scale(model, aabb.max - aabb.min);
-            vkCmdPushConstants(cb, m_PipelineCache.getDebugPipelineLayout(),
-                               VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &model);
-            vkCmdDrawIndexed(cb, debugCubeIndexCount, 1, 0, 0, 0);
+            const ChunkMesh &mesh = transparent ? *chunk->getTransparentMesh(lod) : *chunk->getMesh(lod);
+            mix(vulkanMesh(mesh).generation);
+            mix(chunk->m_OriginSlot);
+            if (!transparent)
+                mix(facesTowardCamera(cameraPos, *chunk, mesh));
         }
+    };
+    mixList(opaqueChunks, false);
+    if (drawTransparent)
+        mixList(transparentChunks, true);
+    return h;
+}
+
+void CommandManager::invalidateSecondaries()
+{
+    for (ChunkSecondaries &chunkParts : m_ChunkSecondaries)
+        chunkParts.valid = false;
+}
+
+void CommandManager::reserveSecondaries(RecordingPool &pool, size_t count)
+{
+    if (pool.buffers.size() >= count)
+        return;
+
+    const size_t first = pool.buffers.size();
+    pool.buffers.resize(count);
+
+    VkCommandBufferAllocateInfo allocInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    allocInfo.commandPool = pool.pool.get();
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = static_cast<uint32_t>(count - first);
+    if (vkAllocateCommandBuffers(m_DeviceContext.getDevice(), &allocInfo, pool.buffers.data() + first) != VK_SUCCESS)
+    {
+        pool.buffers.resize(first);
+        throw std::runtime_error("failed to allocate secondary command buffers");
     }
+}
 
-    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineCache.getCrosshairPipeline());
-    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineCache.getCrosshairPipelineLayout(), 0, 1, &crosshairDS, 0, nullptr);
-    VkDeviceSize crosshair_offsets[] = {0};
-    vkCmdBindVertexBuffers(cb, 0, 1, &crosshairVB, crosshair_offsets);
-    vkCmdBindIndexBuffer(cb, crosshairIB, 0, VK_INDEX_TYPE_UINT32);
-    vkCmdDrawIndexed(cb, 6, 1, 0, 0, 0);
+void CommandManager::recordChunkCull(VkCommandBuffer cb, VkDescriptorSet cullSet, const ChunkCullPushConstants &pc,
+                                     VkBuffer commandBuffer, VkBuffer countBuffer)
+{
+    vkCmdFillBuffer(cb, countBuffer, 0, sizeof(uint32_t), 0);
+
+    VkMemoryBarrier clearBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineCache.getChunkCullPipeline());
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineCache.getChunkCullPipelineLayout(),
+                            0, 1, &cullSet, 0, nullptr);
+    vkCmdPushConstants(cb, m_PipelineCache.getChunkCullPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT,
+                       0, sizeof(ChunkCullPushConstants), &pc);
 
-    vkCmdEndRenderPass(cb);
+    constexpr uint32_t WORKGROUP_SIZE = 64;
+    vkCmdDispatch(cb, (pc.totalDraws + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    std::array<VkBufferMemoryBarrier, 2> barriers{};
+    for (auto &b : barriers)
+    {
+        b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        b.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        b.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        b.size = VK_WHOLE_SIZE;
+    }
+    barriers[0].buffer = commandBuffer;
+    barriers[1].buffer = countBuffer;
+    vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         0, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
 }
 
 void CommandManager::createCommandPool()
@@ -183,6 +484,37 @@ void CommandManager::createCommandPool()
     m_CommandPool = VulkanHandle<VkCommandPool, CommandPoolDeleter>(pool, {m_DeviceContext.getDevice()});
 }
 
+// Per frame in flight, one pool per recording thread for the chunk batches, so threads never
+// share a pool, and one for the parts recorded every frame. Each is reset in one go once the
+// frame's fence has signalled.
+void CommandManager::createRecordingPools()
+{
+    DeviceContext::QueueFamilyIndices queueFamilyIndices = m_DeviceContext.findQueueFamilies(m_DeviceContext.getPhysicalDevice());
+    VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+
+    for (RecordingPool &pool : m_FramePools)
+    {
+        VkCommandPool handle;
+        if (vkCreateCommandPool(m_DeviceContext.getDevice(), &poolInfo, nullptr, &handle) != VK_SUCCESS)
+            throw std::runtime_error("failed to create recording command pool!");
+        pool.pool = VulkanHandle<VkCommandPool, CommandPoolDeleter>(handle, {m_DeviceContext.getDevice()});
+    }
+
+    for (auto &framePools : m_RecordingPools)
+    {
+        framePools.resize(m_Recorders->concurrency());
+        for (RecordingPool &pool : framePools)
+        {
+            VkCommandPool handle;
+            if (vkCreateCommandPool(m_DeviceContext.getDevice(), &poolInfo, nullptr, &handle) != VK_SUCCESS)
+                throw std::runtime_error("failed to create recording command pool!");
+            pool.pool = VulkanHandle<VkCommandPool, CommandPoolDeleter>(handle, {m_DeviceContext.getDevice()});
+        }
+    }
+}
+
 void CommandManager::createCommandBuffers()
 {
     m_CommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <array>
 #include <memory>
+#include <memory_resource>
 #include <map>
 #include <optional>
 #include "../../math/Ivec3Less.h"
@@ -12,26 +14,48 @@
 #include "../pipeline/PipelineCache.h"
 #include "../../Chunk.h"
 #include "../../Camera.h"
+#include "../../ParallelFor.h"
 #include "../RendererConfig.h"
 #include "../RayTracingPushConstants.h"
+#include "../ChunkCullPushConstants.h"
 #include <vulkan/vulkan.h>
 
+class DebugOverlay;
+class ChunkMeshPool;
+
 struct SkyPushConstant
 {
     glm::mat4 model;
     alignas(4) int is_sun;
 };
 
+// Chunk draws written by the GPU culling pass for meshes in the mesh pool: opaque commands
+// first, then transparent ones. With a count buffer the visible opaque commands are packed
+// and counted there; without one every opaque command is drawn and culled ones have no
+// instances. The draw lists passed alongside hold the meshes that are not pooled.
+struct IndirectChunkDraws
+{
+    VkBuffer commandBuffer = VK_NULL_HANDLE;
+    VkBuffer countBuffer = VK_NULL_HANDLE;
+    uint32_t opaqueDraws = 0;
+    uint32_t transparentDraws = 0;
+};
+
 class CommandManager
 {
 public:
-    CommandManager(const DeviceContext &deviceContext, const SwapChainContext &swapChainContext, const PipelineCache &pipelineCache);
+    // With recordingThreads > 0, frames with enough chunk draws are recorded into secondary
+    // command buffers on that many helper threads plus the caller, and a frame slot's chunk
+    // secondaries are reused while its draw lists stay the same.
+    CommandManager(const DeviceContext &deviceContext, const SwapChainContext &swapChainContext, const PipelineCache &pipelineCache,
+                   size_t recordingThreads = 0);
     ~CommandManager();
 
     void recordCommandBuffer(
         uint32_t imageIndex, uint32_t currentFrame,
-        const std::vector<std::pair<Chunk *, int>> &opaqueChunks,
-        const std::vector<std::pair<Chunk *, int>> &transparentChunks,
+        const std::pmr::vector<std::pair<Chunk *, int>> &opaqueChunks,
+        const std::pmr::vector<std::pair<Chunk *, int>> &transparentChunks,
+        const glm::vec3 &cameraPos,
         const std::vector<VkDescriptorSet> &descriptorSets,
         const glm::vec3 &clearColor,
         const SkyPushConstant &sun_pc,
@@ -41,10 +65,21 @@ public:
         VkBuffer skySphereVB, VkBuffer skySphereIB, uint32_t skySphereIndexCount,
         VkBuffer crosshairVB, VkBuffer crosshairIB, VkDescriptorSet crosshairDS,
         VkBuffer debugCubeVB, VkBuffer debugCubeIB, uint32_t debugCubeIndexCount,
-        const Settings &settings, const std::vector<AABB> &debugAABBs,
+        const Settings &settings, const std::pmr::vector<AABB> &debugAABBs,
         VkBuffer outlineVB,
         uint32_t outlineVertexCount,
-        const std::optional<glm::ivec3> &hoveredBlockPos);
+        const std::optional<glm::ivec3> &hoveredBlockPos,
+        const ChunkMeshPool &meshPool,
+        const IndirectChunkDraws *indirect = nullptr,
+        DebugOverlay *debugOverlay = nullptr);
+
+    // Resets the draw count, runs chunk_cull.comp over pc.totalDraws table entries and makes
+    // its output visible to indirect draws. Recorded outside the render pass.
+    void recordChunkCull(VkCommandBuffer cb, VkDescriptorSet cullSet, const ChunkCullPushConstants &pc,
+                         VkBuffer commandBuffer, VkBuffer countBuffer);
+
+    // Drops the cached chunk secondaries, for when the render pass or pipelines are rebuilt.
+    void invalidateSecondaries();
 
     VkCommandBuffer getCommandBuffer(uint32_t index) const { return m_CommandBuffers[index]; }
     VkCommandPool getCommandPool() const { return m_CommandPool.get(); }
@@ -56,8 +91,41 @@ public:
                                const void *pushConstants, VkImage shadowImage);
 
 private:
+    // Chunk list entries [begin, end) recorded into one secondary.
+    struct Part
+    {
+        bool transparent;
+        size_t begin;
+        size_t end;
+    };
+
+    struct RecordingPool
+    {
+        VulkanHandle<VkCommandPool, CommandPoolDeleter> pool;
+        std::vector<VkCommandBuffer> buffers;
+        size_t used = 0;
+    };
+
+    // A frame slot's chunk batches, opaque ones first, and the key they were recorded for.
+    struct ChunkSecondaries
+    {
+        std::vector<VkCommandBuffer> buffers;
+        size_t opaqueParts = 0;
+        uint64_t key = 0;
+        bool valid = false;
+    };
+
+    // Below this many draws per batch the secondaries cost more than they save.
+    static constexpr size_t MIN_DRAWS_PER_SECONDARY = 128;
+
     void createCommandPool();
     void createCommandBuffers();
+    void createRecordingPools();
+    void reserveSecondaries(RecordingPool &pool, size_t count);
+    uint64_t chunkDrawKey(const std::pmr::vector<std::pair<Chunk *, int>> &opaqueChunks,
+                          const std::pmr::vector<std::pair<Chunk *, int>> &transparentChunks,
+                          const glm::vec3 &cameraPos, bool drawTransparent, VkDescriptorSet descriptorSet, VkPipeline mainPipe, const ChunkMeshPool &meshPool,
+                          const IndirectChunkDraws *indirect, VkRenderPass renderPass, VkExtent2D extent) const;
 
     const DeviceContext &m_DeviceContext;
     const SwapChainContext &m_SwapChainContext;
@@ -65,4 +133,12 @@ private:
 
     VulkanHandle<VkCommandPool, CommandPoolDeleter> m_CommandPool;
     std::vector<VkCommandBuffer> m_CommandBuffers;
+    PFN_vkCmdDrawIndexedIndirectCount m_vkCmdDrawIndexedIndirectCount = nullptr;
+
+    std::unique_ptr<ParallelFor> m_Recorders;
+    std::array<std::vector<RecordingPool>, MAX_FRAMES_IN_FLIGHT> m_RecordingPools;
+    std::array<RecordingPool, MAX_FRAMES_IN_FLIGHT> m_FramePools;
+    std::array<ChunkSecondaries, MAX_FRAMES_IN_FLIGHT> m_ChunkSecondaries;
+    std::vector<Part> m_Parts;
+    std::vector<VkCommandBuffer> m_Secondaries;
 };
\ No newline at end of file
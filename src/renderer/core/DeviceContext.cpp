@@ -8,7 +8,8 @@ DeviceContext::DeviceContext(const InstanceContext &instanceContext)
 {
     pickPhysicalDevice();
     checkRayTracingSupport();
-    
+    checkIndirectDrawSupport();
+
     {
         VkPhysicalDeviceAccelerationStructurePropertiesKHR asProps{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR};
         VkPhysicalDeviceProperties2 props2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
@@ -97,6 +98,22 @@ void DeviceContext::checkRayTracingSupport()
     }
 }
 
+void DeviceContext::checkIndirectDrawSupport()
+{
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(m_PhysicalDevice, &props);
+    m_vulkan12Supported = props.apiVersion >= VK_API_VERSION_1_2;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    VkPhysicalDeviceFeatures2 deviceFeatures2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+    if (m_vulkan12Supported)
+        deviceFeatures2.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &deviceFeatures2);
+
+    m_multiDrawIndirectSupported = deviceFeatures2.features.multiDrawIndirect && deviceFeatures2.features.drawIndirectFirstInstance;
+    m_drawIndirectCountSupported = m_multiDrawIndirectSupported && vulkan12Features.drawIndirectCount;
+}
+
 void DeviceContext::createLogicalDevice()
 {
     QueueFamilyIndices idx = findQueueFamilies(m_PhysicalDevice);
@@ -121,6 +138,8 @@ void DeviceContext::createLogicalDevice()
     features.fillModeNonSolid = VK_TRUE;
     features.logicOp = VK_TRUE;
     features.shaderStorageImageWriteWithoutFormat = VK_TRUE;
+    features.multiDrawIndirect = m_multiDrawIndirectSupported;
+    features.drawIndirectFirstInstance = m_multiDrawIndirectSupported;
 
     VkDeviceCreateInfo ci{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
     ci.queueCreateInfoCount = static_cast<uint32_t>(qInfos.size());
@@ -132,6 +151,8 @@ void DeviceContext::createLogicalDevice()
     VkPhysicalDeviceAccelerationStructureFeaturesKHR accelFeatures{};
     VkPhysicalDeviceRayTracingPipelineFeaturesKHR pipelineFeatures{};
     VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures{};
+    VkPhysicalDeviceVulkan12Features vulkan12Features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    vulkan12Features.drawIndirectCount = m_drawIndirectCountSupported;
 
     if (m_rayTracingSupported)
     {
@@ -141,12 +162,27 @@ void DeviceContext::createLogicalDevice()
         pipelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR;
         pipelineFeatures.rayTracingPipeline = VK_TRUE;
 
-        bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-        bufferDeviceAddressFeatures.bufferDeviceAddress = VK_TRUE;
-
-        ci.pNext = &bufferDeviceAddressFeatures;
-        bufferDeviceAddressFeatures.pNext = &accelFeatures;
         accelFeatures.pNext = &pipelineFeatures;
+        ci.pNext = &accelFeatures;
+
+        // The 1.2 feature struct must not be chained next to the structs it replaces.
+        if (m_vulkan12Supported)
+        {
+            vulkan12Features.bufferDeviceAddress = VK_TRUE;
+        }
+        else
+        {
+            bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+            bufferDeviceAddressFeatures.bufferDeviceAddress = VK_TRUE;
+            bufferDeviceAddressFeatures.pNext = &accelFeatures;
+            ci.pNext = &bufferDeviceAddressFeatures;
+        }
+    }
+
+    if (m_vulkan12Supported)
+    {
+        vulkan12Features.pNext = const_cast<void *>(ci.pNext);
+        ci.pNext = &vulkan12Features;
     }
 
 #ifndef NDEBUG
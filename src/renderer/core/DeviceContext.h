@@ -19,6 +19,10 @@ public:
     VkQueue getTransferQueue() const { return m_TransferQueue; }
     bool hasTransferQueue() const { return m_TransferQueue != VK_NULL_HANDLE; }
     bool isRayTracingSupported() const { return m_rayTracingSupported; }
+    // Many draws per indirect call, with firstInstance honoured.
+    bool isMultiDrawIndirectSupported() const { return m_multiDrawIndirectSupported; }
+    // vkCmdDrawIndexedIndirectCount, core in Vulkan 1.2 but optional.
+    bool isDrawIndirectCountSupported() const { return m_drawIndirectCountSupported; }
     uint32_t getScratchAlignment() const { return m_asScratchAlignment; }
 
     struct QueueFamilyIndices
@@ -37,6 +41,7 @@ private:
     bool isDeviceSuitable(VkPhysicalDevice device);
     bool checkDeviceExtensionSupport(VkPhysicalDevice device);
     void checkRayTracingSupport();
+    void checkIndirectDrawSupport();
 
     const InstanceContext &m_InstanceContext;
     VkPhysicalDevice m_PhysicalDevice{VK_NULL_HANDLE};
@@ -48,6 +53,9 @@ private:
     VkQueue m_TransferQueue{VK_NULL_HANDLE};
 
     bool m_rayTracingSupported = false;
+    bool m_vulkan12Supported = false;
+    bool m_multiDrawIndirectSupported = false;
+    bool m_drawIndirectCountSupported = false;
     uint32_t m_asScratchAlignment = 256;
     std::vector<const char *> m_deviceExtensions{VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
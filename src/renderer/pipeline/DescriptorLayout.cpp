@@ -5,6 +5,7 @@
 DescriptorLayout::DescriptorLayout(const DeviceContext &deviceContext) : m_DeviceContext(deviceContext)
 {
     createDescriptorSetLayout();
+    createChunkCullSetLayout();
 }
 
 DescriptorLayout::~DescriptorLayout() {}
@@ -60,4 +61,27 @@ void DescriptorLayout::createDescriptorSetLayout()
         throw std::runtime_error("failed to create descriptor set layout");
     }
     m_DescriptorSetLayout = VulkanHandle<VkDescriptorSetLayout, DescriptorSetLayoutDeleter>(layout, {m_DeviceContext.getDevice()});
-}
\ No newline at end of file
+}
+
+void DescriptorLayout::createChunkCullSetLayout()
+{
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); ++i)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo info{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    info.bindingCount = static_cast<uint32_t>(bindings.size());
+    info.pBindings = bindings.data();
+
+    VkDescriptorSetLayout layout;
+    if (vkCreateDescriptorSetLayout(m_DeviceContext.getDevice(), &info, nullptr, &layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create chunk cull descriptor set layout");
+    }
+    m_ChunkCullSetLayout = VulkanHandle<VkDescriptorSetLayout, DescriptorSetLayoutDeleter>(layout, {m_DeviceContext.getDevice()});
+}
@@ -9,10 +9,14 @@ public:
     ~DescriptorLayout();
 
     VkDescriptorSetLayout getDescriptorSetLayout() const { return m_DescriptorSetLayout.get(); }
+    // Draw table, indirect commands and draw count of chunk_cull.comp.
+    VkDescriptorSetLayout getChunkCullSetLayout() const { return m_ChunkCullSetLayout.get(); }
 
 private:
     void createDescriptorSetLayout();
+    void createChunkCullSetLayout();
 
     const DeviceContext& m_DeviceContext;
     VulkanHandle<VkDescriptorSetLayout, DescriptorSetLayoutDeleter> m_DescriptorSetLayout;
+    VulkanHandle<VkDescriptorSetLayout, DescriptorSetLayoutDeleter> m_ChunkCullSetLayout;
 };
@@ -1,6 +1,7 @@
 #include "PipelineCache.h"
-#include "../Vertex.h"
+#include "../VertexLayout.h"
 #include "../RayTracingPushConstants.h"
+#include "../ChunkCullPushConstants.h"
 #include "../command/CommandManager.h"
 
 #include <glm/glm.hpp>
@@ -8,6 +9,13 @@
 #include <vector>
 #include <array>
 #include <stdexcept>
+#include <future>
+#include <functional>
+#include <chrono>
+#include <iostream>
+
+using hrc = std::chrono::high_resolution_clock;
+using milli = std::chrono::duration<double, std::milli>;
 
 namespace
 {
@@ -39,6 +47,7 @@ namespace
     }
 
     VkPipeline buildPipeline(VkDevice device,
+                             VkPipelineCache cache,
                              VkRenderPass renderPass,
                              VkPipelineLayout layout,
                              VkPolygonMode polyMode,
@@ -56,8 +65,8 @@ namespace
             {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, vert.get(), "main"},
             {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, frag.get(), "main"}};
 
-        const auto binding = Vertex::getBindingDescription();
-        const auto attrs = Vertex::getAttributeDescriptions();
+        const auto binding = VertexLayout::getBindingDescription();
+        const auto attrs = VertexLayout::getAttributeDescriptions();
 
         VkPipelineVertexInputStateCreateInfo vin{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
         vin.vertexBindingDescriptionCount = 1;
@@ -124,7 +133,7 @@ namespace
         info.subpass = 0;
 
         VkPipeline pipe{};
-        if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &pipe) != VK_SUCCESS)
+        if (vkCreateGraphicsPipelines(device, cache, 1, &info, nullptr, &pipe) != VK_SUCCESS)
             throw std::runtime_error("vkCreateGraphicsPipelines failed for " + vertShaderPath);
 
         return pipe;
@@ -136,14 +145,10 @@ PipelineCache::PipelineCache(const DeviceContext &deviceContext,
                              const DescriptorLayout &descriptorLayout)
     : m_DeviceContext(deviceContext),
       m_SwapChainContext(swapChainContext),
-      m_DescriptorLayout(descriptorLayout)
+      m_DescriptorLayout(descriptorLayout),
+      m_CacheFile(deviceContext, PIPELINE_CACHE_PATH)
 {
     createPipelines();
-
-    if (m_DeviceContext.isRayTracingSupported())
-    {
-        createRayTracingPipeline();
-    }
 }
 
 PipelineCache::~PipelineCache() = default;
@@ -164,28 +169,54 @@ void PipelineCache::createPipelines()
 
     VkDevice dev = m_DeviceContext.getDevice();
     VkRenderPass rp = m_SwapChainContext.getRenderPass();
+    VkPipelineCache cache = m_CacheFile.get();
+    VkPipelineLayout layout = m_PipelineLayout.get();
 
     const std::string defaultVert = "shaders/shader.vert.spv";
     const std::string defaultFrag = "shaders/shader.frag.spv";
     const std::string waterVert = "shaders/water.vert.spv";
     const std::string waterFrag = "shaders/water.frag.spv";
 
-    m_GraphicsPipeline = VulkanHandle<VkPipeline, PipelineDeleter>(
-        buildPipeline(dev, rp, m_PipelineLayout.get(), VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, false, true, true, defaultVert, defaultFrag), {dev});
-
-    m_TransparentPipeline = VulkanHandle<VkPipeline, PipelineDeleter>(
-        buildPipeline(dev, rp, m_PipelineLayout.get(), VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, true, false, true, defaultVert, defaultFrag), {dev});
-
-    m_WaterPipeline = VulkanHandle<VkPipeline, PipelineDeleter>(
-        buildPipeline(dev, rp, m_PipelineLayout.get(), VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, true, false, true, waterVert, waterFrag), {dev});
+    const auto t0 = hrc::now();
+
+    std::vector<std::function<void()>> jobs = {
+        [&]
+        { m_GraphicsPipeline = VulkanHandle<VkPipeline, PipelineDeleter>(
+              buildPipeline(dev, cache, rp, layout, VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, false, true, true, defaultVert, defaultFrag), {dev}); },
+        [&]
+        { m_TransparentPipeline = VulkanHandle<VkPipeline, PipelineDeleter>(
+              buildPipeline(dev, cache, rp, layout, VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, true, false, true, defaultVert, defaultFrag), {dev}); },
+        [&]
+        { m_WaterPipeline = VulkanHandle<VkPipeline, PipelineDeleter>(
+              buildPipeline(dev, cache, rp, layout, VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, true, false, true, waterVert, waterFrag), {dev}); },
+        [&]
+        { m_WireframePipeline = VulkanHandle<VkPipeline, PipelineDeleter>(
+              buildPipeline(dev, cache, rp, layout, VK_POLYGON_MODE_LINE, VK_CULL_MODE_BACK_BIT, false, true, true, defaultVert, defaultFrag), {dev}); },
+        [&]
+        { createSkyPipeline(); },
+        [&]
+        { createDebugPipeline(); },
+        [&]
+        { createCrosshairPipeline(); },
+        [&]
+        { createOutlinePipeline(); }};
 
-    m_WireframePipeline = VulkanHandle<VkPipeline, PipelineDeleter>(
-        buildPipeline(dev, rp, m_PipelineLayout.get(), VK_POLYGON_MODE_LINE, VK_CULL_MODE_BACK_BIT, false, true, true, defaultVert, defaultFrag), {dev});
-
-    createSkyPipeline();
-    createDebugPipeline();
-    createCrosshairPipeline();
-    createOutlinePipeline();
+    if (m_DeviceContext.isRayTracingSupported())
+        jobs.push_back([&]
+                       { createRayTracingPipeline(); });
+    if (m_DeviceContext.isMultiDrawIndirectSupported())
+        jobs.push_back([&]
+                       { createChunkCullPipeline(); });
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(jobs.size());
+    for (auto &job : jobs)
+        pending.push_back(std::async(std::launch::async, job));
+    for (auto &f : pending)
+        f.get();
+
+    std::cout << "[PipelineCache] Created " << jobs.size() << " pipelines in " << milli(hrc::now() - t0).count()
+              << " ms (" << (m_CacheFile.wasLoaded() ? "warm" : "cold") << " cache)\n";
 }
 
 void PipelineCache::createRayTracingPipeline()
@@ -268,7 +299,7 @@ void PipelineCache::createRayTracingPipeline()
 
     auto vkCreateRayTracingPipelinesKHR = (PFN_vkCreateRayTracingPipelinesKHR)vkGetDeviceProcAddr(device, "vkCreateRayTracingPipelinesKHR");
     VkPipeline rtPipeline;
-    if (vkCreateRayTracingPipelinesKHR(device, VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &rtPipeline) != VK_SUCCESS)
+    if (vkCreateRayTracingPipelinesKHR(device, VK_NULL_HANDLE, m_CacheFile.get(), 1, &pipelineInfo, nullptr, &rtPipeline) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to create ray tracing pipeline!");
     }
@@ -276,6 +307,36 @@ void PipelineCache::createRayTracingPipeline()
     vkDestroyDescriptorSetLayout(device, rtDescriptorSetLayout, nullptr);
 }
 
+void PipelineCache::createChunkCullPipeline()
+{
+    VkDevice device = m_DeviceContext.getDevice();
+
+    VkPushConstantRange pcRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ChunkCullPushConstants)};
+
+    VkDescriptorSetLayout dsl = m_DescriptorLayout.getChunkCullSetLayout();
+    VkPipelineLayoutCreateInfo plCI{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    plCI.setLayoutCount = 1;
+    plCI.pSetLayouts = &dsl;
+    plCI.pushConstantRangeCount = 1;
+    plCI.pPushConstantRanges = &pcRange;
+
+    VkPipelineLayout layoutRaw{};
+    if (vkCreatePipelineLayout(device, &plCI, nullptr, &layoutRaw) != VK_SUCCESS)
+        throw std::runtime_error("failed to create chunk cull pipeline layout!");
+    m_ChunkCullPipelineLayout = VulkanHandle<VkPipelineLayout, PipelineLayoutDeleter>(layoutRaw, {device});
+
+    auto comp = makeShader(device, "shaders/chunk_cull.comp.spv");
+
+    VkComputePipelineCreateInfo info{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+    info.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT, comp.get(), "main"};
+    info.layout = m_ChunkCullPipelineLayout.get();
+
+    VkPipeline pipe{};
+    if (vkCreateComputePipelines(device, m_CacheFile.get(), 1, &info, nullptr, &pipe) != VK_SUCCESS)
+        throw std::runtime_error("vkCreateComputePipelines failed for chunk_cull.comp");
+    m_ChunkCullPipeline = VulkanHandle<VkPipeline, PipelineDeleter>(pipe, {device});
+}
+
 void PipelineCache::createSkyPipeline()
 {
 
@@ -295,6 +356,7 @@ void PipelineCache::createSkyPipeline()
 
     m_SkyPipeline = VulkanHandle<VkPipeline, PipelineDeleter>(
         buildPipeline(m_DeviceContext.getDevice(),
+                      m_CacheFile.get(),
                       m_SwapChainContext.getRenderPass(),
                       m_SkyPipelineLayout.get(),
                       VK_POLYGON_MODE_FILL,
@@ -392,7 +454,7 @@ void PipelineCache::createOutlinePipeline()
     pipelineInfo.renderPass = m_SwapChainContext.getRenderPass();
 
     VkPipeline pipeline;
-    vkCreateGraphicsPipelines(m_DeviceContext.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+    vkCreateGraphicsPipelines(m_DeviceContext.getDevice(), m_CacheFile.get(), 1, &pipelineInfo, nullptr, &pipeline);
     m_OutlinePipeline = VulkanHandle<VkPipeline, PipelineDeleter>(pipeline, {m_DeviceContext.getDevice()});
 }
 
@@ -481,7 +543,7 @@ void PipelineCache::createDebugPipeline()
     pipelineInfo.renderPass = m_SwapChainContext.getRenderPass();
 
     VkPipeline pipeline;
-    vkCreateGraphicsPipelines(m_DeviceContext.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+    vkCreateGraphicsPipelines(m_DeviceContext.getDevice(), m_CacheFile.get(), 1, &pipelineInfo, nullptr, &pipeline);
     m_DebugPipeline = VulkanHandle<VkPipeline, PipelineDeleter>(pipeline, {m_DeviceContext.getDevice()});
 }
 
@@ -574,6 +636,6 @@ void PipelineCache::createCrosshairPipeline()
     pipelineInfo.renderPass = m_SwapChainContext.getRenderPass();
 
     VkPipeline pipeline;
-    vkCreateGraphicsPipelines(m_DeviceContext.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+    vkCreateGraphicsPipelines(m_DeviceContext.getDevice(), m_CacheFile.get(), 1, &pipelineInfo, nullptr, &pipeline);
     m_CrosshairPipeline = VulkanHandle<VkPipeline, PipelineDeleter>(pipeline, {m_DeviceContext.getDevice()});
 }
\ No newline at end of file
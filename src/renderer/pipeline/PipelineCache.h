@@ -4,6 +4,7 @@
 #include "../core/DeviceContext.h"
 #include "../swapchain/SwapChainContext.h"
 #include "DescriptorLayout.h"
+#include "PipelineCacheFile.h"
 
 class PipelineCache
 {
@@ -26,6 +27,11 @@ public:
     VkPipelineLayout getSkyPipelineLayout() const { return m_SkyPipelineLayout.get(); }
     VkPipeline getRayTracingPipeline() const { return m_RayTracingPipeline.get(); }
     VkPipelineLayout getRayTracingPipelineLayout() const { return m_RayTracingPipelineLayout.get(); }
+    VkPipeline getChunkCullPipeline() const { return m_ChunkCullPipeline.get(); }
+    VkPipelineLayout getChunkCullPipelineLayout() const { return m_ChunkCullPipelineLayout.get(); }
+    VkPipelineCache getVkPipelineCache() const { return m_CacheFile.get(); }
+
+    static constexpr const char *PIPELINE_CACHE_PATH = "pipeline_cache.bin";
 
     void createPipelines();
 
@@ -35,6 +41,7 @@ private:
     void createCrosshairPipeline();
     void createOutlinePipeline();
     void createDebugPipeline();
+    void createChunkCullPipeline();
 
     static std::vector<char> readFile(const std::string &filename);
     static VulkanHandle<VkShaderModule, ShaderModuleDeleter>
@@ -43,6 +50,7 @@ private:
     const DeviceContext &m_DeviceContext;
     const SwapChainContext &m_SwapChainContext;
     const DescriptorLayout &m_DescriptorLayout;
+    PipelineCacheFile m_CacheFile;
 
     VulkanHandle<VkPipelineLayout, PipelineLayoutDeleter> m_PipelineLayout;
     VulkanHandle<VkPipeline, PipelineDeleter> m_GraphicsPipeline;
@@ -59,4 +67,6 @@ private:
     VulkanHandle<VkPipeline, PipelineDeleter> m_SkyPipeline;
     VulkanHandle<VkPipelineLayout, PipelineLayoutDeleter> m_RayTracingPipelineLayout;
     VulkanHandle<VkPipeline, PipelineDeleter> m_RayTracingPipeline;
+    VulkanHandle<VkPipelineLayout, PipelineLayoutDeleter> m_ChunkCullPipelineLayout;
+    VulkanHandle<VkPipeline, PipelineDeleter> m_ChunkCullPipeline;
 };
\ No newline at end of file
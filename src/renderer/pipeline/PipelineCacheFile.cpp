@@ -0,0 +1,151 @@
+#include "PipelineCacheFile.h"
+
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    constexpr char FILE_MAGIC[4] = {'V', 'C', 'P', 'C'};
+    constexpr uint32_t FILE_VERSION = 1;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t dataSize;
+        uint64_t checksum;
+    };
+
+    uint64_t checksum(const std::vector<char> &data)
+    {
+        uint64_t h = 1469598103934665603ull;
+        for (char c : data)
+        {
+            h ^= static_cast<uint8_t>(c);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    bool matchesDevice(const std::vector<char> &data, const VkPhysicalDeviceProperties &props)
+    {
+        VkPipelineCacheHeaderVersionOne header{};
+        if (data.size() < sizeof(header))
+            return false;
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        return header.headerSize >= sizeof(header) &&
+               header.headerSize <= data.size() &&
+               header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header.vendorID == props.vendorID &&
+               header.deviceID == props.deviceID &&
+               std::memcmp(header.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    std::vector<char> readCacheData(const std::string &path, const VkPhysicalDeviceProperties &props)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return {};
+
+        FileHeader header{};
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+            header.version != FILE_VERSION || header.dataSize > (256ull << 20))
+        {
+            std::cerr << "[PipelineCache] Ignoring " << path << ": bad file header\n";
+            return {};
+        }
+
+        std::vector<char> data(static_cast<size_t>(header.dataSize));
+        if (!in.read(data.data(), static_cast<std::streamsize>(data.size())) || checksum(data) != header.checksum)
+        {
+            std::cerr << "[PipelineCache] Ignoring " << path << ": truncated or corrupt\n";
+            return {};
+        }
+
+        if (!matchesDevice(data, props))
+        {
+            std::cerr << "[PipelineCache] Ignoring " << path << ": created by a different device or driver\n";
+            return {};
+        }
+        return data;
+    }
+}
+
+PipelineCacheFile::PipelineCacheFile(const DeviceContext &deviceContext, std::string path)
+    : m_DeviceContext(deviceContext), m_Path(std::move(path))
+{
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(m_DeviceContext.getPhysicalDevice(), &props);
+
+    std::vector<char> data = readCacheData(m_Path, props);
+
+    VkPipelineCacheCreateInfo ci{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    ci.initialDataSize = data.size();
+    ci.pInitialData = data.empty() ? nullptr : data.data();
+
+    VkPipelineCache cache{};
+    VkResult result = vkCreatePipelineCache(m_DeviceContext.getDevice(), &ci, nullptr, &cache);
+    if (result != VK_SUCCESS && !data.empty())
+    {
+        ci.initialDataSize = 0;
+        ci.pInitialData = nullptr;
+        data.clear();
+        result = vkCreatePipelineCache(m_DeviceContext.getDevice(), &ci, nullptr, &cache);
+    }
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create pipeline cache!");
+
+    m_Cache = VulkanHandle<VkPipelineCache, PipelineCacheDeleter>(cache, {m_DeviceContext.getDevice()});
+    m_Loaded = !data.empty();
+}
+
+PipelineCacheFile::~PipelineCacheFile()
+{
+    try
+    {
+        save();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "[PipelineCache] Failed to save " << m_Path << ": " << e.what() << "\n";
+    }
+}
+
+void PipelineCacheFile::save() const
+{
+    if (!m_Cache.get())
+        return;
+
+    VkDevice device = m_DeviceContext.getDevice();
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, m_Cache.get(), &size, nullptr) != VK_SUCCESS || size == 0)
+        return;
+
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(device, m_Cache.get(), &size, data.data()) != VK_SUCCESS)
+        return;
+    data.resize(size);
+
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.dataSize = data.size();
+    header.checksum = checksum(data);
+
+    const std::string tmp = m_Path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out)
+            throw std::runtime_error("write failed");
+    }
+    std::filesystem::rename(tmp, m_Path);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../../VulkanWrappers.h"
+#include "../core/DeviceContext.h"
+#include <string>
+
+class PipelineCacheFile
+{
+public:
+    PipelineCacheFile(const DeviceContext &deviceContext, std::string path);
+    ~PipelineCacheFile();
+
+    PipelineCacheFile(const PipelineCacheFile &) = delete;
+    PipelineCacheFile &operator=(const PipelineCacheFile &) = delete;
+
+    VkPipelineCache get() const { return m_Cache.get(); }
+    bool wasLoaded() const { return m_Loaded; }
+
+    void save() const;
+
+private:
+    const DeviceContext &m_DeviceContext;
+    std::string m_Path;
+    VulkanHandle<VkPipelineCache, PipelineCacheDeleter> m_Cache;
+    bool m_Loaded = false;
+};
@@ -0,0 +1,74 @@
+#include "ChunkMeshPool.h"
+#include "../Vertex.h"
+
+ChunkMeshPool::ChunkMeshPool(const DeviceContext &dc, VkDeviceSize vertexBytes, VkDeviceSize indexBytes)
+    : m_Vertices(vertexBytes / sizeof(Vertex)), m_Indices(indexBytes / sizeof(uint32_t))
+{
+    VkBufferUsageFlags vbUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    VkBufferUsageFlags ibUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    if (dc.isRayTracingSupported())
+    {
+        vbUsage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+        ibUsage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+    }
+
+    VkBufferCreateInfo b{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    VmaAllocationCreateInfo a{};
+    a.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+    b.size = m_Vertices.getCapacity() * sizeof(Vertex);
+    b.usage = vbUsage;
+    m_VertexBuffer = VmaBuffer(dc.getAllocator(), b, a);
+
+    b.size = m_Indices.getCapacity() * sizeof(uint32_t);
+    b.usage = ibUsage;
+    m_IndexBuffer = VmaBuffer(dc.getAllocator(), b, a);
+}
+
+bool ChunkMeshPool::allocate(VkDeviceSize vertexBytes, VkDeviceSize indexBytes, GpuMesh &mesh)
+{
+    const uint64_t vertexCount = vertexBytes / sizeof(Vertex);
+    const uint64_t indexCount = indexBytes / sizeof(uint32_t);
+
+    uint64_t vertexOffset, indexOffset;
+    if (!m_Vertices.allocate(vertexCount, vertexOffset))
+        return false;
+    if (!m_Indices.allocate(indexCount, indexOffset))
+    {
+        m_Vertices.free(vertexOffset, vertexCount);
+        return false;
+    }
+
+    mesh.pooled = true;
+    mesh.vertexOffset = static_cast<int32_t>(vertexOffset);
+    mesh.firstIndex = static_cast<uint32_t>(indexOffset);
+    return true;
+}
+
+void ChunkMeshPool::retire(const GpuMesh &mesh, VkDeviceSize vertexBytes, VkDeviceSize indexBytes, uint32_t frameSlot)
+{
+    if (!mesh.pooled)
+        return;
+    m_Retired[frameSlot].push_back({static_cast<uint64_t>(mesh.vertexOffset), vertexBytes / sizeof(Vertex),
+                                    mesh.firstIndex, indexBytes / sizeof(uint32_t)});
+}
+
+void ChunkMeshPool::releaseFrame(uint32_t frameSlot)
+{
+    for (const Retired &r : m_Retired[frameSlot])
+    {
+        m_Vertices.free(r.vertexOffset, r.vertexCount);
+        m_Indices.free(r.indexOffset, r.indexCount);
+    }
+    m_Retired[frameSlot].clear();
+}
+
+VkDeviceSize ChunkMeshPool::vertexByteOffset(const GpuMesh &mesh) const
+{
+    return static_cast<VkDeviceSize>(mesh.vertexOffset) * sizeof(Vertex);
+}
+
+VkDeviceSize ChunkMeshPool::indexByteOffset(const GpuMesh &mesh) const
+{
+    return static_cast<VkDeviceSize>(mesh.firstIndex) * sizeof(uint32_t);
+}
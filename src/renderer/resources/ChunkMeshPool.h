@@ -0,0 +1,47 @@
+#pragma once
+#include "../../VulkanWrappers.h"
+#include "../../RangeAllocator.h"
+#include "../../RenderBackend.h"
+#include "../core/DeviceContext.h"
+#include "../RendererConfig.h"
+#include <array>
+#include <vector>
+
+// Shared device-local vertex and index buffers chunk meshes are suballocated from, so every
+// pooled mesh can be drawn with the two buffers bound once, which is what indirect draws need.
+// A retired mesh's ranges are only handed out again once its frame slot comes round again.
+class ChunkMeshPool
+{
+public:
+    ChunkMeshPool(const DeviceContext &dc, VkDeviceSize vertexBytes, VkDeviceSize indexBytes);
+
+    // Fills in mesh's placement. Returns false when either range does not fit; the mesh then
+    // needs its own buffers.
+    bool allocate(VkDeviceSize vertexBytes, VkDeviceSize indexBytes, GpuMesh &mesh);
+    void retire(const GpuMesh &mesh, VkDeviceSize vertexBytes, VkDeviceSize indexBytes, uint32_t frameSlot);
+    // Call once the frame slot's fence has signalled.
+    void releaseFrame(uint32_t frameSlot);
+
+    VkBuffer getVertexBuffer() const { return m_VertexBuffer.get(); }
+    VkBuffer getIndexBuffer() const { return m_IndexBuffer.get(); }
+    VkDeviceSize vertexByteOffset(const GpuMesh &mesh) const;
+    VkDeviceSize indexByteOffset(const GpuMesh &mesh) const;
+
+    uint64_t getUsedVertices() const { return m_Vertices.getUsed(); }
+    uint64_t getUsedIndices() const { return m_Indices.getUsed(); }
+
+private:
+    struct Retired
+    {
+        uint64_t vertexOffset;
+        uint64_t vertexCount;
+        uint64_t indexOffset;
+        uint64_t indexCount;
+    };
+
+    VmaBuffer m_VertexBuffer;
+    VmaBuffer m_IndexBuffer;
+    RangeAllocator m_Vertices;
+    RangeAllocator m_Indices;
+    std::array<std::vector<Retired>, MAX_FRAMES_IN_FLIGHT> m_Retired;
+};
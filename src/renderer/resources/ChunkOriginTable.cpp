@@ -0,0 +1,72 @@
+#include "ChunkOriginTable.h"
+#include <cstring>
+#include <stdexcept>
+
+ChunkOriginTable::ChunkOriginTable(const DeviceContext &dc, uint32_t initialCapacity)
+    : m_DeviceContext(dc)
+{
+    allocateBuffer(initialCapacity);
+}
+
+void ChunkOriginTable::allocateBuffer(uint32_t capacity)
+{
+    VkBufferCreateInfo b{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    b.size = static_cast<VkDeviceSize>(capacity) * sizeof(glm::ivec4);
+    b.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+    VmaAllocationCreateInfo a{};
+    a.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    a.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+    m_Buffer = VmaBuffer(m_DeviceContext.getAllocator(), b, a);
+    VmaAllocationInfo info;
+    vmaGetAllocationInfo(m_DeviceContext.getAllocator(), m_Buffer.getAllocation(), &info);
+    if (!info.pMappedData)
+        throw std::runtime_error("failed to map chunk origin table");
+    m_Mapped = static_cast<glm::ivec4 *>(info.pMappedData);
+    m_Capacity = capacity;
+    m_Origins.resize(capacity, glm::ivec4(0));
+    std::memcpy(m_Mapped, m_Origins.data(), m_Origins.size() * sizeof(glm::ivec4));
+}
+
+void ChunkOriginTable::add(Chunk &chunk, uint32_t frameSlot)
+{
+    if (chunk.m_OriginSlot != Chunk::NO_ORIGIN_SLOT)
+        return;
+
+    uint32_t slot;
+    if (!m_FreeSlots.empty())
+    {
+        slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        if (m_End == m_Capacity)
+        {
+            m_Retired[frameSlot].push_back(std::move(m_Buffer));
+            allocateBuffer(m_Capacity * 2);
+        }
+        slot = m_End++;
+    }
+
+    const glm::ivec3 pos = chunk.getPos();
+    m_Origins[slot] = glm::ivec4(pos.x * Chunk::WIDTH, pos.y * Chunk::HEIGHT, pos.z * Chunk::DEPTH, 0);
+    m_Mapped[slot] = m_Origins[slot];
+    chunk.m_OriginSlot = slot;
+}
+
+void ChunkOriginTable::release(Chunk &chunk, uint32_t frameSlot)
+{
+    if (chunk.m_OriginSlot == Chunk::NO_ORIGIN_SLOT)
+        return;
+    m_RetiredSlots[frameSlot].push_back(chunk.m_OriginSlot);
+    chunk.m_OriginSlot = Chunk::NO_ORIGIN_SLOT;
+}
+
+void ChunkOriginTable::releaseFrame(uint32_t frameSlot)
+{
+    m_Retired[frameSlot].clear();
+    m_FreeSlots.insert(m_FreeSlots.end(), m_RetiredSlots[frameSlot].begin(), m_RetiredSlots[frameSlot].end());
+    m_RetiredSlots[frameSlot].clear();
+}
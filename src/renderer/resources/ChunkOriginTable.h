@@ -0,0 +1,44 @@
+#pragma once
+#include "../../VulkanWrappers.h"
+#include "../../Chunk.h"
+#include "../core/DeviceContext.h"
+#include "../RendererConfig.h"
+#include <array>
+#include <glm/glm.hpp>
+#include <vector>
+
+// World-space block origins of the resident chunks, one ivec4 per slot in a persistently
+// mapped storage buffer the chunk vertex shaders index with gl_InstanceIndex. An entry is only
+// written when a chunk gets its slot, so drawing a chunk costs no per-frame upload. Released
+// slots are reused before the table grows, but only after the releasing frame slot comes
+// round again, since frames in flight may still draw the old chunk through them.
+class ChunkOriginTable
+{
+public:
+    ChunkOriginTable(const DeviceContext &dc, uint32_t initialCapacity);
+
+    // Gives the chunk a slot if it has none. Grows the buffer when full; the old one is kept
+    // until frameSlot comes round again.
+    void add(Chunk &chunk, uint32_t frameSlot);
+    void release(Chunk &chunk, uint32_t frameSlot);
+    // Call once the frame slot's fence has signalled.
+    void releaseFrame(uint32_t frameSlot);
+
+    // Changes when the table grows, so descriptor sets pointing at it must be rewritten.
+    VkBuffer getBuffer() const { return m_Buffer.get(); }
+    uint32_t getCapacity() const { return m_Capacity; }
+
+private:
+    void allocateBuffer(uint32_t capacity);
+
+    const DeviceContext &m_DeviceContext;
+    VmaBuffer m_Buffer;
+    glm::ivec4 *m_Mapped = nullptr;
+    uint32_t m_Capacity = 0;
+    // One past the highest slot ever handed out, and the released slots below it.
+    uint32_t m_End = 0;
+    std::vector<uint32_t> m_FreeSlots;
+    std::vector<glm::ivec4> m_Origins;
+    std::array<std::vector<VmaBuffer>, MAX_FRAMES_IN_FLIGHT> m_Retired;
+    std::array<std::vector<uint32_t>, MAX_FRAMES_IN_FLIGHT> m_RetiredSlots;
+};
@@ -12,6 +12,7 @@ public:
     bool alloc(VkDeviceSize sz, VkDeviceSize &offset);
     VkBuffer getBuffer() const { return m_Buffer.get(); }
     void *getMapped() const { return m_Mapped; }
+    VkDeviceSize getSize() const { return m_Size; }
 
 private:
     const DeviceContext &m_DC;
@@ -1,8 +1,12 @@
 #include "TextureManager.h"
 #include "UploadHelpers.h"
 #include <stb_image.h>
+#include "world/MappedFile.h"
 #include <stdexcept>
 #include <cstring>
+#include <filesystem>
+#include <memory>
+#include <vector>
 
 TextureManager::TextureManager(const DeviceContext &deviceContext,
                                VkCommandPool commandPool)
@@ -11,7 +15,12 @@ TextureManager::TextureManager(const DeviceContext &deviceContext,
 
 TextureManager::~TextureManager() {}
 
-VulkanHandle<VkImageView, ImageViewDeleter> TextureManager::createImageView(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+namespace
+{
+    constexpr uint32_t ATLAS_TILE_SIZE = 16;
+}
+
+VulkanHandle<VkImageView, ImageViewDeleter> TextureManager::createImageView(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels)
 {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -20,7 +29,7 @@ VulkanHandle<VkImageView, ImageViewDeleter> TextureManager::createImageView(VkDe
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = aspectFlags;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
     VkImageView imageView;
@@ -33,30 +42,45 @@ VulkanHandle<VkImageView, ImageViewDeleter> TextureManager::createImageView(VkDe
 
 void TextureManager::createTextureImage(const char *path)
 {
+    std::filesystem::path cookedPath = std::filesystem::path(path).replace_extension(".vctex");
+    if (std::filesystem::exists(cookedPath))
+    {
+        MappedFile file(cookedPath, MappedFile::Access::ReadOnly);
+        uploadAtlas(AtlasCooker::parse(file.data(), file.size()));
+        return;
+    }
+
     int texWidth, texHeight, texChannels;
     stbi_uc *pixels = stbi_load(path, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
     if (!pixels)
         throw std::runtime_error("failed to load texture image!");
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
+    std::unique_ptr<stbi_uc, void (*)(void *)> pixelsGuard(pixels, stbi_image_free);
+
+    std::vector<uint8_t> cooked = AtlasCooker::cook(pixels, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), ATLAS_TILE_SIZE);
+    uploadAtlas(AtlasCooker::parse(cooked.data(), cooked.size()));
+}
+
+void TextureManager::uploadAtlas(const AtlasCooker::CookedAtlas &atlas)
+{
+    m_MipLevels = static_cast<uint32_t>(atlas.levels.size());
 
     VmaBuffer stagingBuffer;
     {
         VkBufferCreateInfo bufferInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, nullptr, 0,
-                                      imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT};
+                                      atlas.pixelBytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT};
         VmaAllocationCreateInfo allocInfo{VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
                                           VMA_MEMORY_USAGE_CPU_ONLY};
         stagingBuffer = VmaBuffer(m_DeviceContext.getAllocator(), bufferInfo, allocInfo);
         void *data;
         vmaMapMemory(m_DeviceContext.getAllocator(), stagingBuffer.getAllocation(), &data);
-        std::memcpy(data, pixels, static_cast<size_t>(imageSize));
+        std::memcpy(data, atlas.pixels, atlas.pixelBytes);
         vmaUnmapMemory(m_DeviceContext.getAllocator(), stagingBuffer.getAllocation());
     }
-    stbi_image_free(pixels);
 
     VkImageCreateInfo imageInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
-    imageInfo.extent = {(uint32_t)texWidth, (uint32_t)texHeight, 1};
-    imageInfo.mipLevels = 1;
+    imageInfo.extent = {atlas.width, atlas.height, 1};
+    imageInfo.mipLevels = m_MipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -67,7 +91,17 @@ void TextureManager::createTextureImage(const char *path)
     VmaAllocationCreateInfo allocInfo{0, VMA_MEMORY_USAGE_GPU_ONLY};
     m_TextureImage = VmaImage(m_DeviceContext.getAllocator(), imageInfo, allocInfo);
 
-    m_TextureImage = VmaImage(m_DeviceContext.getAllocator(), imageInfo, allocInfo);
+    std::vector<VkBufferImageCopy> regions(m_MipLevels);
+    const uint64_t base = atlas.levels[0].offset;
+    for (uint32_t l = 0; l < m_MipLevels; ++l)
+    {
+        VkBufferImageCopy &region = regions[l];
+        region.bufferOffset = atlas.levels[l].offset - base;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = l;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {atlas.levels[l].width, atlas.levels[l].height, 1};
+    }
 
     VkCommandBufferAllocateInfo allocInfoCb{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
     allocInfoCb.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -83,14 +117,15 @@ void TextureManager::createTextureImage(const char *path)
 
     VkImageSubresourceRange range{};
     range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    range.levelCount = 1;
+    range.levelCount = m_MipLevels;
     range.layerCount = 1;
 
     UploadHelpers::transitionImageLayout(
         commandBuffer, m_TextureImage.get(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
         range, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 
-    UploadHelpers::copyBufferToImage(commandBuffer, stagingBuffer.get(), m_TextureImage.get(), static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.get(), m_TextureImage.get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
 
     UploadHelpers::transitionImageLayout(
         commandBuffer, m_TextureImage.get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
@@ -107,7 +142,7 @@ void TextureManager::createTextureImage(const char *path)
 
 void TextureManager::createTextureImageView()
 {
-    m_TextureImageView = createImageView(m_DeviceContext.getDevice(), m_TextureImage.get(), VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_TextureImageView = createImageView(m_DeviceContext.getDevice(), m_TextureImage.get(), VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, m_MipLevels);
 }
 
 void TextureManager::createTextureSampler()
@@ -124,7 +159,9 @@ void TextureManager::createTextureSampler()
     samplerInfo.unnormalizedCoordinates = VK_FALSE;
     samplerInfo.compareEnable = VK_FALSE;
     samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(m_MipLevels - 1);
 
     VkSampler sampler;
     if (vkCreateSampler(m_DeviceContext.getDevice(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
@@ -2,6 +2,7 @@
 
 #include "../../VulkanWrappers.h"
 #include "../core/DeviceContext.h"
+#include "assets/AtlasCooker.h"
 
 class TextureManager
 {
@@ -13,16 +14,19 @@ public:
     void createTextureImageView();
     void createTextureSampler();
 
-    static VulkanHandle<VkImageView, ImageViewDeleter> createImageView(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+    static VulkanHandle<VkImageView, ImageViewDeleter> createImageView(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
 
     VkImageView getTextureImageView() const { return m_TextureImageView.get(); }
     VkSampler getTextureSampler() const { return m_TextureSampler.get(); }
 
 private:
+    void uploadAtlas(const AtlasCooker::CookedAtlas &atlas);
+
     const DeviceContext &m_DeviceContext;
     VkCommandPool m_CommandPool;
 
     VmaImage m_TextureImage;
+    uint32_t m_MipLevels = 1;
     VulkanHandle<VkImageView, ImageViewDeleter> m_TextureImageView;
     VulkanHandle<VkSampler, SamplerDeleter> m_TextureSampler;
 };
@@ -215,30 +215,25 @@ void UploadHelpers::copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer bu
     vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 }
 
-void UploadHelpers::stageChunkMesh(RingStagingArena &arena,
-                                   const std::vector<Vertex> &v,
-                                   const std::vector<uint32_t> &i,
-                                   UploadJob &up)
+uint8_t *UploadHelpers::reserveChunkMesh(RingStagingArena &arena,
+                                         VkDeviceSize vertexBytes,
+                                         VkDeviceSize indexBytes,
+                                         UploadJob &up)
 {
-    if (v.empty() || i.empty())
-        return;
-
-    VkDeviceSize vs = v.size() * sizeof(Vertex);
-    VkDeviceSize is = i.size() * sizeof(uint32_t);
+    if (vertexBytes == 0 || indexBytes == 0)
+        return nullptr;
 
-    if (!arena.alloc(vs, up.stagingVbOffset))
-        return;
-    if (!arena.alloc(is, up.stagingIbOffset))
-        return;
+    if (!arena.alloc(vertexBytes, up.stagingVbOffset))
+        return nullptr;
+    if (!arena.alloc(indexBytes, up.stagingIbOffset))
+        return nullptr;
 
     up.stagingVB = arena.getBuffer();
-    up.stagingVbSize = vs;
+    up.stagingVbSize = vertexBytes;
     up.stagingIB = arena.getBuffer();
-    up.stagingIbSize = is;
+    up.stagingIbSize = indexBytes;
 
-    uint8_t *base = static_cast<uint8_t *>(arena.getMapped());
-    memcpy(base + up.stagingVbOffset, v.data(), vs);
-    memcpy(base + up.stagingIbOffset, i.data(), is);
+    return static_cast<uint8_t *>(arena.getMapped());
 }
 
 void UploadHelpers::submitChunkMeshUpload(const DeviceContext &dc,
@@ -280,6 +275,15 @@ void UploadHelpers::submitChunkMeshUpload(const DeviceContext &dc,
     b.usage = ibUsage;
     ib = VmaBuffer(dc.getAllocator(), b, a);
 
+    submitChunkMeshCopy(dc, pool, up, vb.get(), 0, ib.get(), 0);
+}
+
+void UploadHelpers::submitChunkMeshCopy(const DeviceContext &dc,
+                                        VkCommandPool pool,
+                                        UploadJob &up,
+                                        VkBuffer vb, VkDeviceSize vbOffset,
+                                        VkBuffer ib, VkDeviceSize ibOffset)
+{
     VkCommandBufferAllocateInfo ai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
     ai.commandPool = pool;
     ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -294,11 +298,11 @@ void UploadHelpers::submitChunkMeshUpload(const DeviceContext &dc,
     bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     vkBeginCommandBuffer(up.cmdBuffer, &bi);
 
-    VkBufferCopy c1{up.stagingVbOffset, 0, up.stagingVbSize};
-    vkCmdCopyBuffer(up.cmdBuffer, up.stagingVB, vb.get(), 1, &c1);
+    VkBufferCopy c1{up.stagingVbOffset, vbOffset, up.stagingVbSize};
+    vkCmdCopyBuffer(up.cmdBuffer, up.stagingVB, vb, 1, &c1);
 
-    VkBufferCopy c2{up.stagingIbOffset, 0, up.stagingIbSize};
-    vkCmdCopyBuffer(up.cmdBuffer, up.stagingIB, ib.get(), 1, &c2);
+    VkBufferCopy c2{up.stagingIbOffset, ibOffset, up.stagingIbSize};
+    vkCmdCopyBuffer(up.cmdBuffer, up.stagingIB, ib, 1, &c2);
 
     vkEndCommandBuffer(up.cmdBuffer);
 
@@ -19,15 +19,22 @@ public:
         VkPipelineStageFlags srcStageMask,
         VkPipelineStageFlags dstStageMask);
     static void copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
-    static void stageChunkMesh(RingStagingArena &arena,
-                               const std::vector<Vertex> &v,
-                               const std::vector<uint32_t> &i,
-                               UploadJob &up);
+    static uint8_t *reserveChunkMesh(RingStagingArena &arena,
+                                     VkDeviceSize vertexBytes,
+                                     VkDeviceSize indexBytes,
+                                     UploadJob &up);
     static void submitChunkMeshUpload(const DeviceContext &dc,
                                       VkCommandPool pool,
                                       UploadJob &up,
                                       VmaBuffer &vb,
                                       VmaBuffer &ib);
+    // Records and fences the staging copy into existing buffers at the given byte offsets.
+    // up's staging ranges must not be empty.
+    static void submitChunkMeshCopy(const DeviceContext &dc,
+                                    VkCommandPool pool,
+                                    UploadJob &up,
+                                    VkBuffer vb, VkDeviceSize vbOffset,
+                                    VkBuffer ib, VkDeviceSize ibOffset);
     static VmaBuffer createDeviceLocalBufferFromData(
         const DeviceContext &dc, VkCommandPool pool,
         const void *data, VkDeviceSize size, VkBufferUsageFlags usage);
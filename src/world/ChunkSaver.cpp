@@ -0,0 +1,203 @@
+#include "ChunkSaver.h"
+#include <algorithm>
+#include <iostream>
+#include <exception>
+
+ChunkSaver::ChunkSaver(RegionStore &store, size_t maxPendingBytes, std::chrono::milliseconds syncInterval)
+    : m_Store(store), m_MaxPendingBytes(maxPendingBytes), m_SyncInterval(syncInterval),
+      m_LastSync(std::chrono::steady_clock::now())
+{
+    m_Stats.budgetBytes = maxPendingBytes;
+    m_Thread = std::jthread([this](std::stop_token st)
+                            { run(st); });
+}
+
+ChunkSaver::~ChunkSaver()
+{
+    m_Thread.request_stop();
+    m_WorkCv.notify_all();
+    if (m_Thread.joinable())
+        m_Thread.join();
+}
+
+bool ChunkSaver::enqueueLocked(const glm::ivec3 &chunkPos, const std::vector<Block> &blocks)
+{
+    const size_t bytes = blocks.size() * sizeof(Block);
+
+    auto it = m_Pending.find(chunkPos);
+    if (it != m_Pending.end())
+    {
+        m_PendingBytes = m_PendingBytes - it->second.size() * sizeof(Block) + bytes;
+        it->second = blocks;
+        ++m_Stats.coalesced;
+    }
+    else
+    {
+        if (m_PendingBytes + m_InFlightBytes + bytes > m_MaxPendingBytes)
+            return false;
+        m_Pending.emplace(chunkPos, blocks);
+        m_PendingBytes += bytes;
+    }
+
+    ++m_Stats.submitted;
+    m_Stats.peakPendingBytes = std::max(m_Stats.peakPendingBytes, m_PendingBytes + m_InFlightBytes);
+    return true;
+}
+
+bool ChunkSaver::trySubmit(const glm::ivec3 &chunkPos, const std::vector<Block> &blocks)
+{
+    {
+        std::scoped_lock lock(m_Mutex);
+        if (!enqueueLocked(chunkPos, blocks))
+        {
+            ++m_Stats.rejected;
+            return false;
+        }
+    }
+    m_WorkCv.notify_one();
+    return true;
+}
+
+void ChunkSaver::submit(const glm::ivec3 &chunkPos, const std::vector<Block> &blocks)
+{
+    {
+        std::unique_lock lock(m_Mutex);
+        if (!enqueueLocked(chunkPos, blocks))
+        {
+            ++m_Stats.blockedSubmits;
+            m_WorkCv.notify_one();
+            m_StateCv.wait(lock, [&]
+                           { return enqueueLocked(chunkPos, blocks); });
+        }
+    }
+    m_WorkCv.notify_one();
+}
+
+void ChunkSaver::flush()
+{
+    std::unique_lock lock(m_Mutex);
+    m_FlushRequested = true;
+    m_WorkCv.notify_one();
+    m_StateCv.wait(lock, [&]
+                   { return !m_FlushRequested; });
+}
+
+bool ChunkSaver::tryGetPending(const glm::ivec3 &chunkPos, std::vector<Block> &out) const
+{
+    std::scoped_lock lock(m_Mutex);
+    auto it = m_Pending.find(chunkPos);
+    if (it == m_Pending.end())
+    {
+        it = m_InFlight.find(chunkPos);
+        if (it == m_InFlight.end())
+            return false;
+    }
+    out = it->second;
+    return true;
+}
+
+ChunkSaver::Stats ChunkSaver::getStats() const
+{
+    std::scoped_lock lock(m_Mutex);
+    Stats s = m_Stats;
+    s.pendingChunks = m_Pending.size();
+    s.pendingBytes = m_PendingBytes + m_InFlightBytes;
+    return s;
+}
+
+void ChunkSaver::run(std::stop_token st)
+{
+    while (true)
+    {
+        bool flushing = false;
+        {
+            std::unique_lock lock(m_Mutex);
+            m_WorkCv.wait_for(lock, st, m_SyncInterval, [&]
+                              { return !m_Pending.empty() || m_FlushRequested; });
+
+            if (!m_Pending.empty() && !m_FlushRequested && !st.stop_requested() &&
+                m_PendingBytes < m_MaxPendingBytes / 2)
+            {
+                m_WorkCv.wait_for(lock, st, COALESCE_DELAY, [&]
+                                  { return m_FlushRequested || m_PendingBytes >= m_MaxPendingBytes / 2; });
+            }
+
+            m_InFlight.swap(m_Pending);
+            m_InFlightBytes = m_PendingBytes;
+            m_PendingBytes = 0;
+            flushing = m_FlushRequested || st.stop_requested();
+        }
+
+        if (!m_InFlight.empty())
+            writeBatch(m_InFlight);
+
+        bool syncDue = std::chrono::steady_clock::now() - m_LastSync >= m_SyncInterval;
+        if (!m_UnsyncedRegions.empty() && (flushing || syncDue))
+            syncDirtyRegions();
+
+        {
+            std::scoped_lock lock(m_Mutex);
+            m_InFlight.clear();
+            m_InFlightBytes = 0;
+            if (m_FlushRequested && m_Pending.empty())
+                m_FlushRequested = false;
+        }
+        m_StateCv.notify_all();
+
+        if (st.stop_requested())
+        {
+            std::scoped_lock lock(m_Mutex);
+            if (m_Pending.empty())
+                break;
+        }
+    }
+}
+
+void ChunkSaver::writeBatch(const std::map<glm::ivec3, std::vector<Block>, ivec3_less> &batch)
+{
+    std::vector<std::pair<glm::ivec3, const std::vector<Block> *>> ordered;
+    ordered.reserve(batch.size());
+    for (const auto &[pos, blocks] : batch)
+        ordered.emplace_back(pos, &blocks);
+
+    std::sort(ordered.begin(), ordered.end(), [](const auto &a, const auto &b)
+              {
+                  glm::ivec3 ra = RegionStore::regionOf(a.first);
+                  glm::ivec3 rb = RegionStore::regionOf(b.first);
+                  if (ra != rb)
+                      return ivec3_less{}(ra, rb);
+                  return ivec3_less{}(a.first, b.first); });
+
+    uint64_t written = 0;
+    uint64_t failures = 0;
+    for (auto &[pos, blocks] : ordered)
+    {
+        try
+        {
+            m_Store.saveChunk(pos, *blocks);
+            m_UnsyncedRegions.insert(RegionStore::regionOf(pos));
+            ++written;
+        }
+        catch (const std::exception &e)
+        {
+            ++failures;
+            std::cerr << "ChunkSaver: failed to save chunk (" << pos.x << ", " << pos.z << "): " << e.what() << std::endl;
+        }
+    }
+
+    std::scoped_lock lock(m_Mutex);
+    m_Stats.written += written;
+    m_Stats.failures += failures;
+    ++m_Stats.batches;
+}
+
+void ChunkSaver::syncDirtyRegions()
+{
+    for (const glm::ivec3 &region : m_UnsyncedRegions)
+        m_Store.syncRegion(region);
+    m_UnsyncedRegions.clear();
+    m_LastSync = std::chrono::steady_clock::now();
+
+    std::scoped_lock lock(m_Mutex);
+    ++m_Stats.syncs;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "RegionStore.h"
+#include "../Block.h"
+#include "../math/Ivec3Less.h"
+#include <glm/glm.hpp>
+#include <map>
+#include <set>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+#include <chrono>
+#include <cstdint>
+
+class ChunkSaver
+{
+public:
+    struct Stats
+    {
+        size_t pendingChunks = 0;
+        size_t pendingBytes = 0;
+        size_t peakPendingBytes = 0;
+        size_t budgetBytes = 0;
+        uint64_t submitted = 0;
+        uint64_t coalesced = 0;
+        uint64_t rejected = 0;
+        uint64_t blockedSubmits = 0;
+        uint64_t written = 0;
+        uint64_t batches = 0;
+        uint64_t syncs = 0;
+        uint64_t failures = 0;
+    };
+
+    static constexpr std::chrono::milliseconds COALESCE_DELAY{50};
+
+    ChunkSaver(RegionStore &store, size_t maxPendingBytes, std::chrono::milliseconds syncInterval);
+    ~ChunkSaver();
+
+    ChunkSaver(const ChunkSaver &) = delete;
+    ChunkSaver &operator=(const ChunkSaver &) = delete;
+
+    bool trySubmit(const glm::ivec3 &chunkPos, const std::vector<Block> &blocks);
+    void submit(const glm::ivec3 &chunkPos, const std::vector<Block> &blocks);
+    void flush();
+
+    // Copies the newest snapshot of chunkPos that is queued or still being written.
+    // A reload must check this first: until the write lands the region file is stale.
+    bool tryGetPending(const glm::ivec3 &chunkPos, std::vector<Block> &out) const;
+
+    Stats getStats() const;
+
+private:
+    bool enqueueLocked(const glm::ivec3 &chunkPos, const std::vector<Block> &blocks);
+    void run(std::stop_token st);
+    void writeBatch(const std::map<glm::ivec3, std::vector<Block>, ivec3_less> &batch);
+    void syncDirtyRegions();
+
+    RegionStore &m_Store;
+    const size_t m_MaxPendingBytes;
+    const std::chrono::milliseconds m_SyncInterval;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable_any m_WorkCv;
+    std::condition_variable_any m_StateCv;
+
+    std::map<glm::ivec3, std::vector<Block>, ivec3_less> m_Pending;
+    // Swapped out of m_Pending by the worker; only the worker mutates it, under m_Mutex.
+    std::map<glm::ivec3, std::vector<Block>, ivec3_less> m_InFlight;
+    size_t m_PendingBytes = 0;
+    size_t m_InFlightBytes = 0;
+    bool m_FlushRequested = false;
+    Stats m_Stats;
+
+    std::set<glm::ivec3, ivec3_less> m_UnsyncedRegions;
+    std::chrono::steady_clock::time_point m_LastSync;
+
+    std::jthread m_Thread;
+};
@@ -0,0 +1,260 @@
+#include "EditLog.h"
+#include "../ChunkLayout.h"
+#include <cstring>
+#include <iostream>
+#include <exception>
+
+namespace
+{
+    constexpr char LOG_MAGIC[4] = {'V', 'C', 'E', 'L'};
+    constexpr uint32_t LOG_VERSION = 1;
+    constexpr size_t HEADER_BYTES = sizeof(LOG_MAGIC) + sizeof(uint32_t);
+    constexpr size_t RECORD_BYTES = 2 * sizeof(int32_t) + sizeof(uint16_t) + sizeof(uint8_t);
+
+    void packRecord(uint8_t *dst, int32_t cx, int32_t cz, uint16_t index, uint8_t id)
+    {
+        std::memcpy(dst, &cx, sizeof(cx));
+        std::memcpy(dst + 4, &cz, sizeof(cz));
+        std::memcpy(dst + 8, &index, sizeof(index));
+        dst[10] = id;
+    }
+}
+
+EditLog::EditLog(const std::filesystem::path &path) : m_Path(path)
+{
+    if (m_Path.has_parent_path())
+        std::filesystem::create_directories(m_Path.parent_path());
+
+    load();
+    openForAppend();
+
+    m_Thread = std::jthread([this](std::stop_token st)
+                            { run(st); });
+}
+
+EditLog::~EditLog()
+{
+    m_Thread.request_stop();
+    if (m_Thread.joinable())
+        m_Thread.join();
+}
+
+void EditLog::load()
+{
+    std::ifstream in(m_Path, std::ios::binary);
+    if (!in)
+        return;
+
+    char magic[4];
+    uint32_t version = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(&version), sizeof(version));
+    if (!in || std::memcmp(magic, LOG_MAGIC, sizeof(magic)) != 0 || version != LOG_VERSION)
+    {
+        std::cerr << "EditLog: ignoring unreadable log " << m_Path.string() << std::endl;
+        std::filesystem::rename(m_Path, m_Path.string() + ".bad");
+        return;
+    }
+
+    // Every complete record counts towards m_FileRecords, even one that is skipped,
+    // so openForAppend only truncates a trailing partial record.
+    uint8_t rec[RECORD_BYTES];
+    size_t skipped = 0;
+    while (in.read(reinterpret_cast<char *>(rec), RECORD_BYTES))
+    {
+        ++m_FileRecords;
+        int32_t cx, cz;
+        uint16_t index;
+        std::memcpy(&cx, rec, sizeof(cx));
+        std::memcpy(&cz, rec + 4, sizeof(cz));
+        std::memcpy(&index, rec + 8, sizeof(index));
+        if (rec[10] >= static_cast<uint8_t>(BlockId::LAST))
+        {
+            ++skipped;
+            continue;
+        }
+
+        auto &edits = m_Index[{cx, 0, cz}];
+        if (edits.insert_or_assign(index, static_cast<BlockId>(rec[10])).second)
+            ++m_LiveEdits;
+    }
+
+    if (skipped)
+        std::cerr << "EditLog: skipped " << skipped << " corrupt record(s) in " << m_Path.string() << std::endl;
+}
+
+void EditLog::openForAppend()
+{
+    bool fresh = !std::filesystem::exists(m_Path);
+    if (!fresh)
+    {
+        auto size = std::filesystem::file_size(m_Path);
+        auto valid = HEADER_BYTES + m_FileRecords * RECORD_BYTES;
+        if (size != valid)
+            std::filesystem::resize_file(m_Path, valid);
+    }
+
+    m_File.open(m_Path, std::ios::binary | std::ios::app);
+    if (!m_File)
+        throw std::runtime_error("EditLog: failed to open " + m_Path.string());
+
+    if (fresh)
+    {
+        m_File.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+        m_File.write(reinterpret_cast<const char *>(&LOG_VERSION), sizeof(LOG_VERSION));
+        m_File.flush();
+    }
+}
+
+void EditLog::record(const glm::ivec3 &chunkPos, int localX, int y, int localZ, BlockId id)
+{
+    const uint16_t index = static_cast<uint16_t>(ChunkLayout::index(localX, y, localZ));
+    {
+        std::unique_lock lock(m_IndexMutex);
+        if (m_Index[chunkPos].insert_or_assign(index, id).second)
+            ++m_LiveEdits;
+    }
+    {
+        std::scoped_lock lock(m_PendingMutex);
+        m_Pending.push_back({chunkPos, index, id});
+    }
+}
+
+bool EditLog::apply(const glm::ivec3 &chunkPos, std::vector<Block> &blocks) const
+{
+    std::shared_lock lock(m_IndexMutex);
+    auto it = m_Index.find(chunkPos);
+    if (it == m_Index.end())
+        return false;
+
+    for (const auto &[index, id] : it->second)
+        blocks[index].id = id;
+    return true;
+}
+
+bool EditLog::hasEdits(const glm::ivec3 &chunkPos) const
+{
+    std::shared_lock lock(m_IndexMutex);
+    return m_Index.count(chunkPos) != 0;
+}
+
+size_t EditLog::liveEditCount() const
+{
+    std::shared_lock lock(m_IndexMutex);
+    return m_LiveEdits;
+}
+
+size_t EditLog::fileRecordCount() const
+{
+    std::scoped_lock lock(m_PendingMutex);
+    return m_FileRecords + m_Pending.size();
+}
+
+void EditLog::flush()
+{
+    std::unique_lock lock(m_PendingMutex);
+    uint64_t target = m_FlushGeneration + 1;
+    m_FlushRequested = true;
+    m_Cv.notify_one();
+    m_Cv.wait(lock, [&]
+              { return m_FlushGeneration >= target; });
+}
+
+void EditLog::writeRecords(std::ofstream &out, const std::vector<Record> &records)
+{
+    std::vector<uint8_t> bytes(records.size() * RECORD_BYTES);
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const Record &r = records[i];
+        packRecord(bytes.data() + i * RECORD_BYTES, r.chunkPos.x, r.chunkPos.z, r.index, static_cast<uint8_t>(r.id));
+    }
+    out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+void EditLog::flushPending()
+{
+    std::vector<Record> records;
+    {
+        std::scoped_lock lock(m_PendingMutex);
+        records.swap(m_Pending);
+    }
+    if (records.empty())
+        return;
+
+    writeRecords(m_File, records);
+    m_File.flush();
+
+    std::scoped_lock lock(m_PendingMutex);
+    m_FileRecords += records.size();
+}
+
+void EditLog::compact()
+{
+    std::vector<Record> live;
+    {
+        std::shared_lock indexLock(m_IndexMutex);
+        std::scoped_lock pendingLock(m_PendingMutex);
+        live.reserve(m_LiveEdits);
+        for (const auto &[pos, edits] : m_Index)
+            for (const auto &[index, id] : edits)
+                live.push_back({pos, index, id});
+        m_Pending.clear();
+    }
+
+    std::filesystem::path tmp = m_Path.string() + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+        out.write(reinterpret_cast<const char *>(&LOG_VERSION), sizeof(LOG_VERSION));
+        writeRecords(out, live);
+        if (!out)
+            throw std::runtime_error("EditLog: failed to write " + tmp.string());
+    }
+
+    m_File.close();
+    std::filesystem::rename(tmp, m_Path);
+    m_File.open(m_Path, std::ios::binary | std::ios::app);
+    if (!m_File)
+        throw std::runtime_error("EditLog: failed to reopen " + m_Path.string());
+
+    std::scoped_lock lock(m_PendingMutex);
+    m_FileRecords = live.size();
+}
+
+void EditLog::run(std::stop_token st)
+{
+    while (true)
+    {
+        bool stopping;
+        {
+            std::unique_lock lock(m_PendingMutex);
+            m_Cv.wait_for(lock, st, FLUSH_INTERVAL, [&]
+                          { return m_FlushRequested; });
+            m_FlushRequested = false;
+            stopping = st.stop_requested();
+        }
+
+        try
+        {
+            flushPending();
+
+            size_t fileRecords = fileRecordCount();
+            size_t liveEdits = liveEditCount();
+            if (fileRecords > MIN_COMPACT_RECORDS && fileRecords > 2 * liveEdits)
+                compact();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "EditLog: " << e.what() << std::endl;
+        }
+
+        {
+            std::scoped_lock lock(m_PendingMutex);
+            ++m_FlushGeneration;
+        }
+        m_Cv.notify_all();
+
+        if (stopping)
+            break;
+    }
+}
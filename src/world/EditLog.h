@@ -0,0 +1,71 @@
+#pragma once
+#include "../Block.h"
+#include "../math/Ivec3Less.h"
+#include <glm/glm.hpp>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <shared_mutex>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+#include <chrono>
+#include <cstdint>
+
+class EditLog
+{
+public:
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{1000};
+    static constexpr size_t MIN_COMPACT_RECORDS = 4096;
+
+    explicit EditLog(const std::filesystem::path &path);
+    ~EditLog();
+
+    EditLog(const EditLog &) = delete;
+    EditLog &operator=(const EditLog &) = delete;
+
+    void record(const glm::ivec3 &chunkPos, int localX, int y, int localZ, BlockId id);
+    bool apply(const glm::ivec3 &chunkPos, std::vector<Block> &blocks) const;
+    bool hasEdits(const glm::ivec3 &chunkPos) const;
+
+    void flush();
+    size_t liveEditCount() const;
+    size_t fileRecordCount() const;
+
+private:
+    struct Record
+    {
+        glm::ivec3 chunkPos;
+        uint16_t index;
+        BlockId id;
+    };
+
+    using ChunkEdits = std::unordered_map<uint16_t, BlockId>;
+
+    void load();
+    void openForAppend();
+    void writeRecords(std::ofstream &out, const std::vector<Record> &records);
+    void flushPending();
+    void compact();
+    void run(std::stop_token st);
+
+    std::filesystem::path m_Path;
+
+    mutable std::shared_mutex m_IndexMutex;
+    std::map<glm::ivec3, ChunkEdits, ivec3_less> m_Index;
+    size_t m_LiveEdits = 0;
+
+    mutable std::mutex m_PendingMutex;
+    std::condition_variable_any m_Cv;
+    std::vector<Record> m_Pending;
+    bool m_FlushRequested = false;
+    uint64_t m_FlushGeneration = 0;
+
+    std::ofstream m_File;
+    size_t m_FileRecords = 0;
+
+    std::jthread m_Thread;
+};
@@ -0,0 +1,140 @@
+#include "MappedFile.h"
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path &path, Access access) : m_Access(access)
+{
+    const bool readOnly = access == Access::ReadOnly;
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), readOnly ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, readOnly ? OPEN_EXISTING : OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("failed to open " + path.string());
+    m_File = file;
+#else
+    m_Fd = readOnly ? ::open(path.c_str(), O_RDONLY) : ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_Fd < 0)
+        throw std::runtime_error("failed to open " + path.string());
+#endif
+    map();
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+#ifdef _WIN32
+    if (m_File)
+        CloseHandle(static_cast<HANDLE>(m_File));
+#else
+    if (m_Fd >= 0)
+        ::close(m_Fd);
+#endif
+}
+
+void MappedFile::map()
+{
+#ifdef _WIN32
+    LARGE_INTEGER size{};
+    GetFileSizeEx(static_cast<HANDLE>(m_File), &size);
+    m_Size = static_cast<size_t>(size.QuadPart);
+    if (m_Size == 0)
+        return;
+
+    m_Mapping = CreateFileMappingW(static_cast<HANDLE>(m_File), nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_Mapping)
+        throw std::runtime_error("CreateFileMapping failed");
+    m_Data = static_cast<uint8_t *>(MapViewOfFile(static_cast<HANDLE>(m_Mapping), FILE_MAP_READ, 0, 0, 0));
+    if (!m_Data)
+        throw std::runtime_error("MapViewOfFile failed");
+#else
+    struct stat st{};
+    if (fstat(m_Fd, &st) != 0)
+        throw std::runtime_error("fstat failed");
+    m_Size = static_cast<size_t>(st.st_size);
+    if (m_Size == 0)
+        return;
+
+    void *p = mmap(nullptr, m_Size, PROT_READ, MAP_SHARED, m_Fd, 0);
+    if (p == MAP_FAILED)
+        throw std::runtime_error("mmap failed");
+    m_Data = static_cast<uint8_t *>(p);
+#endif
+}
+
+void MappedFile::unmap()
+{
+#ifdef _WIN32
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+    if (m_Mapping)
+        CloseHandle(static_cast<HANDLE>(m_Mapping));
+    m_Mapping = nullptr;
+#else
+    if (m_Data)
+        munmap(m_Data, m_Size);
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+void MappedFile::write(uint64_t offset, const void *src, size_t bytes)
+{
+    if (m_Access == Access::ReadOnly)
+        throw std::runtime_error("write to read-only mapping");
+
+    bool grows = offset + bytes > m_Size;
+    if (grows)
+        unmap();
+
+#ifdef _WIN32
+    const uint8_t *p = static_cast<const uint8_t *>(src);
+    while (bytes > 0)
+    {
+        OVERLAPPED ov{};
+        ov.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFull);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = static_cast<DWORD>(bytes > 0x40000000 ? 0x40000000 : bytes);
+        DWORD written = 0;
+        if (!WriteFile(static_cast<HANDLE>(m_File), p, chunk, &written, &ov) || written == 0)
+            throw std::runtime_error("WriteFile failed");
+        p += written;
+        offset += written;
+        bytes -= written;
+    }
+#else
+    const uint8_t *p = static_cast<const uint8_t *>(src);
+    while (bytes > 0)
+    {
+        ssize_t written = ::pwrite(m_Fd, p, bytes, static_cast<off_t>(offset));
+        if (written <= 0)
+            throw std::runtime_error("pwrite failed");
+        p += written;
+        offset += static_cast<uint64_t>(written);
+        bytes -= static_cast<size_t>(written);
+    }
+#endif
+
+    if (grows)
+        map();
+}
+
+void MappedFile::sync()
+{
+#ifdef _WIN32
+    FlushFileBuffers(static_cast<HANDLE>(m_File));
+#else
+    ::fsync(m_Fd);
+#endif
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <filesystem>
+#include <cstdint>
+#include <cstddef>
+
+class MappedFile
+{
+public:
+    enum class Access
+    {
+        ReadWrite,
+        ReadOnly
+    };
+
+    explicit MappedFile(const std::filesystem::path &path, Access access = Access::ReadWrite);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const uint8_t *data() const { return m_Data; }
+    size_t size() const { return m_Size; }
+
+    void write(uint64_t offset, const void *src, size_t bytes);
+    void sync();
+
+private:
+    void map();
+    void unmap();
+
+#ifdef _WIN32
+    void *m_File = nullptr;
+    void *m_Mapping = nullptr;
+#else
+    int m_Fd = -1;
+#endif
+    uint8_t *m_Data = nullptr;
+    size_t m_Size = 0;
+    Access m_Access;
+};
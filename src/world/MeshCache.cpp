@@ -0,0 +1,164 @@
+#include "MeshCache.h"
+#include <fstream>
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <system_error>
+
+namespace
+{
+    constexpr char CACHE_MAGIC[4] = {'V', 'C', 'M', 'C'};
+    constexpr uint32_t CACHE_VERSION = 4;
+
+    struct EntryHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t sizes[MeshCache::SECTION_COUNT];
+    };
+
+    uint64_t rotl(uint64_t v, int r)
+    {
+        return (v << r) | (v >> (64 - r));
+    }
+
+    uint64_t fmix(uint64_t k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdull;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ull;
+        k ^= k >> 33;
+        return k;
+    }
+}
+
+MeshCache::MeshCache(const std::filesystem::path &directory) : m_Directory(directory)
+{
+    std::filesystem::create_directories(m_Directory);
+}
+
+uint64_t MeshCache::hashContent(const void *data, size_t bytes, uint64_t seed)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    uint64_t h = seed ^ (bytes * 0x9e3779b97f4a7c15ull);
+
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8)
+    {
+        uint64_t k;
+        std::memcpy(&k, p + i, sizeof(k));
+        k *= 0x87c37b91114253d5ull;
+        k = rotl(k, 31);
+        k *= 0x4cf5ad432745937full;
+        h ^= k;
+        h = rotl(h, 27) * 5 + 0x52dce729;
+    }
+
+    uint64_t tail = 0;
+    for (size_t s = 0; i < bytes; ++i, s += 8)
+        tail |= static_cast<uint64_t>(p[i]) << s;
+    h ^= fmix(tail);
+
+    return fmix(h);
+}
+
+std::filesystem::path MeshCache::entryPath(const glm::ivec3 &chunkPos, int lod) const
+{
+    return m_Directory / ("c." + std::to_string(chunkPos.x) + "." + std::to_string(chunkPos.z) + "." + std::to_string(lod) + ".vcm");
+}
+
+bool MeshCache::load(const glm::ivec3 &chunkPos, int lod, uint64_t key, const Sink &sink)
+{
+    std::ifstream in(entryPath(chunkPos, lod), std::ios::binary);
+    EntryHeader header{};
+    if (!in || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.version != CACHE_VERSION || header.key != key)
+    {
+        m_Misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Sizes sizes;
+    std::copy(std::begin(header.sizes), std::end(header.sizes), sizes.begin());
+
+    std::array<void *, SECTION_COUNT> dst{};
+    sink(sizes, dst);
+
+    uint64_t total = 0;
+    for (size_t s = 0; s < SECTION_COUNT; ++s)
+    {
+        if (dst[s])
+            in.read(static_cast<char *>(dst[s]), sizes[s]);
+        else
+            in.seekg(sizes[s], std::ios::cur);
+        total += sizes[s];
+    }
+
+    if (!in)
+    {
+        m_Misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    m_Hits.fetch_add(1, std::memory_order_relaxed);
+    m_BytesRead.fetch_add(total + sizeof(header), std::memory_order_relaxed);
+    return true;
+}
+
+void MeshCache::store(const glm::ivec3 &chunkPos, int lod, uint64_t key, const Sections &sections)
+{
+    EntryHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.key = key;
+    for (size_t s = 0; s < SECTION_COUNT; ++s)
+        header.sizes[s] = static_cast<uint32_t>(sections[s].second);
+
+    std::filesystem::path path = entryPath(chunkPos, lod);
+    std::filesystem::path tmp = path;
+    tmp += ".tmp" + std::to_string(m_TmpCounter.fetch_add(1, std::memory_order_relaxed));
+
+    uint64_t total = sizeof(header);
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        for (const auto &[data, bytes] : sections)
+        {
+            if (bytes)
+                out.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+            total += bytes;
+        }
+        if (!out)
+        {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp, ec);
+        return;
+    }
+
+    m_Stores.fetch_add(1, std::memory_order_relaxed);
+    m_BytesWritten.fetch_add(total, std::memory_order_relaxed);
+}
+
+MeshCache::Stats MeshCache::getStats() const
+{
+    Stats st;
+    st.hits = m_Hits.load(std::memory_order_relaxed);
+    st.misses = m_Misses.load(std::memory_order_relaxed);
+    st.stores = m_Stores.load(std::memory_order_relaxed);
+    st.bytesRead = m_BytesRead.load(std::memory_order_relaxed);
+    st.bytesWritten = m_BytesWritten.load(std::memory_order_relaxed);
+    return st;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <filesystem>
+#include <functional>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+class MeshCache
+{
+public:
+    // Opaque vertices and indices, transparent vertices and indices, mesh bounds, opaque face ranges,
+    // section graph, occluders.
+    static constexpr size_t SECTION_COUNT = 8;
+
+    using Sizes = std::array<uint32_t, SECTION_COUNT>;
+    using Sections = std::array<std::pair<const void *, size_t>, SECTION_COUNT>;
+    using Sink = std::function<void(const Sizes &sizes, std::array<void *, SECTION_COUNT> &dst)>;
+
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t bytesRead = 0;
+        uint64_t bytesWritten = 0;
+    };
+
+    explicit MeshCache(const std::filesystem::path &directory);
+
+    static uint64_t hashContent(const void *data, size_t bytes, uint64_t seed);
+
+    bool load(const glm::ivec3 &chunkPos, int lod, uint64_t key, const Sink &sink);
+    void store(const glm::ivec3 &chunkPos, int lod, uint64_t key, const Sections &sections);
+
+    Stats getStats() const;
+
+private:
+    std::filesystem::path entryPath(const glm::ivec3 &chunkPos, int lod) const;
+
+    std::filesystem::path m_Directory;
+    std::atomic<uint64_t> m_TmpCounter{0};
+
+    std::atomic<uint64_t> m_Hits{0};
+    std::atomic<uint64_t> m_Misses{0};
+    std::atomic<uint64_t> m_Stores{0};
+    std::atomic<uint64_t> m_BytesRead{0};
+    std::atomic<uint64_t> m_BytesWritten{0};
+};
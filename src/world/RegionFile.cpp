@@ -0,0 +1,201 @@
+#include "RegionFile.h"
+#include "../ChunkLayout.h"
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <mutex>
+
+namespace
+{
+    constexpr uint8_t CODEC_RLE = 1;
+    constexpr size_t PAYLOAD_HEADER = sizeof(uint32_t) + sizeof(uint8_t);
+
+    uint32_t sectorOffset(uint32_t entry) { return entry >> 8; }
+    uint32_t sectorCount(uint32_t entry) { return entry & 0xFF; }
+
+    void encodeRle(const std::vector<Block> &blocks, std::vector<uint8_t> &out)
+    {
+        size_t i = 0;
+        while (i < blocks.size())
+        {
+            BlockId id = blocks[i].id;
+            size_t run = 1;
+            while (i + run < blocks.size() && blocks[i + run].id == id)
+                ++run;
+            i += run;
+
+            out.push_back(static_cast<uint8_t>(id));
+            while (run >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(run | 0x80));
+                run >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(run));
+        }
+    }
+
+    bool decodeRle(const uint8_t *src, size_t size, std::vector<Block> &out)
+    {
+        out.resize(ChunkLayout::VOLUME);
+        size_t pos = 0;
+        size_t written = 0;
+        while (pos < size)
+        {
+            uint8_t id = src[pos++];
+            if (id >= static_cast<uint8_t>(BlockId::LAST))
+                return false;
+
+            size_t run = 0;
+            int shift = 0;
+            while (true)
+            {
+                if (pos >= size || shift > 28)
+                    return false;
+                uint8_t b = src[pos++];
+                run |= static_cast<size_t>(b & 0x7F) << shift;
+                if (!(b & 0x80))
+                    break;
+                shift += 7;
+            }
+
+            if (written + run > out.size())
+                return false;
+            std::fill_n(out.begin() + written, run, Block{static_cast<BlockId>(id)});
+            written += run;
+        }
+        return written == out.size();
+    }
+}
+
+RegionFile::RegionFile(const std::filesystem::path &path) : m_File(path)
+{
+    static_assert(sizeof(Block) == 1);
+
+    if (m_File.size() < SECTOR_BYTES)
+    {
+        std::vector<uint8_t> header(SECTOR_BYTES, 0);
+        m_File.write(0, header.data(), header.size());
+    }
+
+    std::memcpy(m_Table.data(), m_File.data(), sizeof(m_Table));
+
+    const uint32_t fileSectors = static_cast<uint32_t>(m_File.size() / SECTOR_BYTES);
+    m_UsedSectors.assign(fileSectors, false);
+    m_UsedSectors[0] = true;
+
+    for (uint32_t &entry : m_Table)
+    {
+        uint32_t off = sectorOffset(entry);
+        uint32_t cnt = sectorCount(entry);
+        if (entry == 0)
+            continue;
+        if (off == 0 || cnt == 0 || off + cnt > fileSectors)
+        {
+            entry = 0;
+            continue;
+        }
+        for (uint32_t s = off; s < off + cnt; ++s)
+            m_UsedSectors[s] = true;
+    }
+}
+
+bool RegionFile::contains(int localX, int localZ) const
+{
+    std::shared_lock lock(m_Mutex);
+    return m_Table[entryIndex(localX, localZ)] != 0;
+}
+
+bool RegionFile::read(int localX, int localZ, std::vector<Block> &out) const
+{
+    std::shared_lock lock(m_Mutex);
+
+    uint32_t entry = m_Table[entryIndex(localX, localZ)];
+    if (entry == 0)
+        return false;
+
+    const uint8_t *base = m_File.data() + static_cast<size_t>(sectorOffset(entry)) * SECTOR_BYTES;
+    const size_t capacity = static_cast<size_t>(sectorCount(entry)) * SECTOR_BYTES;
+
+    uint32_t length;
+    std::memcpy(&length, base, sizeof(length));
+    if (length < 1 || length + sizeof(uint32_t) > capacity)
+        return false;
+
+    uint8_t codec = base[sizeof(uint32_t)];
+    if (codec != CODEC_RLE)
+        return false;
+
+    return decodeRle(base + PAYLOAD_HEADER, length - 1, out);
+}
+
+void RegionFile::write(int localX, int localZ, const std::vector<Block> &blocks)
+{
+    if (blocks.size() != ChunkLayout::VOLUME)
+        throw std::runtime_error("RegionFile::write: unexpected block count");
+
+    thread_local std::vector<uint8_t> payload;
+    payload.assign(PAYLOAD_HEADER, 0);
+    encodeRle(blocks, payload);
+
+    uint32_t length = static_cast<uint32_t>(payload.size() - sizeof(uint32_t));
+    std::memcpy(payload.data(), &length, sizeof(length));
+    payload[sizeof(uint32_t)] = CODEC_RLE;
+
+    const uint32_t needed = static_cast<uint32_t>((payload.size() + SECTOR_BYTES - 1) / SECTOR_BYTES);
+    if (needed > 0xFF)
+        throw std::runtime_error("RegionFile::write: chunk too large");
+    payload.resize(static_cast<size_t>(needed) * SECTOR_BYTES, 0);
+
+    std::unique_lock lock(m_Mutex);
+
+    const uint32_t idx = entryIndex(localX, localZ);
+    uint32_t entry = m_Table[idx];
+    uint32_t off = sectorOffset(entry);
+    uint32_t cnt = sectorCount(entry);
+
+    if (entry != 0 && cnt >= needed)
+    {
+        for (uint32_t s = off + needed; s < off + cnt; ++s)
+            m_UsedSectors[s] = false;
+    }
+    else
+    {
+        for (uint32_t s = off; entry != 0 && s < off + cnt; ++s)
+            m_UsedSectors[s] = false;
+        off = allocateSectors(needed);
+    }
+
+    m_File.write(static_cast<uint64_t>(off) * SECTOR_BYTES, payload.data(), payload.size());
+
+    uint32_t newEntry = (off << 8) | needed;
+    m_File.write(static_cast<uint64_t>(idx) * sizeof(uint32_t), &newEntry, sizeof(newEntry));
+    m_Table[idx] = newEntry;
+}
+
+uint32_t RegionFile::allocateSectors(uint32_t count)
+{
+    uint32_t run = 0;
+    for (uint32_t s = 1; s < m_UsedSectors.size(); ++s)
+    {
+        run = m_UsedSectors[s] ? 0 : run + 1;
+        if (run == count)
+        {
+            uint32_t start = s + 1 - count;
+            for (uint32_t i = start; i <= s; ++i)
+                m_UsedSectors[i] = true;
+            return start;
+        }
+    }
+
+    uint32_t start = static_cast<uint32_t>(m_UsedSectors.size()) - run;
+    m_UsedSectors.resize(start + count, false);
+    for (uint32_t i = start; i < start + count; ++i)
+        m_UsedSectors[i] = true;
+    return start;
+}
+
+void RegionFile::sync()
+{
+    std::unique_lock lock(m_Mutex);
+    m_File.sync();
+}
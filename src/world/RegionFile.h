@@ -0,0 +1,32 @@
+#pragma once
+#include "MappedFile.h"
+#include "../Block.h"
+#include <array>
+#include <vector>
+#include <shared_mutex>
+#include <filesystem>
+#include <cstdint>
+
+class RegionFile
+{
+public:
+    static constexpr int SIZE = 32;
+    static constexpr int CHUNK_COUNT = SIZE * SIZE;
+    static constexpr size_t SECTOR_BYTES = 4096;
+
+    explicit RegionFile(const std::filesystem::path &path);
+
+    bool read(int localX, int localZ, std::vector<Block> &out) const;
+    void write(int localX, int localZ, const std::vector<Block> &blocks);
+    bool contains(int localX, int localZ) const;
+    void sync();
+
+private:
+    static uint32_t entryIndex(int localX, int localZ) { return static_cast<uint32_t>(localZ * SIZE + localX); }
+    uint32_t allocateSectors(uint32_t count);
+
+    MappedFile m_File;
+    mutable std::shared_mutex m_Mutex;
+    std::array<uint32_t, CHUNK_COUNT> m_Table{};
+    std::vector<bool> m_UsedSectors;
+};
@@ -0,0 +1,100 @@
+#include "RegionStore.h"
+#include <string>
+#include <algorithm>
+
+namespace
+{
+    int floorDiv(int v, int d)
+    {
+        return v >= 0 ? v / d : -((-v + d - 1) / d);
+    }
+
+    int floorMod(int v, int d)
+    {
+        return v - floorDiv(v, d) * d;
+    }
+}
+
+RegionStore::RegionStore(const std::filesystem::path &directory) : m_Directory(directory)
+{
+    std::filesystem::create_directories(m_Directory);
+}
+
+glm::ivec3 RegionStore::regionOf(const glm::ivec3 &chunkPos)
+{
+    return {floorDiv(chunkPos.x, RegionFile::SIZE), 0, floorDiv(chunkPos.z, RegionFile::SIZE)};
+}
+
+std::filesystem::path RegionStore::regionPath(const glm::ivec3 &regionPos) const
+{
+    return m_Directory / ("r." + std::to_string(regionPos.x) + "." + std::to_string(regionPos.z) + ".vcr");
+}
+
+std::shared_ptr<RegionFile> RegionStore::openRegion(const glm::ivec3 &regionPos, bool create)
+{
+    std::scoped_lock lock(m_Mutex);
+
+    auto it = m_Open.find(regionPos);
+    if (it != m_Open.end())
+    {
+        it->second.lastUse = ++m_UseCounter;
+        return it->second.file;
+    }
+
+    std::filesystem::path path = regionPath(regionPos);
+    if (!create && !std::filesystem::exists(path))
+        return nullptr;
+
+    if (m_Open.size() >= MAX_OPEN_REGIONS)
+    {
+        // A region a loader or saver still holds must stay the only instance for its
+        // path, so only idle regions are evicted; the cap is exceeded until they are.
+        // References are only added under m_Mutex, so an idle count cannot grow here.
+        auto oldest = m_Open.end();
+        for (auto i = m_Open.begin(); i != m_Open.end(); ++i)
+        {
+            if (i->second.file.use_count() > 1)
+                continue;
+            if (oldest == m_Open.end() || i->second.lastUse < oldest->second.lastUse)
+                oldest = i;
+        }
+        if (oldest != m_Open.end())
+            m_Open.erase(oldest);
+    }
+
+    auto file = std::make_shared<RegionFile>(path);
+    m_Open[regionPos] = {file, ++m_UseCounter};
+    return file;
+}
+
+bool RegionStore::loadChunk(const glm::ivec3 &chunkPos, std::vector<Block> &out)
+{
+    auto region = openRegion(regionOf(chunkPos), false);
+    if (!region)
+        return false;
+    return region->read(floorMod(chunkPos.x, RegionFile::SIZE), floorMod(chunkPos.z, RegionFile::SIZE), out);
+}
+
+void RegionStore::saveChunk(const glm::ivec3 &chunkPos, const std::vector<Block> &blocks)
+{
+    auto region = openRegion(regionOf(chunkPos), true);
+    region->write(floorMod(chunkPos.x, RegionFile::SIZE), floorMod(chunkPos.z, RegionFile::SIZE), blocks);
+}
+
+void RegionStore::syncRegion(const glm::ivec3 &regionPos)
+{
+    if (auto region = openRegion(regionPos, false))
+        region->sync();
+}
+
+void RegionStore::flush()
+{
+    std::vector<std::shared_ptr<RegionFile>> files;
+    {
+        std::scoped_lock lock(m_Mutex);
+        for (auto &[pos, region] : m_Open)
+            files.push_back(region.file);
+    }
+    for (auto &file : files)
+        file->sync();
+}
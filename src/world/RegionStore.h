@@ -0,0 +1,40 @@
+#pragma once
+#include "RegionFile.h"
+#include "../Block.h"
+#include "../math/Ivec3Less.h"
+#include <glm/glm.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <filesystem>
+
+class RegionStore
+{
+public:
+    static constexpr size_t MAX_OPEN_REGIONS = 64;
+
+    explicit RegionStore(const std::filesystem::path &directory);
+
+    bool loadChunk(const glm::ivec3 &chunkPos, std::vector<Block> &out);
+    void saveChunk(const glm::ivec3 &chunkPos, const std::vector<Block> &blocks);
+    void syncRegion(const glm::ivec3 &regionPos);
+    void flush();
+
+    static glm::ivec3 regionOf(const glm::ivec3 &chunkPos);
+    std::filesystem::path regionPath(const glm::ivec3 &regionPos) const;
+
+private:
+    std::shared_ptr<RegionFile> openRegion(const glm::ivec3 &regionPos, bool create);
+
+    struct OpenRegion
+    {
+        std::shared_ptr<RegionFile> file;
+        uint64_t lastUse = 0;
+    };
+
+    std::filesystem::path m_Directory;
+    std::mutex m_Mutex;
+    std::map<glm::ivec3, OpenRegion, ivec3_less> m_Open;
+    uint64_t m_UseCounter = 0;
+};
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include <exception>
+#include "assets/AtlasCooker.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+using hrc = std::chrono::high_resolution_clock;
+using milli = std::chrono::duration<double, std::milli>;
+
+namespace
+{
+    struct Options
+    {
+        std::string input = "textures/blocks_atlas.png";
+        std::string output = "textures/blocks_atlas.vctex";
+        uint32_t tileSize = 16;
+    };
+
+    Options parseArgs(int argc, char **argv)
+    {
+        Options o;
+        auto next = [&](int &i) -> std::string
+        {
+            if (i + 1 >= argc)
+                throw std::runtime_error(std::string("Missing value for ") + argv[i]);
+            return argv[++i];
+        };
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--in")
+                o.input = next(i);
+            else if (arg == "--out")
+                o.output = next(i);
+            else if (arg == "--tile")
+                o.tileSize = static_cast<uint32_t>(std::stoul(next(i)));
+            else if (arg == "--help" || arg == "-h")
+            {
+                std::cout << "Usage: AtlasCook [--in PNG] [--out FILE] [--tile N]\n"
+                          << "Cooks a block atlas into a .vctex container with a per-tile mip chain.\n";
+                std::exit(0);
+            }
+            else
+                throw std::runtime_error("Unknown argument: " + arg);
+        }
+        return o;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        Options opt = parseArgs(argc, argv);
+        auto t0 = hrc::now();
+
+        int w, h, channels;
+        stbi_uc *pixels = stbi_load(opt.input.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+        if (!pixels)
+            throw std::runtime_error("Failed to load " + opt.input);
+
+        std::vector<uint8_t> cooked;
+        try
+        {
+            cooked = AtlasCooker::cook(pixels, static_cast<uint32_t>(w), static_cast<uint32_t>(h), opt.tileSize);
+        }
+        catch (...)
+        {
+            stbi_image_free(pixels);
+            throw;
+        }
+        stbi_image_free(pixels);
+
+        std::ofstream out(opt.output, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(cooked.data()), static_cast<std::streamsize>(cooked.size()));
+        if (!out)
+            throw std::runtime_error("Failed to write " + opt.output);
+
+        auto atlas = AtlasCooker::parse(cooked.data(), cooked.size());
+        std::cout << "AtlasCook: " << opt.input << " (" << w << "x" << h << ", tile " << opt.tileSize << ") -> "
+                  << opt.output << ", " << atlas.levels.size() << " mip levels, " << cooked.size() << " bytes in "
+                  << milli(hrc::now() - t0).count() << " ms\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "AtlasCook failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,820 @@
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+#include "ChunkCuller.h"
+#include "DrawKey.h"
+#include "FrameArena.h"
+#include "GpuDrawTable.h"
+#include "RangeAllocator.h"
+#include "Settings.h"
+
+using hrc = std::chrono::high_resolution_clock;
+using milli = std::chrono::duration<double, std::milli>;
+
+namespace
+{
+    struct Options
+    {
+        std::vector<int> renderDistances = {16, 32, 48};
+        int frames = 240;
+        int threads = -1;
+        double transparentFraction = 0.15;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: CullBench [--render-distances 16,32,48] [--frames N] [--threads N]\n"
+                  << "                 [--transparent-fraction F]\n"
+                  << "Builds a synthetic loaded world at each render distance and times draw-list construction\n"
+                  << "for a camera turning in place: the per-chunk map walk over column and over mesh bounds,\n"
+                  << "ChunkCuller on one thread and ChunkCuller with helper threads. Then times the scalar and\n"
+                  << "batched AABB-vs-frustum tests and the draw key radix sort against std::sort. Cave and\n"
+                  << "occlusion culling are only on for their own rows.\n"
+                  << "The GPU culling rows time GpuDrawTable rebuilds, per-upload patches and a CPU stand-in for chunk_cull.comp.\n";
+    }
+
+    Options parseArgs(int argc, char **argv)
+    {
+        Options o;
+        auto next = [&](int &i) -> std::string
+        {
+            if (i + 1 >= argc)
+                throw std::runtime_error(std::string("Missing value for ") + argv[i]);
+            return argv[++i];
+        };
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--render-distances")
+            {
+                o.renderDistances.clear();
+                std::istringstream ss(next(i));
+                std::string item;
+                while (std::getline(ss, item, ','))
+                    o.renderDistances.push_back(std::max(1, std::stoi(item)));
+                if (o.renderDistances.empty())
+                    throw std::runtime_error("--render-distances needs at least one value");
+            }
+            else if (arg == "--frames")
+                o.frames = std::max(1, std::stoi(next(i)));
+            else if (arg == "--threads")
+                o.threads = std::max(0, std::stoi(next(i)));
+            else if (arg == "--transparent-fraction")
+                o.transparentFraction = std::clamp(std::stod(next(i)), 0.0, 1.0);
+            else if (arg == "--help" || arg == "-h")
+            {
+                printUsage();
+                std::exit(0);
+            }
+            else
+                throw std::runtime_error("Unknown argument: " + arg);
+        }
+        return o;
+    }
+
+    double percentile(std::vector<double> values, double p)
+    {
+        if (values.empty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+        return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+    }
+
+    double mean(const std::vector<double> &values)
+    {
+        return values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    }
+
+    // A placement in the renderer's mesh pool, as uploadMesh would give it.
+    std::unique_ptr<GpuMesh> pooledMesh(RangeAllocator &vertices, RangeAllocator &indices, uint32_t vertexCount,
+                                        uint32_t indexCount)
+    {
+        auto mesh = std::make_unique<GpuMesh>();
+        uint64_t vertexOffset, indexOffset;
+        if (vertices.allocate(vertexCount, vertexOffset) && indices.allocate(indexCount, indexOffset))
+        {
+            mesh->pooled = true;
+            mesh->vertexOffset = static_cast<int32_t>(vertexOffset);
+            mesh->firstIndex = static_cast<uint32_t>(indexOffset);
+        }
+        return mesh;
+    }
+
+    // Face ranges of the 36-index box meshes buildWorld gives chunks, six indices per side.
+    MeshFaceRanges boxFaces(int bottom, int top)
+    {
+        MeshFaceRanges faces;
+        const int planes[SectionGraph::FACE_COUNT] = {0, Chunk::WIDTH, bottom, top, 0, Chunk::DEPTH};
+        for (int f = 0; f < SectionGraph::FACE_COUNT; ++f)
+            faces.ranges[f] = {static_cast<uint32_t>(f * 6), 6, planes[f]};
+        return faces;
+    }
+
+    // Every chunk gets LOD 0 and 1 meshes; a fixed fraction also gets transparent ones. Mesh
+    // bounds follow a rolling surface between y 40 and 100, and some chunks get a cave below it.
+    // Sections wholly under the surface are solid in the section graph, cave sections only
+    // connect sideways. Each 4x4 cell is solid from the bottom, or from above the cave, to 10
+    // blocks under the surface.
+    ChunkCuller::ChunkMap buildWorld(int renderDistance, double transparentFraction)
+    {
+        ChunkCuller::ChunkMap chunks;
+        RangeAllocator vertices(1ull << 26), indices(1ull << 26);
+        uint32_t rng = 12345;
+        auto next = [&rng]
+        {
+            rng = rng * 1664525u + 1013904223u;
+            return (rng >> 8) / double(1u << 24);
+        };
+        for (int z = -renderDistance; z <= renderDistance; ++z)
+        {
+            for (int x = -renderDistance; x <= renderDistance; ++x)
+            {
+                auto ch = std::make_shared<Chunk>(glm::ivec3(x, 0, z));
+                bool transparent = next() < transparentFraction;
+
+                MeshBounds bounds;
+                float surface = std::floor(70.f + 24.f * std::sin(x * 0.21f) * std::cos(z * 0.17f) + 6.f * static_cast<float>(next()));
+                bounds.addBox(glm::vec3(0.f, surface - 10.f, 0.f), glm::vec3(Chunk::WIDTH, surface, Chunk::DEPTH));
+                bool cave = next() < 0.3;
+                if (cave)
+                    bounds.addBox(glm::vec3(3.f, 18.f, 2.f), glm::vec3(11.f, 27.f, 9.f));
+
+                SectionGraph graph;
+                const uint8_t sideways = SectionGraph::ALL_FACES & ~(1u << SectionGraph::NEG_Y | 1u << SectionGraph::POS_Y);
+                for (int sec = 0; sec < MeshBounds::SECTION_COUNT; ++sec)
+                    if ((sec + 1) * MeshBounds::SECTION_HEIGHT <= surface - 10.f)
+                        for (int face = 0; face < SectionGraph::FACE_COUNT; ++face)
+                            graph.reach[sec][face] = cave && sec == 1 && ((sideways >> face) & 1) ? sideways : 0;
+                ch->setSectionGraph(graph);
+
+                ChunkOccluders occluders;
+                for (int cz = 0; cz < ChunkOccluders::CELLS; ++cz)
+                {
+                    for (int cx = 0; cx < ChunkOccluders::CELLS; ++cx)
+                    {
+                        const bool overCave = cave && cx < 3 && cz < 3;
+                        occluders.cells[cz * ChunkOccluders::CELLS + cx] = {static_cast<uint16_t>(overCave ? 27 : 0),
+                                                                            static_cast<uint16_t>(surface - 10.f)};
+                    }
+                }
+                ch->setOccluders(occluders);
+
+                for (int lod = 0; lod < 2; ++lod)
+                {
+                    ch->m_Meshes[lod].indexCount = 36;
+                    ch->m_Meshes[lod].gpu = pooledMesh(vertices, indices, 24, 36);
+                    ch->m_Meshes[lod].faces = boxFaces(static_cast<int>(surface) - 10, static_cast<int>(surface));
+                    if (transparent)
+                    {
+                        ch->m_TransparentMeshes[lod].indexCount = 6;
+                        ch->m_TransparentMeshes[lod].gpu = pooledMesh(vertices, indices, 4, 6);
+                    }
+                    ch->setMeshBounds(lod, bounds);
+                }
+                ch->m_OriginSlot = static_cast<uint32_t>(chunks.size());
+                chunks.emplace(glm::ivec3(x, 0, z), std::move(ch));
+            }
+        }
+        return chunks;
+    }
+
+    // The draw-list gather drawFrame used before ChunkCuller, kept as the baseline. With
+    // meshBounds it tests the tight mesh bounds the way ChunkCuller does, one chunk at a time.
+    void mapWalk(const ChunkCuller::ChunkMap &chunks, const Frustum &fr, const Settings &settings, bool meshBounds,
+                 const glm::ivec3 &playerChunkPos, ChunkCuller::DrawList &opaque, ChunkCuller::DrawList &transparent)
+    {
+        opaque.clear();
+        transparent.clear();
+        for (auto &[pos, ch] : chunks)
+        {
+            if (meshBounds)
+            {
+                const MeshBounds bounds = ch->getMeshBounds();
+                const glm::vec3 origin = ch->getAABB().min;
+                if (bounds.empty())
+                    continue;
+                Frustum::Containment c = fr.classify(bounds.toAABB(origin));
+                if (c == Frustum::Containment::OUTSIDE)
+                    continue;
+                if (c == Frustum::Containment::PARTIAL && !std::has_single_bit(bounds.sectionMask))
+                {
+                    bool any = false;
+                    for (uint32_t m = bounds.sectionMask; m && !any; m &= m - 1)
+                        any = fr.intersects(bounds.sectionAABB(std::countr_zero(m), origin));
+                    if (!any)
+                        continue;
+                }
+            }
+            else if (!fr.intersects(ch->getAABB()))
+                continue;
+
+            float d = glm::distance(glm::vec2(pos.x, pos.z), glm::vec2(playerChunkPos.x, playerChunkPos.z));
+            int req = (!settings.lodDistances.empty() && d <= settings.lodDistances[0]) ? 0 : 1;
+            int best = ch->getBestAvailableLOD(req);
+            if (best == -1)
+                continue;
+
+            const ChunkMesh *opaqueMesh = ch->getMesh(best);
+            if (opaqueMesh && opaqueMesh->indexCount > 0)
+                opaque.emplace_back(ch.get(), best);
+            const ChunkMesh *transparentMesh = ch->getTransparentMesh(best);
+            if (transparentMesh && transparentMesh->indexCount > 0)
+                transparent.emplace_back(ch.get(), best);
+        }
+    }
+
+    std::vector<glm::mat4> turningViews(int frames, const glm::vec3 &eye)
+    {
+        const glm::mat4 proj = glm::perspective(glm::radians(100.f), 16.f / 9.f, 0.1f, 2000.f);
+        std::vector<glm::mat4> views(frames);
+        for (int f = 0; f < frames; ++f)
+        {
+            float yaw = glm::two_pi<float>() * f / frames;
+            glm::vec3 dir(std::cos(yaw), -0.2f + 1.2f * std::sin(2.f * yaw), std::sin(yaw));
+            views[f] = proj * glm::lookAt(eye, eye + dir, glm::vec3(0.f, 1.f, 0.f));
+        }
+        return views;
+    }
+
+    std::vector<Frustum> turningFrusta(int frames, const glm::vec3 &eye)
+    {
+        const std::vector<glm::mat4> views = turningViews(frames, eye);
+        std::vector<Frustum> frusta(frames);
+        for (int f = 0; f < frames; ++f)
+            frusta[f].update(views[f]);
+        return frusta;
+    }
+
+    // Whether the segment from a to b passes through the inside of box.
+    bool segmentHits(const glm::vec3 &a, const glm::vec3 &b, const AABB &box)
+    {
+        constexpr float EPS = 1e-4f;
+        float t0 = 0.f, t1 = 1.f;
+        const glm::vec3 d = b - a;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (std::abs(d[axis]) < 1e-9f)
+            {
+                if (a[axis] <= box.min[axis] + EPS || a[axis] >= box.max[axis] - EPS)
+                    return false;
+                continue;
+            }
+            float lo = (box.min[axis] + EPS - a[axis]) / d[axis];
+            float hi = (box.max[axis] - EPS - a[axis]) / d[axis];
+            if (lo > hi)
+                std::swap(lo, hi);
+            t0 = std::max(t0, lo);
+            t1 = std::min(t1, hi);
+            if (t0 >= t1)
+                return false;
+        }
+        return true;
+    }
+
+    // Every chunk occlusion culling drops on a few sampled frames must be hidden for real: rays
+    // from the eye to points in its mesh sections that are in view must all pass through an
+    // occluder box.
+    void checkOcclusion(const ChunkCuller::ChunkMap &chunks, const Settings &with, const Settings &without,
+                        const glm::vec3 &eye, int frames)
+    {
+        std::vector<AABB> occluders;
+        for (auto &[pos, ch] : chunks)
+        {
+            if (std::abs(pos.x) > with.occlusionRange || std::abs(pos.z) > with.occlusionRange)
+                continue;
+            const glm::vec3 origin = ch->getAABB().min;
+            const ChunkOccluders occ = ch->getOccluders();
+            constexpr int CELL = ChunkOccluders::CELL_SIZE;
+            for (int i = 0; i < ChunkOccluders::CELLS * ChunkOccluders::CELLS; ++i)
+            {
+                const ChunkOccluders::Cell &c = occ.cells[i];
+                const glm::vec3 cellMin(i % ChunkOccluders::CELLS * CELL, c.bottom, i / ChunkOccluders::CELLS * CELL);
+                if (c.top > c.bottom)
+                    occluders.push_back({origin + cellMin, origin + glm::vec3(cellMin.x + CELL, c.top, cellMin.z + CELL)});
+            }
+        }
+
+        ChunkCuller culled(with, 0), reference(without, 0);
+        const std::vector<glm::mat4> views = turningViews(frames, eye);
+        const glm::ivec3 playerChunkPos(0, 0, 0);
+        for (int f = 0; f < frames; f += std::max(1, frames / 8))
+        {
+            Frustum fr;
+            fr.update(views[f]);
+            ChunkCuller::DrawList o, t, refO, refT;
+            culled.cull(chunks, 0, 0, fr, views[f], eye, playerChunkPos, o, t);
+            reference.cull(chunks, 0, 0, fr, views[f], eye, playerChunkPos, refO, refT);
+
+            std::sort(o.begin(), o.end());
+            for (const auto &[chunk, lod] : refO)
+            {
+                if (std::binary_search(o.begin(), o.end(), std::make_pair(chunk, lod)))
+                    continue;
+                const MeshBounds bounds = chunk->getMeshBounds();
+                const glm::vec3 origin = chunk->getAABB().min;
+                for (uint32_t m = bounds.sectionMask; m; m &= m - 1)
+                {
+                    const AABB box = bounds.sectionAABB(std::countr_zero(m), origin);
+                    const glm::vec3 size = box.max - box.min;
+                    for (int k = 0; k < 27; ++k)
+                    {
+                        // Off the block grid, so no ray runs along a face shared by two occluders.
+                        const glm::vec3 w((k % 3) * 0.45f + 0.03f, (k / 3 % 3) * 0.45f + 0.03f, (k / 9) * 0.45f + 0.03f);
+                        const glm::vec3 p = box.min + size * w;
+                        if (!fr.intersects({p, p}))
+                            continue;
+                        if (std::none_of(occluders.begin(), occluders.end(), [&](const AABB &b)
+                                         { return segmentHits(eye, p, b); }))
+                            throw std::runtime_error("Occlusion culling dropped a visible chunk");
+                    }
+                }
+            }
+        }
+    }
+
+    // Opaque draws must come out front to back and transparent ones back to front, by the
+    // distance from the camera to the centre of the chunk's mesh bounds.
+    void checkDrawOrder(ChunkCuller &culler, const ChunkCuller::ChunkMap &chunks, const glm::vec3 &eye, int frames)
+    {
+        auto distanceSq = [&](const Chunk *ch)
+        {
+            const AABB b = ch->getMeshBounds().toAABB(ch->getAABB().min);
+            const glm::vec3 d = (b.min + b.max) * 0.5f - eye;
+            return glm::dot(d, d);
+        };
+
+        const std::vector<glm::mat4> views = turningViews(frames, eye);
+        for (int f = 0; f < frames; f += std::max(1, frames / 8))
+        {
+            Frustum fr;
+            fr.update(views[f]);
+            ChunkCuller::DrawList o, t;
+            culler.cull(chunks, 0, 0, fr, views[f], eye, glm::ivec3(0), o, t);
+            for (size_t i = 1; i < o.size(); ++i)
+                if (distanceSq(o[i - 1].first) > distanceSq(o[i].first))
+                    throw std::runtime_error("Opaque draws are not sorted front to back");
+            for (size_t i = 1; i < t.size(); ++i)
+                if (distanceSq(t[i - 1].first) < distanceSq(t[i].first))
+                    throw std::runtime_error("Transparent draws are not sorted back to front");
+        }
+    }
+
+    // DrawKey::sort against std::sort on as many random keys as one render distance has chunks.
+    void drawKeySortBench(int renderDistance, int frames, std::ostream &r)
+    {
+        const size_t count = static_cast<size_t>(2 * renderDistance + 1) * (2 * renderDistance + 1);
+        uint32_t rng = 777;
+        std::vector<std::vector<uint64_t>> inputs(frames);
+        for (auto &keys : inputs)
+        {
+            keys.resize(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                rng = rng * 1664525u + 1013904223u;
+                const float distanceSq = static_cast<float>(rng >> 8) * 4.f;
+                keys[i] = DrawKey::make(DrawKey::MAIN_PIPELINE, distanceSq, DrawKey::Order::FRONT_TO_BACK, static_cast<uint32_t>(i));
+            }
+        }
+
+        std::vector<uint64_t> keys, reference, scratch;
+        double radixMs = 0.0, stdMs = 0.0;
+        for (const auto &input : inputs)
+        {
+            keys = input;
+            auto start = hrc::now();
+            DrawKey::sort(keys, scratch);
+            radixMs += milli(hrc::now() - start).count();
+
+            reference = input;
+            start = hrc::now();
+            std::sort(reference.begin(), reference.end());
+            stdMs += milli(hrc::now() - start).count();
+
+            if (keys != reference)
+                throw std::runtime_error("DrawKey::sort disagrees with std::sort");
+        }
+
+        r << "Draw key sort, " << count << " keys x " << frames << " frames:\n";
+        r << "  DrawKey::sort (radix): " << radixMs / frames << " ms\n";
+        r << "  std::sort:             " << stdMs / frames << " ms\n";
+    }
+
+    // Scalar Frustum::intersects/classify against Frustum::testBatch on the chunk bounds of
+    // one render distance, without the rest of the culler around them.
+    void frustumMicroBench(int renderDistance, int frames, std::ostream &r)
+    {
+        std::vector<AABB> boxes;
+        AABBSoA soa;
+        for (int z = -renderDistance; z <= renderDistance; ++z)
+        {
+            for (int x = -renderDistance; x <= renderDistance; ++x)
+            {
+                glm::vec3 min(x * Chunk::WIDTH, 0.f, z * Chunk::DEPTH);
+                boxes.push_back({min, min + glm::vec3(Chunk::WIDTH, Chunk::HEIGHT, Chunk::DEPTH)});
+                soa.push_back(boxes.back());
+            }
+        }
+        const std::vector<Frustum> frusta = turningFrusta(frames, glm::vec3(8.f, 100.f, 8.f));
+
+        size_t scalarVisible = 0, classifyVisible = 0, classifyInside = 0, batchVisible = 0, batchInside = 0;
+        auto start = hrc::now();
+        for (const Frustum &fr : frusta)
+            for (const AABB &b : boxes)
+                scalarVisible += fr.intersects(b);
+        double scalarMs = milli(hrc::now() - start).count();
+
+        start = hrc::now();
+        for (const Frustum &fr : frusta)
+        {
+            for (const AABB &b : boxes)
+            {
+                Frustum::Containment c = fr.classify(b);
+                classifyVisible += c != Frustum::Containment::OUTSIDE;
+                classifyInside += c == Frustum::Containment::INSIDE;
+            }
+        }
+        double classifyMs = milli(hrc::now() - start).count();
+
+        start = hrc::now();
+        for (const Frustum &fr : frusta)
+        {
+            for (size_t i = 0; i < soa.size(); i += Frustum::BATCH_WIDTH)
+            {
+                Frustum::BatchResult res = fr.testBatch(soa, i);
+                batchVisible += std::popcount(res.visible);
+                batchInside += std::popcount(res.inside);
+            }
+        }
+        double batchMs = milli(hrc::now() - start).count();
+
+        if (scalarVisible != batchVisible || classifyVisible != batchVisible || classifyInside != batchInside)
+            throw std::runtime_error("Frustum::testBatch disagrees with the scalar test");
+
+        const double tests = static_cast<double>(boxes.size()) * frames;
+        r << "AABB vs frustum, " << boxes.size() << " boxes x " << frames << " frusta (" << batchInside * 100.0 / tests
+          << "% inside, " << batchVisible * 100.0 / tests << "% visible):\n";
+        r << "  intersects (scalar):  " << scalarMs * 1e6 / tests << " ns/box\n";
+        r << "  classify (scalar):    " << classifyMs * 1e6 / tests << " ns/box\n";
+        r << "  testBatch (" << Frustum::BATCH_WIDTH << "-wide):  " << batchMs * 1e6 / tests << " ns/box\n";
+    }
+
+    // What chunk_cull.comp does for one draw: the box is outside if its corner furthest along
+    // some plane's normal is still behind that plane.
+    bool gpuInFrustum(const Frustum &fr, const GpuChunkDraw &d)
+    {
+        for (const Plane &p : fr.getPlanes())
+        {
+            const glm::vec3 corner(p.normal.x >= 0.f ? d.boundsMax.x : d.boundsMin.x,
+                                   p.normal.y >= 0.f ? d.boundsMax.y : d.boundsMin.y,
+                                   p.normal.z >= 0.f ? d.boundsMax.z : d.boundsMin.z);
+            if (glm::dot(p.normal, corner) + p.distance < 0.f)
+                return false;
+        }
+        return true;
+    }
+
+    bool gpuFacesCamera(const glm::vec3 &eye, const GpuChunkDraw &d)
+    {
+        return glm::dot(glm::vec3(d.facePlane), eye) + d.facePlane.w > 0.f;
+    }
+
+    struct GpuResult
+    {
+        std::vector<double> rebuildMs;
+        std::vector<double> patchMs;
+        std::vector<double> cullMs;
+        size_t draws = 0;
+        size_t opaque = 0;
+        size_t transparent = 0;
+        // Opaque indices of the draws in the frustum, and of those that also face the camera.
+        size_t frustumIndices = 0;
+        size_t facingIndices = 0;
+    };
+
+    bool sameTable(const GpuDrawTable &a, const GpuDrawTable &b)
+    {
+        const std::vector<GpuChunkDraw> &da = a.getDraws(), &db = b.getDraws();
+        return a.getOpaqueDrawCount() == b.getOpaqueDrawCount() && da.size() == db.size() &&
+               std::memcmp(da.data(), db.data(), da.size() * sizeof(GpuChunkDraw)) == 0 &&
+               std::equal(a.getOpaqueChunks().begin(), a.getOpaqueChunks().end(), b.getOpaqueChunks().begin(), b.getOpaqueChunks().end()) &&
+               std::equal(a.getUnpooledOpaque().begin(), a.getUnpooledOpaque().end(), b.getUnpooledOpaque().begin(), b.getUnpooledOpaque().end()) &&
+               std::equal(a.getUnpooledTransparent().begin(), a.getUnpooledTransparent().end(), b.getUnpooledTransparent().begin(), b.getUnpooledTransparent().end());
+    }
+
+    // Rebuilds the table every frame, as if the chunk set had changed, and patches a second one as
+    // if one chunk had uploaded a new mesh; every eighth upload changes the chunk's face draw count.
+    // Runs the compute pass's test over the table on the CPU. The patched table must match a
+    // rebuild, and every chunk the mesh-bounds walk draws must survive the test, with the face
+    // directions the CPU path would draw.
+    GpuResult gpuCulling(const ChunkCuller::ChunkMap &chunks, const Settings &settings, const glm::vec3 &eye,
+                         const glm::ivec3 &playerChunkPos, int frames)
+    {
+        GpuResult r;
+        GpuDrawTable table(settings), patched(settings);
+        patched.update(chunks, 0, 0, playerChunkPos);
+
+        std::vector<Chunk *> uploads;
+        for (const auto &[pos, ch] : chunks)
+            uploads.push_back(ch.get());
+        std::map<Chunk *, MeshFaceRanges> strippedFaces;
+        RangeAllocator vertices(1ull << 26), indices(1ull << 26);
+        auto upload = [&](Chunk &ch, bool changeFaces)
+        {
+            for (auto &[lod, mesh] : ch.m_Meshes)
+                mesh.gpu = pooledMesh(vertices, indices, 24, mesh.indexCount);
+            if (changeFaces)
+            {
+                auto it = strippedFaces.find(&ch);
+                if (it == strippedFaces.end())
+                {
+                    strippedFaces.emplace(&ch, ch.m_Meshes.begin()->second.faces);
+                    for (auto &[lod, mesh] : ch.m_Meshes)
+                        mesh.faces = MeshFaceRanges{};
+                }
+                else
+                {
+                    for (auto &[lod, mesh] : ch.m_Meshes)
+                        mesh.faces = it->second;
+                    strippedFaces.erase(it);
+                }
+            }
+            ch.setMeshBounds(0, ch.getMeshBounds());
+        };
+
+        const std::vector<Frustum> frusta = turningFrusta(frames, eye);
+        for (int f = -1; f < frames; ++f)
+        {
+            const Frustum &fr = frusta[std::max(f, 0)];
+
+            upload(*uploads[static_cast<size_t>(f + 1) * 7919 % uploads.size()], (f + 1) % 8 == 0);
+            auto start = hrc::now();
+            table.update(chunks, static_cast<uint64_t>(f + 1), 0, playerChunkPos);
+            double rebuild = milli(hrc::now() - start).count();
+
+            start = hrc::now();
+            patched.update(chunks, 0, static_cast<uint64_t>(f + 2), playerChunkPos);
+            double patch = milli(hrc::now() - start).count();
+            if (!sameTable(table, patched))
+                throw std::runtime_error("Patched GpuDrawTable differs from a rebuilt one");
+
+            const std::vector<GpuChunkDraw> &draws = table.getDraws();
+            size_t opaque = 0, transparent = 0;
+            start = hrc::now();
+            for (uint32_t i = 0; i < draws.size(); ++i)
+                if (gpuFacesCamera(eye, draws[i]) && gpuInFrustum(fr, draws[i]))
+                    (i < table.getOpaqueDrawCount() ? opaque : transparent)++;
+            double cull = milli(hrc::now() - start).count();
+            if (f < 0)
+                continue;
+
+            r.rebuildMs.push_back(rebuild);
+            r.patchMs.push_back(patch);
+            r.cullMs.push_back(cull);
+            r.draws = draws.size();
+            r.opaque += opaque;
+            r.transparent += transparent;
+            for (uint32_t i = 0; i < table.getOpaqueDrawCount(); ++i)
+            {
+                if (!gpuInFrustum(fr, draws[i]))
+                    continue;
+                r.frustumIndices += draws[i].indexCount;
+                if (gpuFacesCamera(eye, draws[i]))
+                    r.facingIndices += draws[i].indexCount;
+            }
+
+            if (!table.getUnpooledOpaque().empty() || !table.getUnpooledTransparent().empty())
+                throw std::runtime_error("GpuDrawTable left pooled meshes unpooled");
+        }
+        r.opaque /= frames;
+        r.transparent /= frames;
+        r.frustumIndices /= frames;
+        r.facingIndices /= frames;
+
+        std::vector<Chunk *> stripped;
+        for (const auto &[ch, faces] : strippedFaces)
+            stripped.push_back(ch);
+        for (Chunk *ch : stripped)
+            upload(*ch, true);
+        table.update(chunks, static_cast<uint64_t>(frames + 1), 0, playerChunkPos);
+        patched.update(chunks, 0, static_cast<uint64_t>(frames + 2), playerChunkPos);
+        if (!sameTable(table, patched))
+            throw std::runtime_error("Patched GpuDrawTable differs from a rebuilt one");
+
+        // A draw's instance is the origin slot of the chunk it came from.
+        std::map<uint32_t, std::pair<std::vector<uint32_t>, std::vector<uint32_t>>> instances;
+        const std::vector<GpuChunkDraw> &draws = table.getDraws();
+        for (uint32_t i = 0; i < draws.size(); ++i)
+        {
+            auto &[opaque, transparent] = instances[draws[i].instance];
+            (i < table.getOpaqueDrawCount() ? opaque : transparent).push_back(i);
+        }
+
+        for (int f = 0; f < frames; f += std::max(1, frames / 8))
+        {
+            FrameArena arena(1 << 20);
+            ChunkCuller::DrawList o(&arena), t(&arena);
+            mapWalk(chunks, frusta[f], settings, true, playerChunkPos, o, t);
+            auto check = [&](const ChunkCuller::DrawList &list, bool opaque)
+            {
+                for (const auto &[chunk, lod] : list)
+                {
+                    auto it = instances.find(chunk->m_OriginSlot);
+                    if (it == instances.end())
+                        throw std::runtime_error("GPU culling dropped a chunk the mesh-bounds walk draws");
+                    const std::vector<uint32_t> &chunkDraws = opaque ? it->second.first : it->second.second;
+
+                    const ChunkMesh &mesh = opaque ? *chunk->getMesh(lod) : *chunk->getTransparentMesh(lod);
+                    int expected = 1;
+                    if (!mesh.faces.empty())
+                    {
+                        const uint8_t faces = mesh.faces.facingCamera(eye - chunk->getAABB().min);
+                        expected = 0;
+                        for (int face = 0; face < SectionGraph::FACE_COUNT; ++face)
+                            expected += ((faces >> face) & 1) && mesh.faces.ranges[face].indexCount > 0;
+                    }
+
+                    int facing = 0;
+                    for (uint32_t i : chunkDraws)
+                    {
+                        if (!gpuInFrustum(frusta[f], draws[i]))
+                            throw std::runtime_error("GPU culling dropped a chunk the mesh-bounds walk draws");
+                        facing += gpuFacesCamera(eye, draws[i]);
+                    }
+                    if (facing != expected)
+                        throw std::runtime_error("GPU face culling disagrees with the face directions the CPU path draws");
+                }
+            };
+            check(o, true);
+            check(t, false);
+        }
+        return r;
+    }
+
+    struct Result
+    {
+        std::vector<double> ms;
+        size_t opaque = 0;
+        size_t transparent = 0;
+    };
+
+    template <typename F>
+    Result timeFrames(int frames, const glm::vec3 &eye, F &&cullFrame)
+    {
+        Result r;
+        FrameArena arena(1 << 20);
+        const std::vector<glm::mat4> views = turningViews(frames, eye);
+        const std::vector<Frustum> frusta = turningFrusta(frames, eye);
+        for (int f = -1; f < frames; ++f)
+        {
+            const Frustum &fr = frusta[std::max(f, 0)];
+
+            arena.reset();
+            ChunkCuller::DrawList opaque(&arena), transparent(&arena);
+            auto start = hrc::now();
+            cullFrame(fr, views[std::max(f, 0)], opaque, transparent);
+            if (f < 0)
+                continue;
+            r.ms.push_back(milli(hrc::now() - start).count());
+            r.opaque += opaque.size();
+            r.transparent += transparent.size();
+        }
+        r.opaque /= frames;
+        r.transparent /= frames;
+        return r;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        Options opt = parseArgs(argc, argv);
+        if (opt.threads < 0)
+        {
+            int hw = static_cast<int>(std::thread::hardware_concurrency());
+            opt.threads = std::max(0, hw - 1);
+        }
+
+        Settings settings;
+        Settings frustumOnly = settings;
+        frustumOnly.caveCulling = false;
+        frustumOnly.occlusionCulling = false;
+        Settings caveOnly = settings;
+        caveOnly.occlusionCulling = false;
+        const glm::ivec3 playerChunkPos(0, 0, 0);
+
+        std::ostringstream r;
+        r << std::fixed << std::setprecision(3);
+        r << "CullBench: " << opt.frames << " frames per case, " << opt.threads << " helper threads, "
+          << opt.transparentFraction * 100.0 << "% transparent chunks\n";
+
+        for (int rd : opt.renderDistances)
+        {
+            ChunkCuller::ChunkMap chunks = buildWorld(rd, opt.transparentFraction);
+            // Just above the ground, so nearby hills hide what is behind them.
+            const glm::vec3 eye(8.f, chunks.at(playerChunkPos)->getMeshBounds().toAABB(glm::vec3(0.f)).max.y + 2.f, 8.f);
+
+            Result walk = timeFrames(opt.frames, eye, [&](const Frustum &fr, const glm::mat4 &, ChunkCuller::DrawList &o, ChunkCuller::DrawList &t)
+                                     { mapWalk(chunks, fr, settings, false, playerChunkPos, o, t); });
+            Result tight = timeFrames(opt.frames, eye, [&](const Frustum &fr, const glm::mat4 &, ChunkCuller::DrawList &o, ChunkCuller::DrawList &t)
+                                      { mapWalk(chunks, fr, settings, true, playerChunkPos, o, t); });
+
+            ChunkCuller serial(frustumOnly, 0);
+            Result one = timeFrames(opt.frames, eye, [&](const Frustum &fr, const glm::mat4 &vp, ChunkCuller::DrawList &o, ChunkCuller::DrawList &t)
+                                    { serial.cull(chunks, 0, 0, fr, vp, eye, playerChunkPos, o, t); });
+
+            Result many = one;
+            if (opt.threads > 0)
+            {
+                ChunkCuller parallel(frustumOnly, static_cast<size_t>(opt.threads));
+                many = timeFrames(opt.frames, eye, [&](const Frustum &fr, const glm::mat4 &vp, ChunkCuller::DrawList &o, ChunkCuller::DrawList &t)
+                                  { parallel.cull(chunks, 0, 0, fr, vp, eye, playerChunkPos, o, t); });
+            }
+
+            ChunkCuller caves(caveOnly, 0);
+            Result cave = timeFrames(opt.frames, eye, [&](const Frustum &fr, const glm::mat4 &vp, ChunkCuller::DrawList &o, ChunkCuller::DrawList &t)
+                                     { caves.cull(chunks, 0, 0, fr, vp, eye, playerChunkPos, o, t); });
+
+            ChunkCuller occlusion(settings, 0);
+            Result occluded = timeFrames(opt.frames, eye, [&](const Frustum &fr, const glm::mat4 &vp, ChunkCuller::DrawList &o, ChunkCuller::DrawList &t)
+                                         { occlusion.cull(chunks, 0, 0, fr, vp, eye, playerChunkPos, o, t); });
+
+            if (cave.opaque > tight.opaque || cave.transparent > tight.transparent)
+                throw std::runtime_error("Cave culling added draws");
+            if (occluded.opaque > cave.opaque || occluded.transparent > cave.transparent)
+                throw std::runtime_error("Occlusion culling added draws");
+            checkOcclusion(chunks, settings, caveOnly, eye, opt.frames);
+            checkDrawOrder(serial, chunks, eye, opt.frames);
+            if (one.opaque != tight.opaque || many.opaque != tight.opaque || one.transparent != tight.transparent ||
+                many.transparent != tight.transparent)
+                throw std::runtime_error("ChunkCuller draw lists differ from the mesh-bounds map walk");
+
+            GpuResult gpu = gpuCulling(chunks, settings, eye, playerChunkPos, opt.frames);
+
+            const ChunkCuller::Stats &st = serial.getStats();
+            r << "Render distance " << rd << " (" << chunks.size() << " chunks in " << st.groups << " groups, ~"
+              << walk.opaque << " opaque / ~" << walk.transparent << " transparent draws with column bounds, ~"
+              << tight.opaque << " / ~" << tight.transparent << " with mesh bounds, ~" << cave.opaque << " / ~"
+              << cave.transparent << " with cave culling, ~" << occluded.opaque << " / ~" << occluded.transparent
+              << " with occlusion culling):\n";
+            auto row = [&](const char *name, const Result &res)
+            {
+                r << "  " << std::left << std::setw(24) << name << std::right << "mean " << std::setw(7) << mean(res.ms)
+                  << "  p99 " << std::setw(7) << percentile(res.ms, 99) << " ms\n";
+            };
+            row("map walk, columns:", walk);
+            row("map walk, mesh bounds:", tight);
+            row("culler, 1 thread:", one);
+            if (opt.threads > 0)
+            {
+                std::string label = "culler, " + std::to_string(opt.threads + 1) + " threads:";
+                row(label.c_str(), many);
+            }
+            row("culler, cave culling:", cave);
+            row("culler, occlusion:", occluded);
+            r << "  cave walk reached " << caves.getStats().sectionsReached << " sections in the last frame, "
+              << occlusion.getStats().occluders << " occluder boxes drawn into a " << occlusion.getOcclusionBuffer().getWidth()
+              << "x" << occlusion.getOcclusionBuffer().getHeight() << " depth buffer\n";
+            r << "  GPU culling over " << gpu.draws << " draws (~" << gpu.opaque << " opaque / ~" << gpu.transparent
+              << " transparent pass):\n";
+            auto gpuRow = [&](const char *name, const std::vector<double> &ms)
+            {
+                r << "    " << std::left << std::setw(22) << name << std::right << "mean " << std::setw(7) << mean(ms)
+                  << "  p99 " << std::setw(7) << percentile(ms, 99) << " ms\n";
+            };
+            gpuRow("table rebuild:", gpu.rebuildMs);
+            gpuRow("table patch:", gpu.patchMs);
+            gpuRow("shader test on CPU:", gpu.cullMs);
+            r << "    face culling keeps ~" << gpu.facingIndices << " of ~" << gpu.frustumIndices << " opaque indices in view ("
+              << (gpu.frustumIndices ? 100.0 * gpu.facingIndices / gpu.frustumIndices : 0.0) << "%)\n";
+        }
+
+        frustumMicroBench(*std::max_element(opt.renderDistances.begin(), opt.renderDistances.end()), opt.frames, r);
+        drawKeySortBench(*std::max_element(opt.renderDistances.begin(), opt.renderDistances.end()), opt.frames, r);
+
+        std::cout << r.str();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "CullBench failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
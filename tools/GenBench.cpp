@@ -0,0 +1,238 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <atomic>
+#include <latch>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <exception>
+#include "generation/TerrainGenerator.h"
+#include "ChunkLayout.h"
+#include "ThreadPool.h"
+
+#ifndef VIBECRAFT_GOLDEN_DIR
+#define VIBECRAFT_GOLDEN_DIR "tools/golden"
+#endif
+
+using hrc = std::chrono::high_resolution_clock;
+using milli = std::chrono::duration<double, std::milli>;
+
+namespace
+{
+    const std::vector<std::pair<int, int>> GOLDEN_COORDS = {
+        {0, 0}, {-1, -1}, {1, 0}, {0, 1}, {-1, 0}, {15, -7}, {-33, 20}, {64, 64},
+        {100, -100}, {-250, 300}, {512, -512}, {777, 3}, {-1024, -1024}, {2048, 2048}, {-4096, 77}, {9999, -31}};
+
+    struct Options
+    {
+        int seed = 1337;
+        std::string goldenPath;
+        bool writeGolden = false;
+        bool skipBench = false;
+        int benchRadius = 8;
+        int repeats = 3;
+        size_t threads = 0;
+    };
+
+    Options parseArgs(int argc, char **argv)
+    {
+        Options o;
+        auto next = [&](int &i) -> std::string
+        {
+            if (i + 1 >= argc)
+                throw std::runtime_error(std::string("Missing value for ") + argv[i]);
+            return argv[++i];
+        };
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--seed")
+                o.seed = std::stoi(next(i));
+            else if (arg == "--golden")
+                o.goldenPath = next(i);
+            else if (arg == "--write-golden")
+                o.writeGolden = true;
+            else if (arg == "--no-bench")
+                o.skipBench = true;
+            else if (arg == "--bench-radius")
+                o.benchRadius = std::stoi(next(i));
+            else if (arg == "--repeats")
+                o.repeats = std::max(1, std::stoi(next(i)));
+            else if (arg == "--threads")
+                o.threads = static_cast<size_t>(std::stoul(next(i)));
+            else if (arg == "--help" || arg == "-h")
+            {
+                std::cout << "Usage: GenBench [--seed N] [--golden FILE] [--write-golden] [--no-bench]\n"
+                          << "                [--bench-radius N] [--repeats N] [--threads N]\n";
+                std::exit(0);
+            }
+            else
+                throw std::runtime_error("Unknown argument: " + arg);
+        }
+
+        if (o.goldenPath.empty())
+            o.goldenPath = std::string(VIBECRAFT_GOLDEN_DIR) + "/worldgen_seed" + std::to_string(o.seed) + ".txt";
+        if (o.threads == 0)
+            o.threads = std::max(1u, std::thread::hardware_concurrency());
+        return o;
+    }
+
+    uint64_t hashBlocks(const std::vector<Block> &blocks)
+    {
+        uint64_t h = 1469598103934665603ull;
+        for (const Block &b : blocks)
+        {
+            h ^= static_cast<uint8_t>(b.id);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    std::map<std::pair<int, int>, uint64_t> readGolden(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in)
+            throw std::runtime_error("Failed to open golden file: " + path + " (run with --write-golden to create it)");
+
+        std::map<std::pair<int, int>, uint64_t> golden;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::istringstream ss(line);
+            int cx, cz;
+            std::string hex;
+            if (!(ss >> cx >> cz >> hex))
+                throw std::runtime_error("Malformed golden line: " + line);
+            golden[{cx, cz}] = std::stoull(hex, nullptr, 16);
+        }
+        return golden;
+    }
+
+    void writeGolden(const std::string &path, int seed, const std::vector<uint64_t> &hashes)
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+            throw std::runtime_error("Failed to write golden file: " + path);
+
+        out << "# TerrainGenerator golden hashes (FNV-1a 64 over block ids), seed " << seed << "\n";
+        for (size_t i = 0; i < GOLDEN_COORDS.size(); ++i)
+        {
+            out << GOLDEN_COORDS[i].first << " " << GOLDEN_COORDS[i].second << " "
+                << std::hex << std::setw(16) << std::setfill('0') << hashes[i] << std::dec << "\n";
+        }
+    }
+
+    double runSingleThread(const TerrainGenerator &gen, const std::vector<glm::ivec3> &coords)
+    {
+        std::vector<Block> blocks;
+        auto t0 = hrc::now();
+        for (const glm::ivec3 &c : coords)
+            gen.generateBlocks(c, blocks);
+        return milli(hrc::now() - t0).count();
+    }
+
+    double runAllCores(const TerrainGenerator &gen, const std::vector<glm::ivec3> &coords, ThreadPool &pool)
+    {
+        std::latch finished(static_cast<std::ptrdiff_t>(coords.size()));
+        auto t0 = hrc::now();
+        for (const glm::ivec3 &c : coords)
+        {
+            pool.submit([&gen, &finished, c](std::stop_token)
+                        {
+                thread_local std::vector<Block> blocks;
+                gen.generateBlocks(c, blocks);
+                finished.count_down(); });
+        }
+        finished.wait();
+        return milli(hrc::now() - t0).count();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        Options opt = parseArgs(argc, argv);
+        TerrainGenerator gen(opt.seed);
+
+        std::vector<uint64_t> hashes(GOLDEN_COORDS.size());
+        std::vector<Block> blocks;
+        for (size_t i = 0; i < GOLDEN_COORDS.size(); ++i)
+        {
+            gen.generateBlocks({GOLDEN_COORDS[i].first, 0, GOLDEN_COORDS[i].second}, blocks);
+            hashes[i] = hashBlocks(blocks);
+        }
+
+        int mismatches = 0;
+        if (opt.writeGolden)
+        {
+            writeGolden(opt.goldenPath, opt.seed, hashes);
+            std::cout << "Wrote " << hashes.size() << " golden hashes to " << opt.goldenPath << "\n";
+        }
+        else
+        {
+            auto golden = readGolden(opt.goldenPath);
+            for (size_t i = 0; i < GOLDEN_COORDS.size(); ++i)
+            {
+                auto it = golden.find(GOLDEN_COORDS[i]);
+                if (it == golden.end())
+                {
+                    std::cerr << "  missing golden hash for chunk (" << GOLDEN_COORDS[i].first << ", "
+                              << GOLDEN_COORDS[i].second << ")\n";
+                    ++mismatches;
+                }
+                else if (it->second != hashes[i])
+                {
+                    std::cerr << "  MISMATCH chunk (" << GOLDEN_COORDS[i].first << ", " << GOLDEN_COORDS[i].second
+                              << "): expected " << std::hex << it->second << " got " << hashes[i] << std::dec << "\n";
+                    ++mismatches;
+                }
+            }
+            std::cout << "Golden check (seed " << opt.seed << "): "
+                      << (GOLDEN_COORDS.size() - mismatches) << "/" << GOLDEN_COORDS.size() << " chunks match\n";
+        }
+
+        if (!opt.skipBench)
+        {
+            std::vector<glm::ivec3> coords;
+            for (int z = -opt.benchRadius; z < opt.benchRadius; ++z)
+                for (int x = -opt.benchRadius; x < opt.benchRadius; ++x)
+                    coords.push_back({x, 0, z});
+
+            ThreadPool pool(opt.threads);
+            double bestSingle = 1e300;
+            double bestMulti = 1e300;
+            for (int r = 0; r < opt.repeats; ++r)
+            {
+                bestSingle = std::min(bestSingle, runSingleThread(gen, coords));
+                bestMulti = std::min(bestMulti, runAllCores(gen, coords, pool));
+            }
+
+            double single = coords.size() / (bestSingle / 1000.0);
+            double multi = coords.size() / (bestMulti / 1000.0);
+            std::cout << "Throughput (" << coords.size() << " chunks, best of " << opt.repeats << "):\n"
+                      << "  single-thread:   " << single << " chunks/s\n"
+                      << "  " << std::left << std::setw(17) << (std::to_string(pool.size()) + " threads:") << std::right
+                      << multi << " chunks/s (x" << multi / single << ")\n";
+        }
+
+        return mismatches == 0 ? 0 : 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "GenBench failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,442 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <filesystem>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <exception>
+#include <glm/glm.hpp>
+#include "World.h"
+#include "Player.h"
+#include "NullRenderBackend.h"
+#include "ProcessStats.h"
+#include "Profiler.h"
+
+using hrc = std::chrono::high_resolution_clock;
+using milli = std::chrono::duration<double, std::milli>;
+
+namespace
+{
+    const char *DEFAULT_SCRIPT = R"(# settle at spawn, then cover every movement mode
+wait 4
+sprint 6 0
+fly 8 45 0
+teleport 4000 140 -2500
+wait 4
+fly 8 180 -10
+teleport -6000 140 6000
+sprint 4 90
+fly 10 270 0
+)";
+
+    enum class SegmentKind
+    {
+        WAIT,
+        WALK,
+        SPRINT,
+        FLY,
+        TELEPORT
+    };
+
+    struct Segment
+    {
+        SegmentKind kind;
+        float seconds = 0.f;
+        float yaw = 0.f;
+        float pitch = 0.f;
+        glm::vec3 target{0.f};
+    };
+
+    struct Options
+    {
+        int seed = 1337;
+        int renderDistance = 12;
+        double duration = 0.0;
+        int fps = 0;
+        int uploadLatencyUs = 1500;
+        bool meshCache = false;
+        std::string scriptPath;
+        std::string output;
+        std::string tracePath;
+        std::string metricsPath;
+        std::string worldDir;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: PathBench [--seed N] [--render-distance N] [--duration SEC] [--fps N]\n"
+                  << "                 [--upload-latency-us N] [--script FILE] [--out FILE] [--trace FILE]\n"
+                  << "                 [--metrics FILE] [--world-dir DIR] [--mesh-cache]\n"
+                  << "Flies the player along a scripted path through the headless engine core and reports\n"
+                  << "frame-time percentiles, chunk throughput and per-stage updateChunks timings.\n"
+                  << "Script lines: wait S | walk S YAW | sprint S YAW | fly S YAW PITCH | teleport X Y Z\n";
+    }
+
+    Options parseArgs(int argc, char **argv)
+    {
+        Options o;
+        auto next = [&](int &i) -> std::string
+        {
+            if (i + 1 >= argc)
+                throw std::runtime_error(std::string("Missing value for ") + argv[i]);
+            return argv[++i];
+        };
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--seed")
+                o.seed = std::stoi(next(i));
+            else if (arg == "--render-distance")
+                o.renderDistance = std::max(1, std::stoi(next(i)));
+            else if (arg == "--duration")
+                o.duration = std::stod(next(i));
+            else if (arg == "--fps")
+                o.fps = std::max(0, std::stoi(next(i)));
+            else if (arg == "--upload-latency-us")
+                o.uploadLatencyUs = std::max(0, std::stoi(next(i)));
+            else if (arg == "--script")
+                o.scriptPath = next(i);
+            else if (arg == "--out")
+                o.output = next(i);
+            else if (arg == "--trace")
+                o.tracePath = next(i);
+            else if (arg == "--metrics")
+                o.metricsPath = next(i);
+            else if (arg == "--world-dir")
+                o.worldDir = next(i);
+            else if (arg == "--mesh-cache")
+                o.meshCache = true;
+            else if (arg == "--help" || arg == "-h")
+            {
+                printUsage();
+                std::exit(0);
+            }
+            else
+                throw std::runtime_error("Unknown argument: " + arg);
+        }
+        return o;
+    }
+
+    std::vector<Segment> parseScript(std::istream &in)
+    {
+        std::vector<Segment> segments;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::istringstream ss(line);
+            std::string cmd;
+            if (!(ss >> cmd))
+                continue;
+
+            Segment s{};
+            bool ok = true;
+            if (cmd == "wait")
+            {
+                s.kind = SegmentKind::WAIT;
+                ok = static_cast<bool>(ss >> s.seconds);
+            }
+            else if (cmd == "walk" || cmd == "sprint")
+            {
+                s.kind = cmd == "walk" ? SegmentKind::WALK : SegmentKind::SPRINT;
+                ok = static_cast<bool>(ss >> s.seconds >> s.yaw);
+            }
+            else if (cmd == "fly")
+            {
+                s.kind = SegmentKind::FLY;
+                ok = static_cast<bool>(ss >> s.seconds >> s.yaw >> s.pitch);
+            }
+            else if (cmd == "teleport")
+            {
+                s.kind = SegmentKind::TELEPORT;
+                ok = static_cast<bool>(ss >> s.target.x >> s.target.y >> s.target.z);
+            }
+            else
+                throw std::runtime_error("Unknown script command: " + cmd);
+
+            if (!ok)
+                throw std::runtime_error("Malformed script line: " + line);
+            segments.push_back(s);
+        }
+        if (segments.empty())
+            throw std::runtime_error("Script contains no segments");
+        return segments;
+    }
+
+    double percentile(std::vector<double> values, double p)
+    {
+        if (values.empty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+        return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+    }
+
+    double mean(const std::vector<double> &values)
+    {
+        return values.empty() ? 0.0 : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    }
+
+    bool renderDistanceFilled(World &world, const glm::vec3 &pos, int renderDistance)
+    {
+        int pcx = static_cast<int>(std::floor(pos.x / Chunk::WIDTH));
+        int pcz = static_cast<int>(std::floor(pos.z / Chunk::DEPTH));
+        const ChunkMap &chunks = world.getChunks();
+        for (int z = -renderDistance; z <= renderDistance; ++z)
+        {
+            for (int x = -renderDistance; x <= renderDistance; ++x)
+            {
+                auto it = chunks.find({pcx + x, 0, pcz + z});
+                if (it == chunks.end() || it->second->getBestAvailableLOD(1) == -1)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    struct FillMeasurement
+    {
+        std::string label;
+        double startSeconds;
+        double fillSeconds = -1.0;
+    };
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        Options opt = parseArgs(argc, argv);
+
+        std::vector<Segment> script;
+        if (opt.scriptPath.empty())
+        {
+            std::istringstream in(DEFAULT_SCRIPT);
+            script = parseScript(in);
+        }
+        else
+        {
+            std::ifstream in(opt.scriptPath);
+            if (!in)
+                throw std::runtime_error("Failed to open script: " + opt.scriptPath);
+            script = parseScript(in);
+        }
+
+        double scriptSeconds = 0.0;
+        for (const Segment &s : script)
+            scriptSeconds += s.seconds;
+        if (opt.duration <= 0.0)
+            opt.duration = scriptSeconds;
+
+        bool ownsWorldDir = opt.worldDir.empty();
+        if (ownsWorldDir)
+        {
+            auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+            opt.worldDir = (std::filesystem::temp_directory_path() / ("pathbench-" + std::to_string(stamp))).string();
+        }
+
+        Settings settings;
+        settings.worldSeed = opt.seed;
+        settings.renderDistance = opt.renderDistance;
+        settings.worldDirectory = opt.worldDir;
+        settings.meshCache = opt.meshCache;
+        settings.pipelineMetricsFile = opt.metricsPath;
+        settings.pipelineMetricsIntervalMs = 1000;
+
+        NullRenderBackend backend(64ull * 1024 * 1024, std::chrono::microseconds(opt.uploadLatencyUs));
+
+        std::vector<double> frameMs;
+        std::vector<double> unloadMs, garbageMs, loadMs, createJobsMs, submitJobsMs, uploadMs;
+        std::vector<FillMeasurement> fills;
+        World::Counters counters;
+        PipelineStats pipeline;
+        double wallSeconds = 0.0;
+
+        {
+            World world(settings, backend);
+            Player player(&world, glm::vec3(0.f, 120.f, 0.f), settings);
+
+            const float FIXED_TIMESTEP = 1.0f / 60.0f;
+            const double targetFrameSeconds = opt.fps > 0 ? 1.0 / opt.fps : 0.0;
+            double frameWorkEMA = 0.004;
+            float physicsAccumulator = 0.f;
+
+            size_t segmentIndex = 0;
+            double segmentElapsed = 0.0;
+            bool segmentStarted = false;
+
+            fills.push_back({"spawn", 0.0});
+            Profiler::setThreadName("Main");
+
+            const auto start = hrc::now();
+            auto last = start;
+            while (true)
+            {
+                const auto frameStart = hrc::now();
+                const double now = std::chrono::duration<double>(frameStart - start).count();
+                if (now >= opt.duration)
+                    break;
+
+                float dt = std::min(0.25f, std::chrono::duration<float>(frameStart - last).count());
+                last = frameStart;
+
+                const Segment *seg = &script[segmentIndex];
+                while (segmentStarted && segmentElapsed >= seg->seconds)
+                {
+                    segmentIndex = (segmentIndex + 1) % script.size();
+                    segmentElapsed = 0.0;
+                    segmentStarted = false;
+                    seg = &script[segmentIndex];
+                }
+                if (!segmentStarted)
+                {
+                    segmentStarted = true;
+                    float yaw = glm::radians(seg->yaw);
+                    float pitch = glm::radians(seg->pitch);
+                    switch (seg->kind)
+                    {
+                    case SegmentKind::TELEPORT:
+                    {
+                        player.teleport(seg->target);
+                        std::ostringstream label;
+                        label << "teleport " << seg->target.x << " " << seg->target.y << " " << seg->target.z;
+                        fills.push_back({label.str(), now});
+                        break;
+                    }
+                    case SegmentKind::FLY:
+                        player.m_is_flying = true;
+                        player.set_orientation(yaw, pitch);
+                        break;
+                    case SegmentKind::WALK:
+                    case SegmentKind::SPRINT:
+                        player.m_is_flying = false;
+                        player.set_orientation(yaw, 0.f);
+                        break;
+                    case SegmentKind::WAIT:
+                        break;
+                    }
+                }
+                segmentElapsed += dt;
+
+                PlayerInput input;
+                input.forward = seg->kind == SegmentKind::WALK || seg->kind == SegmentKind::SPRINT || seg->kind == SegmentKind::FLY;
+                input.sprint = seg->kind == SegmentKind::SPRINT;
+
+                physicsAccumulator += dt;
+                while (physicsAccumulator >= FIXED_TIMESTEP)
+                {
+                    player.process_keyboard(input, FIXED_TIMESTEP);
+                    player.update(FIXED_TIMESTEP);
+                    physicsAccumulator -= FIXED_TIMESTEP;
+                }
+                player.update_camera_interpolated(physicsAccumulator / FIXED_TIMESTEP, 16.f / 9.f);
+
+                world.updateChunks(player.get_position(), frameWorkEMA);
+
+                frameMs.push_back(milli(hrc::now() - frameStart).count());
+                frameWorkEMA = 0.9 * frameWorkEMA + 0.1 * frameMs.back() / 1000.0;
+                const World::UpdateTimings &t = world.getLastUpdateTimings();
+                unloadMs.push_back(t.unloadMs);
+                garbageMs.push_back(t.garbageMs);
+                loadMs.push_back(t.loadMs);
+                createJobsMs.push_back(t.createJobsMs);
+                submitJobsMs.push_back(t.submitJobsMs);
+                uploadMs.push_back(t.uploadMs);
+
+                FillMeasurement &fill = fills.back();
+                if (fill.fillSeconds < 0.0 && renderDistanceFilled(world, player.get_position(), opt.renderDistance))
+                    fill.fillSeconds = std::chrono::duration<double>(hrc::now() - start).count() - fill.startSeconds;
+
+                if (targetFrameSeconds > 0.0)
+                    std::this_thread::sleep_until(frameStart + std::chrono::duration_cast<hrc::duration>(
+                                                                   std::chrono::duration<double>(targetFrameSeconds)));
+            }
+
+            wallSeconds = std::chrono::duration<double>(hrc::now() - start).count();
+            counters = world.getCounters();
+            pipeline = world.getPipelineStats();
+
+            if (!opt.tracePath.empty())
+            {
+                if (!Profiler::ENABLED)
+                    std::cerr << "PathBench: built without VIBECRAFT_PROFILER, no trace written\n";
+                else if (!Profiler::writeChromeTrace(opt.tracePath))
+                    throw std::runtime_error("Failed to write trace: " + opt.tracePath);
+            }
+        }
+
+        if (ownsWorldDir)
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(opt.worldDir, ec);
+        }
+
+        NullRenderBackend::Stats bs = backend.getStats();
+
+        std::ostringstream r;
+        r << std::fixed << std::setprecision(2);
+        r << "PathBench: seed " << opt.seed << ", render distance " << opt.renderDistance << ", "
+          << wallSeconds << " s, " << script.size() << " segments"
+          << (opt.fps > 0 ? ", capped at " + std::to_string(opt.fps) + " fps" : ", uncapped")
+          << ", upload latency " << opt.uploadLatencyUs << " us\n";
+        r << "Frame time (main thread, " << frameMs.size() << " frames):\n"
+          << "  p50:             " << percentile(frameMs, 50) << " ms\n"
+          << "  p95:             " << percentile(frameMs, 95) << " ms\n"
+          << "  p99:             " << percentile(frameMs, 99) << " ms\n"
+          << "  max:             " << percentile(frameMs, 100) << " ms\n";
+        r << "Chunk throughput:\n"
+          << "  generated:       " << counters.generated / wallSeconds << " chunks/s (" << counters.generated << ")\n"
+          << "  meshed:          " << counters.meshed / wallSeconds << " chunks/s (" << counters.meshed << ")\n"
+          << "  uploaded:        " << counters.uploaded / wallSeconds << " chunks/s (" << counters.uploaded << ", "
+          << bs.uploadedBytes / (1024.0 * 1024.0) << " MiB, " << bs.stagingWaits << " staging waits)\n";
+        r << "Time to full render distance:\n";
+        for (const FillMeasurement &f : fills)
+        {
+            r << "  " << std::left << std::setw(28) << (f.label + ":") << std::right;
+            if (f.fillSeconds >= 0.0)
+                r << f.fillSeconds << " s\n";
+            else
+                r << "not reached\n";
+        }
+        r << "updateChunks stages (mean / p99 ms per frame):\n";
+        auto stage = [&](const char *name, const std::vector<double> &v)
+        {
+            r << "  " << std::left << std::setw(17) << name << std::right << mean(v) << " / " << percentile(v, 99) << "\n";
+        };
+        stage("unload:", unloadMs);
+        stage("garbage:", garbageMs);
+        stage("load:", loadMs);
+        stage("create jobs:", createJobsMs);
+        stage("submit jobs:", submitJobsMs);
+        stage("upload:", uploadMs);
+        r << "Chunk pipeline:\n";
+        for (const std::string &line : pipeline.toLines())
+            r << "  " << line << "\n";
+        r << "Peak memory:       " << ProcessStats::peakMemoryBytes() / (1024.0 * 1024.0) << " MiB\n";
+
+        std::cout << r.str();
+        if (!opt.output.empty())
+        {
+            std::ofstream out(opt.output, std::ios::trunc);
+            if (!out)
+                throw std::runtime_error("Failed to write report: " + opt.output);
+            out << r.str();
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "PathBench failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
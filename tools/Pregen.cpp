@@ -0,0 +1,226 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <latch>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <exception>
+#include "generation/TerrainGenerator.h"
+#include "ChunkLayout.h"
+#include "ThreadPool.h"
+#include "ProcessStats.h"
+#include "world/RegionStore.h"
+#include <memory>
+
+using hrc = std::chrono::high_resolution_clock;
+using milli = std::chrono::duration<double, std::milli>;
+
+namespace
+{
+    constexpr char DUMP_MAGIC[4] = {'V', 'C', 'D', 'P'};
+    constexpr uint32_t DUMP_VERSION = 1;
+
+    struct Options
+    {
+        int minX = -16, minZ = -16, maxX = 15, maxZ = 15;
+        int seed = 1337;
+        size_t threads = 0;
+        std::string output = "pregen.vcdump";
+        std::string regionDir;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: Pregen [--rect minX minZ maxX maxZ] [--seed N] [--threads N] [--out FILE | --region-dir DIR]\n"
+                  << "Generates the inclusive chunk rectangle and writes it to a .vcdump file or into region files.\n";
+    }
+
+    Options parseArgs(int argc, char **argv)
+    {
+        Options o;
+        auto next = [&](int &i) -> std::string
+        {
+            if (i + 1 >= argc)
+                throw std::runtime_error(std::string("Missing value for ") + argv[i]);
+            return argv[++i];
+        };
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--rect")
+            {
+                o.minX = std::stoi(next(i));
+                o.minZ = std::stoi(next(i));
+                o.maxX = std::stoi(next(i));
+                o.maxZ = std::stoi(next(i));
+            }
+            else if (arg == "--seed")
+                o.seed = std::stoi(next(i));
+            else if (arg == "--threads")
+                o.threads = static_cast<size_t>(std::stoul(next(i)));
+            else if (arg == "--out")
+                o.output = next(i);
+            else if (arg == "--region-dir")
+                o.regionDir = next(i);
+            else if (arg == "--help" || arg == "-h")
+            {
+                printUsage();
+                std::exit(0);
+            }
+            else
+                throw std::runtime_error("Unknown argument: " + arg);
+        }
+
+        if (o.maxX < o.minX || o.maxZ < o.minZ)
+            throw std::runtime_error("Invalid chunk rectangle");
+        if (o.threads == 0)
+            o.threads = std::max(1u, std::thread::hardware_concurrency());
+        return o;
+    }
+
+    template <typename T>
+    void writePod(std::ofstream &out, const T &value)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        Options opt = parseArgs(argc, argv);
+
+        const uint32_t sizeX = static_cast<uint32_t>(opt.maxX - opt.minX + 1);
+        const uint32_t sizeZ = static_cast<uint32_t>(opt.maxZ - opt.minZ + 1);
+        const uint32_t chunkCount = sizeX * sizeZ;
+
+        std::unique_ptr<RegionStore> regions;
+        std::ofstream out;
+        if (!opt.regionDir.empty())
+        {
+            regions = std::make_unique<RegionStore>(opt.regionDir);
+        }
+        else
+        {
+            out.open(opt.output, std::ios::binary | std::ios::trunc);
+            if (!out)
+                throw std::runtime_error("Failed to open output file: " + opt.output);
+
+            out.write(DUMP_MAGIC, sizeof(DUMP_MAGIC));
+            writePod(out, DUMP_VERSION);
+            writePod(out, static_cast<int32_t>(opt.seed));
+            writePod(out, static_cast<int32_t>(ChunkLayout::WIDTH));
+            writePod(out, static_cast<int32_t>(ChunkLayout::HEIGHT));
+            writePod(out, static_cast<int32_t>(ChunkLayout::DEPTH));
+            writePod(out, chunkCount);
+        }
+
+        std::cout << "Pregen: " << chunkCount << " chunks (" << sizeX << "x" << sizeZ << ") seed " << opt.seed
+                  << " on " << opt.threads << " threads -> " << (regions ? opt.regionDir : opt.output) << "\n";
+
+        auto t0 = hrc::now();
+        TerrainGenerator generator(opt.seed);
+        double setupMs = milli(hrc::now() - t0).count();
+
+        std::mutex writeMutex;
+        std::atomic<int64_t> generateNs{0};
+        std::atomic<int64_t> encodeNs{0};
+        std::atomic<int64_t> writeNs{0};
+        std::atomic<uint32_t> done{0};
+        std::latch finished(chunkCount);
+
+        auto tGen = hrc::now();
+        {
+            ThreadPool pool(opt.threads);
+            for (int cz = opt.minZ; cz <= opt.maxZ; ++cz)
+            {
+                for (int cx = opt.minX; cx <= opt.maxX; ++cx)
+                {
+                    pool.submit([&, cx, cz](std::stop_token)
+                                {
+                        thread_local std::vector<Block> blocks;
+                        thread_local std::vector<uint8_t> record;
+
+                        auto a = hrc::now();
+                        generator.generateBlocks({cx, 0, cz}, blocks);
+                        auto b = hrc::now();
+
+                        hrc::time_point c;
+                        if (regions)
+                        {
+                            c = hrc::now();
+                            regions->saveChunk({cx, 0, cz}, blocks);
+                        }
+                        else
+                        {
+                            record.resize(2 * sizeof(int32_t) + ChunkLayout::VOLUME);
+                            int32_t coords[2] = {cx, cz};
+                            std::memcpy(record.data(), coords, sizeof(coords));
+                            static_assert(sizeof(Block) == 1);
+                            std::memcpy(record.data() + sizeof(coords), blocks.data(), ChunkLayout::VOLUME);
+                            c = hrc::now();
+
+                            std::scoped_lock lock(writeMutex);
+                            out.write(reinterpret_cast<const char *>(record.data()), static_cast<std::streamsize>(record.size()));
+                        }
+                        auto d = hrc::now();
+
+                        generateNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count(), std::memory_order_relaxed);
+                        encodeNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(c - b).count(), std::memory_order_relaxed);
+                        writeNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(d - c).count(), std::memory_order_relaxed);
+
+                        uint32_t n = done.fetch_add(1, std::memory_order_relaxed) + 1;
+                        if (n % 256 == 0)
+                        {
+                            std::scoped_lock lock(writeMutex);
+                            std::cout << "  " << n << "/" << chunkCount << "\r" << std::flush;
+                        }
+                        finished.count_down(); });
+                }
+            }
+            finished.wait();
+            std::cout << "\n";
+        }
+        double wallMs = milli(hrc::now() - tGen).count();
+
+        if (regions)
+        {
+            regions->flush();
+        }
+        else
+        {
+            out.flush();
+            if (!out)
+                throw std::runtime_error("Failed to write output file: " + opt.output);
+            out.close();
+        }
+
+        auto perChunk = [&](const std::atomic<int64_t> &ns)
+        { return static_cast<double>(ns.load()) / 1e6 / chunkCount; };
+
+        std::cout << "Pregen finished in " << wallMs << " ms\n"
+                  << "  chunks/s:        " << chunkCount / (wallMs / 1000.0) << "\n"
+                  << "  setup:           " << setupMs << " ms\n"
+                  << "  generate:        " << perChunk(generateNs) << " ms/chunk (thread time)\n"
+                  << "  encode:          " << perChunk(encodeNs) << " ms/chunk (thread time)\n"
+                  << "  write:           " << perChunk(writeNs) << " ms/chunk (thread time, incl. lock wait"
+                  << (regions ? " and compression" : "") << ")\n"
+                  << "  peak memory:     " << ProcessStats::peakMemoryBytes() / (1024.0 * 1024.0) << " MiB\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Pregen failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,271 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <exception>
+#include <glm/glm.hpp>
+#include "World.h"
+#include "NullRenderBackend.h"
+#include "world/RegionStore.h"
+#include "world/ChunkSaver.h"
+#include "world/EditLog.h"
+#include "ChunkLayout.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct Options
+    {
+        int seed = 1337;
+        std::string worldDir;
+        bool keep = false;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: StoreCheck [--seed N] [--world-dir DIR] [--keep]\n"
+                  << "Runs save/unload/reload scenarios against the region store, chunk saver and edit log\n"
+                  << "in a scratch directory and exits non-zero if any edit is lost.\n";
+    }
+
+    Options parseArgs(int argc, char **argv)
+    {
+        Options o;
+        auto next = [&](int &i) -> std::string
+        {
+            if (i + 1 >= argc)
+                throw std::runtime_error(std::string("Missing value for ") + argv[i]);
+            return argv[++i];
+        };
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--seed")
+                o.seed = std::stoi(next(i));
+            else if (arg == "--world-dir")
+                o.worldDir = next(i);
+            else if (arg == "--keep")
+                o.keep = true;
+            else if (arg == "--help" || arg == "-h")
+            {
+                printUsage();
+                std::exit(0);
+            }
+            else
+                throw std::runtime_error("Unknown argument: " + arg);
+        }
+        return o;
+    }
+
+    // A block high above any terrain, so an edit there never matches a regenerated chunk.
+    constexpr int EDIT_X = 5;
+    constexpr int EDIT_Y = Chunk::HEIGHT - 2;
+    constexpr int EDIT_Z = 9;
+    constexpr BlockId EDIT_ID = BlockId::STONE;
+
+    fs::path freshDir(const fs::path &root, const std::string &name)
+    {
+        fs::path dir = root / name;
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        return dir;
+    }
+
+    bool waitFor(const std::function<bool()> &done, std::chrono::seconds timeout = std::chrono::seconds(30))
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!done())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    // Saves an edit on top of an older snapshot and reloads the chunk while the edit
+    // is still queued, so the region file on disk holds the older blocks.
+    std::string checkReloadWhilePending(const fs::path &dir, const TerrainGenerator &gen)
+    {
+        const glm::ivec3 pos{3, 0, -2};
+        RegionStore store(dir);
+        ChunkSaver saver(store, 16ull * 1024 * 1024, std::chrono::milliseconds(60000));
+
+        {
+            Chunk original(pos);
+            original.populate(gen);
+            saver.submit(pos, original.getBlocks());
+            saver.flush();
+
+            original.setBlock(EDIT_X, EDIT_Y, EDIT_Z, {EDIT_ID});
+            saver.submit(pos, original.getBlocks());
+        }
+
+        Chunk reloaded(pos);
+        if (!reloaded.load(store, &saver))
+            return "reload found no saved chunk";
+        if (reloaded.getBlock(EDIT_X, EDIT_Y, EDIT_Z).id != EDIT_ID)
+            return "reload within the coalesce delay returned the stale region snapshot";
+
+        saver.flush();
+        Chunk fromDisk(pos);
+        if (!fromDisk.load(store) || fromDisk.getBlock(EDIT_X, EDIT_Y, EDIT_Z).id != EDIT_ID)
+            return "edit missing from the region file after flush";
+        return {};
+    }
+
+    // Edits a chunk through World, walks away until it unloads and straight back, then
+    // reopens the world from disk.
+    std::string checkWorldRoundTrip(const fs::path &dir, int seed)
+    {
+        Settings settings;
+        settings.worldSeed = seed;
+        settings.renderDistance = 2;
+        settings.worldDirectory = dir.string();
+        settings.meshCache = false;
+
+        const glm::ivec3 chunkPos{0, 0, 0};
+        const glm::vec3 home(8.f, 120.f, 8.f);
+        const glm::vec3 away(home.x + 64.f * Chunk::WIDTH, home.y, home.z);
+
+        NullRenderBackend backend;
+        auto ready = [&](World &world)
+        {
+            auto it = world.getChunks().find(chunkPos);
+            return it != world.getChunks().end() && it->second->getState() >= Chunk::State::TERRAIN_READY;
+        };
+
+        {
+            World world(settings, backend);
+            if (!waitFor([&]
+                         { world.updateChunks(home, 0.0); return ready(world); }))
+                return "chunk never loaded";
+
+            world.set_block(EDIT_X, EDIT_Y, EDIT_Z, EDIT_ID);
+
+            if (!waitFor([&]
+                         { world.updateChunks(away, 0.0); return !world.getChunks().count(chunkPos); }))
+                return "chunk never unloaded";
+            if (!waitFor([&]
+                         { world.updateChunks(home, 0.0); return ready(world); }))
+                return "chunk never reloaded";
+            if (world.get_block(EDIT_X, EDIT_Y, EDIT_Z).id != EDIT_ID)
+                return "edit lost after unloading and reloading the chunk";
+        }
+
+        World world(settings, backend);
+        if (!waitFor([&]
+                     { world.updateChunks(home, 0.0); return ready(world); }))
+            return "chunk never loaded after reopening the world";
+        if (world.get_block(EDIT_X, EDIT_Y, EDIT_Z).id != EDIT_ID)
+            return "edit lost after reopening the world";
+        return {};
+    }
+
+    // Corrupts the block id of a record in the middle of the log and leaves a torn record
+    // at the end; only the torn one may be dropped when the log is reopened.
+    std::string checkEditLogCorruptRecord(const fs::path &dir)
+    {
+        // Mirrors the EditLog file layout: magic + version, then cx, cz, index, id.
+        constexpr size_t HEADER_BYTES = 8;
+        constexpr size_t RECORD_BYTES = 11;
+
+        const fs::path path = dir / "edits.vclog";
+        const glm::ivec3 chunks[3] = {{0, 0, 0}, {1, 0, 0}, {2, 0, 0}};
+        {
+            EditLog log(path);
+            for (const glm::ivec3 &pos : chunks)
+                log.record(pos, EDIT_X, EDIT_Y, EDIT_Z, EDIT_ID);
+            log.flush();
+        }
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(static_cast<std::streamoff>(HEADER_BYTES + RECORD_BYTES + RECORD_BYTES - 1));
+            file.put(static_cast<char>(0xFF));
+            file.seekp(0, std::ios::end);
+            file.write("torn", 4);
+        }
+
+        auto hasEdit = [&](const EditLog &log, const glm::ivec3 &pos)
+        {
+            std::vector<Block> blocks(ChunkLayout::VOLUME, Block{BlockId::AIR});
+            return log.apply(pos, blocks) && blocks[ChunkLayout::index(EDIT_X, EDIT_Y, EDIT_Z)].id == EDIT_ID;
+        };
+
+        {
+            EditLog log(path);
+            if (log.liveEditCount() != 2 || log.fileRecordCount() != 3)
+                return "reopened log has " + std::to_string(log.liveEditCount()) + " live edits in " +
+                       std::to_string(log.fileRecordCount()) + " records, expected 2 in 3";
+            if (fs::file_size(path) != HEADER_BYTES + 3 * RECORD_BYTES)
+                return "reopening did not truncate exactly the torn trailing record";
+            if (!hasEdit(log, chunks[0]) || !hasEdit(log, chunks[2]) || log.hasEdits(chunks[1]))
+                return "wrong edits survived the corrupt record";
+            log.record(chunks[1], EDIT_X, EDIT_Y, EDIT_Z, EDIT_ID);
+            log.flush();
+        }
+
+        EditLog log(path);
+        for (const glm::ivec3 &pos : chunks)
+            if (!hasEdit(log, pos))
+                return "edit in chunk (" + std::to_string(pos.x) + ", " + std::to_string(pos.z) + ") lost after appending";
+        return {};
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        Options opt = parseArgs(argc, argv);
+        fs::path root = opt.worldDir.empty() ? fs::temp_directory_path() / "vibecraft_storecheck" : fs::path(opt.worldDir);
+        BlockDatabase::get().init();
+        TerrainGenerator gen(opt.seed);
+
+        struct Scenario
+        {
+            const char *name;
+            std::function<std::string(const fs::path &)> run;
+        };
+        const std::vector<Scenario> scenarios = {
+            {"reload-while-pending", [&](const fs::path &dir)
+             { return checkReloadWhilePending(dir, gen); }},
+            {"world-round-trip", [&](const fs::path &dir)
+             { return checkWorldRoundTrip(dir, opt.seed); }},
+            {"edit-log-corrupt-record", [&](const fs::path &dir)
+             { return checkEditLogCorruptRecord(dir); }},
+        };
+
+        int failures = 0;
+        for (const Scenario &s : scenarios)
+        {
+            std::string error = s.run(freshDir(root, s.name));
+            std::cout << (error.empty() ? "PASS " : "FAIL ") << s.name;
+            if (!error.empty())
+            {
+                std::cout << ": " << error;
+                ++failures;
+            }
+            std::cout << "\n";
+        }
+
+        if (!opt.keep)
+            fs::remove_all(root);
+
+        std::cout << (failures ? "StoreCheck: " + std::to_string(failures) + " scenario(s) failed" : "StoreCheck: all scenarios passed") << std::endl;
+        return failures ? 1 : 0;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "StoreCheck failed: " << e.what() << std::endl;
+        return 1;
+    }
+}